@@ -24,6 +24,7 @@
 #include "stdlib.h"
 #include "iostream"
 #include "vector"
+#include "limits"
 
 #include "GL_glew/glew.h"
 #include "GL/gl.h"
@@ -32,9 +33,11 @@
     #include "biologicalWorld/BiologicalWorld.h"
     #include "biologicalWorld/Probe.h"
     #include "biologicalWorld/FrapHead.h"
+    #include "biologicalWorld/SteadyStateCache.h"
     #include "physicsEngine/DiffusionSubEngine.h"
     #include "displayAndcontrol/Graphics/Graphic.h"
     #include "Measure/Signal.h"
+    #include "Measure/SRIAccumulator.h"
     #include "TracePlayer.h"
 
 #include "toolBox_src/toolbox_library_global.h"
@@ -48,6 +51,8 @@
     #include "toolBox_src/myQtWidgets/myDockwidget.h"
     #include "toolBox_src/myQtWidgets/mySpinBoxedSlider.h"
     #include "toolBox_src/myQtWidgets/myDoubleSpinBoxedSlider.h"
+    #include "toolBox_src/developmentTools/myProfiler.h"
+    #include "toolBox_src/fileAndstring_manipulation/myBinaryFile.h"
 
 #include "tinytiffwriter.h"
 
@@ -186,8 +191,18 @@ struct simulationParams
 	float current_time;
 
 	float pixel_size; //[µm]
+
+	//checkpoints are saved in the destination folder at checkpoint_plane, then every checkpoint_period planes (0 : once)
+	int checkpoint_plane; //NO_CHECKPOINT_PLANE : no checkpoint
+	int checkpoint_period;
+	string restart_filePath; //checkpoint the simulation is resumed from when the project is loaded, empty : none
+
+	//time-lapse experiments : the planes between two acquisitions are simulated at once (see DiffusionSubEngine::updateSystem)
+	bool isTimeLapseFastForward;
 };
 
+const int NO_CHECKPOINT_PLANE = std::numeric_limits<int>::max();
+
 struct liveExperimentParams
 {
 	LIVE_EXPERIMENT_TYPE experimentType;
@@ -222,6 +237,8 @@ struct experimentParams
 
 	float SRI_pointingAccuracy; //µm
 	float SRI_zoom;
+	bool SRI_isCpuAccumulation; //the image is binned on the CPU (float tiff) instead of being drawn in the camera framebuffer
+	bool SRI_isExportingLocalisations; //CPU accumulation only : table of the localisations of each frame
 
 	int N_presequ;
 	int N_repetition;
@@ -770,6 +787,8 @@ public :
 	~FluoSimModel();
 
 	void initializeBioWorld();
+	void applyEnvironmentSeed(); //seeds the random streams from FLUOSIM_SEED, if set
+	void bindProbesToEngine(); //the probes point to the engine random streams : rebound at each engine (re)creation
     void initializeModelParameters();
 	virtual void resetGeometry();//used
 	void deleteGeometry(string rgn_name);
@@ -808,8 +827,17 @@ public :
 	virtual void stopSimulation();//used
 
 	void setDestinationPath(string path);
+	string getAbsoluteDestinationPath(); //empty if the destination does not exist
 	void saveSimulationProducts();
 
+	//binary snapshot of the whole simulation (particles, random streams, probes, current plane and repetition),
+	//loaded in a simulator set up from the same project, the run then goes on as if it was never interrupted
+	bool saveCheckpoint(string file_path);
+	bool loadCheckpoint(string file_path);
+	bool isCheckpointPlane(int plane);
+	int getNbPlanesToNextEvent(); //planes simulated by the next update, more than one only in time-lapse fast-forward
+	void accumulateLocalisations();
+
 	virtual void setSimulatorMode(SIMULATOR_MODE simulator_mode);//used
 	SIMULATOR_MODE getSimulatorMode();
 	virtual void setExperimentType(EXPERIMENT_TYPE experiment_type);//used
@@ -852,6 +880,8 @@ protected :
 	myGLImage* m_backgroundImage;
 	myGLImage* m_cameraImage;
 	BiologicalWorld* m_bioWorld;
+	SteadyStateCache m_steadyStateCache; //compartment surfaces (and, if pooled, equilibrated positions) reused while the geometry is unchanged
+	SRIAccumulator m_sriAccumulator;
 	FrapHead* m_frapHead;
 
 	DiffusionSubEngine* m_engine;
@@ -875,6 +905,7 @@ protected :
 		renderingParams m_stormRendering_params;
 		renderingParams m_cameraRendering_params;
 	simulationState m_simulation_states;
+	bool m_isCheckpointRestored; //the plane just restored is not checkpointed again
 
 	gstd::gMultiVector<glm::vec2> m_textureRect_coords_gMV;
 };
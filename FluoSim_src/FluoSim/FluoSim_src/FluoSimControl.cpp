@@ -66,7 +66,14 @@ void FluoSim::loadProject(string project_path)
 
 	FluoSimModel::loadProject(project_path);
     setViewsFromModel();
-	FluoSimModel::evaluateSteadyState();
+
+	//a restarted simulation gets its particles from the checkpoint
+	if(m_simulation_params.restart_filePath.empty() ||
+	   FluoSimModel::loadCheckpoint(m_simulation_params.restart_filePath) == false)
+	{
+		FluoSimModel::evaluateSteadyState();
+	}
+	updateSimulationProgressViews();
 }
 
 void FluoSim::saveProject(string project_path)
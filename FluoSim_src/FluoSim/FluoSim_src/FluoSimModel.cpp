@@ -71,12 +71,25 @@ FluoSimModel::FluoSimModel(QApplication* main_app) :
 	m_tracePlayer(m_scrn.getRenderWindow())
 
 {
+	//the profiler is enabled by defining the FLUOSIM_PROFILER environment variable,
+	//a chrome trace is then exported with the simulation products
+	myProfiler::setEnabled(getenv("FLUOSIM_PROFILER") != 0);
+
 	m_bioWorld = 0;
 	m_engine = 0;
 	m_backgroundImage = 0;
 	m_cameraImage = 0;
 	m_frapHead = 0;
 	m_stack_tiffHdl = 0;
+	m_isCheckpointRestored = false;
+
+	//opt-in : the equilibrated positions are pooled across repetitions and kept on disk, across runs, in the FLUOSIM_STEADYSTATE_CACHE folder
+	const char* cacheFolder_str = getenv("FLUOSIM_STEADYSTATE_CACHE");
+	if(cacheFolder_str != 0)
+	{
+		m_steadyStateCache.setStorageFolder(cacheFolder_str);
+		m_steadyStateCache.setArePositionsPooled(true);
+	}
 
 	m_main_app = main_app;
 	m_app_running = true;
@@ -116,6 +129,9 @@ void FluoSimModel::initializeBioWorld()
 	m_bioWorld = new BiologicalWorld();
 	m_engine = new DiffusionSubEngine(m_bioWorld);
     m_engine->setEngineMode(DiffusionSubEngine::AUTOMATIC_SELECTION_MODE);
+	bindProbesToEngine();
+
+	applyEnvironmentSeed();
     //m_engine->setEngineMode(DiffusionSubEngine::MULTITHREADED_MODE);
 
 	ChemicalSpecies spc1("spc1", vec4(0.2,1,0.2,1));
@@ -154,6 +170,11 @@ void FluoSimModel::initializeModelParameters()
     m_simulation_params.dt_sim = 0.020;
     m_tracePlayer.setTimeStep(m_simulation_params.dt_sim);
 
+    m_simulation_params.checkpoint_plane = NO_CHECKPOINT_PLANE;
+    m_simulation_params.checkpoint_period = 0;
+    m_simulation_params.restart_filePath = "";
+    m_simulation_params.isTimeLapseFastForward = false;
+
     //DYNAMIC PARAMETERSu
     m_dynamic_params.D_insideContact = 0.0;
     m_dynamic_params.D_outsideContact = 0.0;
@@ -268,6 +289,8 @@ void FluoSimModel::initializeModelParameters()
 
     m_experiment_params.SRI_pointingAccuracy = 0.1f;
     m_experiment_params.SRI_zoom = 1;
+    m_experiment_params.SRI_isCpuAccumulation = false;
+    m_experiment_params.SRI_isExportingLocalisations = false;
 
     m_experiment_params.N_presequ = 1000;
     m_experiment_params.N_repetition = 1;
@@ -289,8 +312,6 @@ void FluoSimModel::evaluateSteadyState()
 	int N_rgn = m_bioWorld->getNbRegions();
 	if(m_bioWorld == 0 || N_rgn <= 0) return; //->
 
-	m_bioWorld->deleteAllParticles();
-
 	float k_on = m_dynamic_params.k_on;
 	float k_off = m_dynamic_params.k_off;
     float D_insideContact = m_dynamic_params.D_insideContact;
@@ -303,18 +324,11 @@ void FluoSimModel::evaluateSteadyState()
 	if(D_insideContact == 0) D_insideContact = std::pow(2,-126);
 	if(m_dynamic_params.crossingProbability_outIn == 0) p_crossing_outIn = std::pow(2,-126);
 
-	vector<int> forbidden_rgns_v;
+	//surfaces_v[0] : cell outside the compartments, surfaces_v[rgn_idx] : cell part of the compartment
+	const vector<float>& surfaces_v = m_steadyStateCache.getSurfaces(*m_bioWorld, 0);
+	float S1 = surfaces_v[0];
 	float S2 = 0;
-	for(int rgn_idx = 1; rgn_idx < N_rgn; rgn_idx++)
-	{
-		vector<vec2> r_v;
-		Region& rgn = m_bioWorld->getRegionRef(rgn_idx);
-		if(rgn.isACompartment(m_bioWorld->getSpecieAdr(0)) == false) continue; //<
-		getIntersectionRegion(m_bioWorld->getRegionRef(0), rgn, r_v);
-		S2 += computeSurface(r_v);
-		forbidden_rgns_v.push_back(rgn_idx);
-	}
-	float S1 = m_bioWorld->getRegionRef(0).getSurface()-S2;
+	for(int rgn_idx = 1; rgn_idx < N_rgn; rgn_idx++) S2 += surfaces_v[rgn_idx];
 
 	float eps_T = 1 + k_on / k_off;
 	float eps_D = D_outsideContact*p_crossing_outIn/D_insideContact;
@@ -323,56 +337,17 @@ void FluoSimModel::evaluateSteadyState()
 	float sigma2_D = (eps_D)/(S1+S2*eps_D*eps_T);
 	float sigma2_T = eps_D*(eps_T-1)/(S1+S2*eps_D*eps_T);
 
-    struct particleState
-	{
-		int creation_rgn_idx;
-		vector<int> forbidden_rgns_v;
-		bool is_trapped;
-		float interval_min, interval_max; //if rand in [0; INTERVAL_MAX[ is in [interval_min; interval_max] then  a particle is created in the associated state
-		int nb_particles;
-	};
-
-    vector<particleState> particle_states;
-	particle_states.push_back({0, forbidden_rgns_v, false, 0.0f, S1*sigma1, 0});
+	vector<float> freeWeights_v(N_rgn), trappedWeights_v(N_rgn);
+	freeWeights_v[0] = S1*sigma1;
+	trappedWeights_v[0] = 0.0f;
 	for(int rgn_idx = 1; rgn_idx < N_rgn; rgn_idx++)
 	{
-        Region& rgn = m_bioWorld->getRegionRef(rgn_idx);
-        if(rgn.isACompartment(m_bioWorld->getSpecieAdr(0)) == false) continue; //<
-
-        vector<vec2> r_v;
-        getIntersectionRegion(m_bioWorld->getRegionRef(0), rgn, r_v);
-		float S = computeSurface(r_v);
-
-		particle_states.push_back({rgn_idx, {}, false, particle_states.back().interval_max,
-												 particle_states.back().interval_max +S*sigma2_D, 0});
-		particle_states.push_back({rgn_idx, {}, true, particle_states.back().interval_max,
-												 particle_states.back().interval_max +S*sigma2_T, 0});
+		freeWeights_v[rgn_idx] = surfaces_v[rgn_idx]*sigma2_D;
+		trappedWeights_v[rgn_idx] = surfaces_v[rgn_idx]*sigma2_T;
 	}
 
-	float interval_MAX = particle_states.back().interval_max;
-	int N_particles = m_particleSystem_params.N_particles;
-	for(int part_idx = 0; part_idx < N_particles; part_idx++)
-	{
-		float value = uniformDistributiion(0.0f, interval_MAX);
-        for(particleState& part_state : particle_states)
-		{
-			if(value >= part_state.interval_min &&
-			   value < part_state.interval_max)
-			{
-				part_state.nb_particles++;
-			}
-		}
-	}
-
-    for(particleState& part_state : particle_states)
-	{
-		m_bioWorld->addParticles(part_state.nb_particles,
-								 0,
-								 part_state.creation_rgn_idx,
-								 part_state.forbidden_rgns_v,
-								 0,0,
-								 part_state.is_trapped);
-	}
+	m_steadyStateCache.drawSteadyState(*m_bioWorld, 0, 0, m_particleSystem_params.N_particles,
+									   freeWeights_v, trappedWeights_v);
 }
 
 
@@ -381,8 +356,6 @@ void FluoSimModel::imposeSteadyState()
 	int N_rgn = m_bioWorld->getNbRegions();
 	if(m_bioWorld == 0 || N_rgn <= 0) return; //->
 
-	m_bioWorld->deleteAllParticles();
-
 	float k_on = m_dynamic_params.k_on;
 	float k_off = m_dynamic_params.k_off;
 	float initial_enrichment = m_experiment_params.initial_enrichment;
@@ -390,74 +363,27 @@ void FluoSimModel::imposeSteadyState()
 	if(m_dynamic_params.k_on == 0) k_on = std::pow(2,-126);
 	if(m_dynamic_params.k_off == 0) k_off = std::pow(2,-126);
 
-	vector<int> forbidden_rgns_v;
+	const vector<float>& surfaces_v = m_steadyStateCache.getSurfaces(*m_bioWorld, 0);
+	float S1 = surfaces_v[0];
 	float S2 = 0;
-	for(int rgn_idx = 1; rgn_idx < N_rgn; rgn_idx++)
-	{
-		vector<vec2> r_v;
-		Region& rgn = m_bioWorld->getRegionRef(rgn_idx);
-		if(rgn.isACompartment(m_bioWorld->getSpecieAdr(0)) == false) continue; //<
-		getIntersectionRegion(m_bioWorld->getRegionRef(0), rgn, r_v);
-		S2 += computeSurface(r_v);
-		forbidden_rgns_v.push_back(rgn_idx);
-	}
-	float S1 = m_bioWorld->getRegionRef(0).getSurface()-S2;
+	for(int rgn_idx = 1; rgn_idx < N_rgn; rgn_idx++) S2 += surfaces_v[rgn_idx];
 
 	float eps_T = 1 + k_on / k_off;
 	float sigma1 = 1.0f/(S1+S2*initial_enrichment);
 	float sigma2_D = initial_enrichment/(eps_T*(S1+S2*initial_enrichment));
 	float sigma2_T = initial_enrichment*(eps_T-1)/(eps_T*(S1+S2*initial_enrichment));
 
-    struct particleState
-	{
-		int creation_rgn_idx;
-		vector<int> forbidden_rgns_v;
-		bool is_trapped;
-		float interval_min, interval_max; //if rand in [0; INTERVAL_MAX[ is in [interval_min; interval_max] then  a particle is created in the associated state
-		int nb_particles;
-	};
-
-    vector<particleState> particle_states;
-	particle_states.push_back({0, forbidden_rgns_v, false, 0.0f, S1*sigma1, 0});
+	vector<float> freeWeights_v(N_rgn), trappedWeights_v(N_rgn);
+	freeWeights_v[0] = S1*sigma1;
+	trappedWeights_v[0] = 0.0f;
 	for(int rgn_idx = 1; rgn_idx < N_rgn; rgn_idx++)
 	{
-        Region& rgn = m_bioWorld->getRegionRef(rgn_idx);
-        if(rgn.isACompartment(m_bioWorld->getSpecieAdr(0)) == false) continue; //<
-
-        vector<vec2> r_v;
-        getIntersectionRegion(m_bioWorld->getRegionRef(0), rgn, r_v);
-		float S = computeSurface(r_v);
-
-		particle_states.push_back({rgn_idx, {}, false, particle_states.back().interval_max,
-												 particle_states.back().interval_max +S*sigma2_D, 0});
-		particle_states.push_back({rgn_idx, {}, true, particle_states.back().interval_max,
-												 particle_states.back().interval_max +S*sigma2_T, 0});
-	}
-
-	float interval_MAX = particle_states.back().interval_max;
-	int N_particles = m_particleSystem_params.N_particles;
-	for(int part_idx = 0; part_idx < N_particles; part_idx++)
-	{
-		float value = uniformDistributiion(0.0f, interval_MAX);
-        for(particleState& part_state : particle_states)
-		{
-			if(value >= part_state.interval_min &&
-			   value < part_state.interval_max)
-			{
-				part_state.nb_particles++;
-			}
-		}
+		freeWeights_v[rgn_idx] = surfaces_v[rgn_idx]*sigma2_D;
+		trappedWeights_v[rgn_idx] = surfaces_v[rgn_idx]*sigma2_T;
 	}
 
-    for(particleState& part_state : particle_states)
-	{
-		m_bioWorld->addParticles(part_state.nb_particles,
-								 0,
-								 part_state.creation_rgn_idx,
-								 part_state.forbidden_rgns_v,
-								 0,0,
-								 part_state.is_trapped);
-	}
+	m_steadyStateCache.drawSteadyState(*m_bioWorld, 0, 0, m_particleSystem_params.N_particles,
+									   freeWeights_v, trappedWeights_v);
 }
 
 
@@ -599,6 +525,31 @@ void FluoSimModel::deleteGeometries(vector<string>& rgn_names_v)
 
 }
 
+void FluoSimModel::applyEnvironmentSeed()
+{
+	//reproducible runs (e.g. parameter sweeps) : the random streams are seeded from FLUOSIM_SEED
+	const char* seed_str = getenv("FLUOSIM_SEED");
+	if(seed_str == 0) return; //->
+
+	unsigned int seed = strtoul(seed_str, 0, 10);
+	srand(seed);
+	m_bioWorld->setRandomSeed(seed);
+	m_engine->setRandomSeed(seed);
+	m_sriAccumulator.setRandomSeed(seed);
+	m_steadyStateCache.setSeed(seed); //the jobs of a sweep don't share their pooled positions
+}
+
+void FluoSimModel::bindProbesToEngine()
+{
+	vector<RandomNumberGenerator>* randomFactories_v = NULL;
+	if(m_engine != 0) randomFactories_v = &(m_engine->getRandomFactoriesRef());
+
+	for(Probe* probe : m_experimental_probes_v)
+	{
+		if(probe != 0) probe->setRandomFactories(randomFactories_v);
+	}
+}
+
 void FluoSimModel::resetProject()
 {
     //reset bioWorld
@@ -613,6 +564,8 @@ void FluoSimModel::resetProject()
         m_engine = new DiffusionSubEngine(m_bioWorld);
     }
         m_engine->setEngineMode(DiffusionSubEngine::AUTOMATIC_SELECTION_MODE);
+    bindProbesToEngine();
+    applyEnvironmentSeed(); //the new world and engine start with the default streams
 
     ChemicalSpecies spc1("spc1", vec4(0.2,1,0.2,1));
         m_bioWorld->addChemicalSpecie(spc1);
@@ -663,6 +616,12 @@ void FluoSimModel::loadProject(string project_path)
 {
     stopSimulation();
 
+	//checkpointing only applies to the project that asks for it
+	m_simulation_params.checkpoint_plane = NO_CHECKPOINT_PLANE;
+	m_simulation_params.checkpoint_period = 0;
+	m_simulation_params.restart_filePath = "";
+	m_simulation_params.isTimeLapseFastForward = false;
+
 	enum projectProperties
 	{
 		rgn_Number,
@@ -701,6 +660,10 @@ void FluoSimModel::loadProject(string project_path)
 		simulationParams_current_plane,
 		simulationParams_current_time,
 		simulationParams_pixel_size,
+		simulationParams_checkpoint_plane,
+		simulationParams_checkpoint_period,
+		simulationParams_restart_filePath,
+		simulationParams_isTimeLapseFastForward,
 		liveExperimentParams_experimentType,
 		liveExperimentParams_measured_RgnName,
 		liveExperimentParams_bleached_RgnName,
@@ -733,6 +696,8 @@ void FluoSimModel::loadProject(string project_path)
 		experimentParams_SRI_pointingAccuracy,
 		experimentParams_SRI_detectionIntensity,
 		experimentParams_SRI_zoom,
+		experimentParams_SRI_isCpuAccumulation,
+		experimentParams_SRI_isExportingLocalisations,
 
 		simulationState_simulator_mode,
 		simulationState_simulationStarted,
@@ -782,6 +747,10 @@ void FluoSimModel::loadProject(string project_path)
 		"simulationParams.current_plane",
 		"simulationParams.current_time",
 		"simulationParams.pixel_size",
+		"simulationParams.checkpoint_plane",
+		"simulationParams.checkpoint_period",
+		"simulationParams.restart_filePath",
+		"simulationParams.isTimeLapseFastForward",
 		"liveExperimentParams.experimentType",
 		"liveExperimentParams.measured_RgnName",
 		"liveExperimentParams.bleached_RgnName",
@@ -814,6 +783,8 @@ void FluoSimModel::loadProject(string project_path)
 		"experimentParams.SRI_pointingAccuracy",
 		"experimentParams.SRI_detectionIntensity",
 		"experimentParams.SRI_zoom",
+		"experimentParams.SRI_isCpuAccumulation",
+		"experimentParams.SRI_isExportingLocalisations",
 
 		"simulationState.simulator_mode",
 		"simulationState.simulationStarted",
@@ -866,6 +837,10 @@ void FluoSimModel::loadProject(string project_path)
 		{"simulationParams.current_plane",simulationParams_current_plane},
 		{"simulationParams.current_time",simulationParams_current_time},
 		{"simulationParams.pixel_size",simulationParams_pixel_size},
+		{"simulationParams.checkpoint_plane",simulationParams_checkpoint_plane},
+		{"simulationParams.checkpoint_period",simulationParams_checkpoint_period},
+		{"simulationParams.restart_filePath",simulationParams_restart_filePath},
+		{"simulationParams.isTimeLapseFastForward",simulationParams_isTimeLapseFastForward},
 		{"liveExperimentParams.experimentType",liveExperimentParams_experimentType},
 		{"liveExperimentParams.measured_RgnName",liveExperimentParams_measured_RgnName},
 		{"liveExperimentParams.bleached_RgnName",liveExperimentParams_bleached_RgnName},
@@ -898,6 +873,8 @@ void FluoSimModel::loadProject(string project_path)
 		{"experimentParams.SRI_pointingAccuracy", experimentParams_SRI_pointingAccuracy},
 		{"experimentParams.SRI_detectionIntensity", experimentParams_SRI_detectionIntensity},
 		{"experimentParams.SRI_zoom", experimentParams_SRI_zoom},
+		{"experimentParams.SRI_isCpuAccumulation", experimentParams_SRI_isCpuAccumulation},
+		{"experimentParams.SRI_isExportingLocalisations", experimentParams_SRI_isExportingLocalisations},
 
 		{"simulationState.simulator_mode",simulationState_simulator_mode},
 		{"simulationState.simulationStarted",simulationState_simulationStarted},
@@ -1329,6 +1306,35 @@ void FluoSimModel::loadProject(string project_path)
 				}
 				break;
 
+				case simulationParams_checkpoint_plane :
+				{
+					getWord(line, word, ket_pos+1, word_pos);
+					m_simulation_params.checkpoint_plane = stoi(word);
+				}
+				break;
+
+				case simulationParams_checkpoint_period :
+				{
+					getWord(line, word, ket_pos+1, word_pos);
+					m_simulation_params.checkpoint_period = stoi(word);
+				}
+				break;
+
+				case simulationParams_restart_filePath :
+				{
+					int end_pos;
+					getLine(line, m_simulation_params.restart_filePath, ket_pos+1+1, end_pos);
+				}
+				break;
+
+				case simulationParams_isTimeLapseFastForward :
+				{
+					getWord(line, word, ket_pos+1, word_pos);
+					if(word == "TRUE") m_simulation_params.isTimeLapseFastForward = true;
+					if(word == "FALSE") m_simulation_params.isTimeLapseFastForward = false;
+				}
+				break;
+
 				case liveExperimentParams_experimentType :
 				{
 					getWord(line, word, ket_pos+1, word_pos);
@@ -1660,6 +1666,22 @@ void FluoSimModel::loadProject(string project_path)
 				}
 				break;
 
+				case experimentParams_SRI_isCpuAccumulation :
+				{
+					getWord(line, word, ket_pos+1, word_pos);
+					if(word == "TRUE") m_experiment_params.SRI_isCpuAccumulation = true;
+					if(word == "FALSE") m_experiment_params.SRI_isCpuAccumulation = false;
+				}
+				break;
+
+				case experimentParams_SRI_isExportingLocalisations :
+				{
+					getWord(line, word, ket_pos+1, word_pos);
+					if(word == "TRUE") m_experiment_params.SRI_isExportingLocalisations = true;
+					if(word == "FALSE") m_experiment_params.SRI_isExportingLocalisations = false;
+				}
+				break;
+
 				case simulationState_simulator_mode :
 				{
 					getWord(line, word, ket_pos+1, word_pos);
@@ -1906,6 +1928,22 @@ void FluoSimModel::saveProject(string project_filePath)
 
 	myfile<<"[simulationParams.pixel_size] "<<m_simulation_params.pixel_size<<"\n";
 
+	if(m_simulation_params.checkpoint_plane != NO_CHECKPOINT_PLANE)
+	{
+		myfile<<"[simulationParams.checkpoint_plane] "<<m_simulation_params.checkpoint_plane<<"\n";
+		myfile<<"[simulationParams.checkpoint_period] "<<m_simulation_params.checkpoint_period<<"\n";
+	}
+
+	if(m_simulation_params.restart_filePath.empty() == false)
+	{
+		myfile<<"[simulationParams.restart_filePath] "<<m_simulation_params.restart_filePath<<"\n";
+	}
+
+	if(m_simulation_params.isTimeLapseFastForward == true)
+	{
+		myfile<<"[simulationParams.isTimeLapseFastForward] TRUE\n";
+	}
+
 	string experimentType_str;
 	if(m_liveExperiment_params.experimentType == PHOTOBLEACHING_LIVE_EXPERIMENT)
 		experimentType_str = "PHOTOBLEACHING_LIVE_EXPERIMENT";
@@ -2001,6 +2039,10 @@ void FluoSimModel::saveProject(string project_filePath)
 
 	myfile<<"[experimentParams.SRI_zoom] "<<m_experiment_params.SRI_zoom<<"\n";
 
+	myfile<<"[experimentParams.SRI_isCpuAccumulation] "<<(m_experiment_params.SRI_isCpuAccumulation ? "TRUE" : "FALSE")<<"\n";
+
+	myfile<<"[experimentParams.SRI_isExportingLocalisations] "<<(m_experiment_params.SRI_isExportingLocalisations ? "TRUE" : "FALSE")<<"\n";
+
 	myfile<<"[experimentParams.N_presequ] "<<m_experiment_params.N_presequ<<"\n";
 
 	myfile<<"[experimentParams.N_repetition] "<<m_experiment_params.N_repetition<<"\n";
@@ -2173,27 +2215,28 @@ void FluoSimModel::loadGeometry(string path)
 	}
 	if(file_type == 1) 	rgns_v = getPointsFromMetaMorphRgnFile(path);
 
-	int nb_rgns = rgns_v.size();
-	for(int rgn_idx = 0; rgn_idx <= nb_rgns-1; rgn_idx++)
+	//degenerated regions are discarded before the insertion, the towers are then set in one pass
+	vector<vector<glm::vec2> > valid_rgns_v;
+	for(vector<glm::vec2>& rgn_r : rgns_v)
 	{
-		int next_rgnIdx = m_bioWorld->getNextRegionUniqueId();
+		if(rgn_r.size() <= 2 || computeSurface(rgn_r) == 0.0f) continue; //<-
+		valid_rgns_v.push_back(rgn_r);
+	}
 
-		m_bioWorld->addRegion(rgns_v[rgn_idx]);
-		Region& rgn = m_bioWorld->getRegionRef(m_bioWorld->getNbRegions()-1);
-		rgn.computeSurface();
+	int first_rgnIdx = m_bioWorld->getNbRegions();
+	int next_rgnIdx = m_bioWorld->getNextRegionUniqueId();
+	m_bioWorld->addRegions(valid_rgns_v);
 
-		if(rgn.getSize() <= 2 || rgn.getSurface() == 0.0f) m_bioWorld->deleteRegion(&rgn);
-		else
+	for(int rgn_idx = first_rgnIdx; rgn_idx <= m_bioWorld->getNbRegions()-1; rgn_idx++)
+	{
+		Region& rgn = m_bioWorld->getRegionRef(rgn_idx);
+		rgn.computeSurface();
+		rgn.setName("Region" + to_string(next_rgnIdx));
+		if(rgn_idx > 0)
 		{
-			rgn.setName("Region" + to_string(next_rgnIdx));
-			rgn.computeBarycenter();
-			rgn.computeRadiusSquared();
-            if(m_bioWorld->getNbRegions() > 1)
-            {
-                rgn.setIsACompartment(m_bioWorld->getSpecieAdr(0), false);
-            }
-            next_rgnIdx++;
+			rgn.setIsACompartment(m_bioWorld->getSpecieAdr(0), false);
 		}
+		next_rgnIdx++;
 	}
 
     if(m_liveExperiment_params.measured_RgnName == "" && m_bioWorld->getNbRegions() >=1) {
@@ -2298,6 +2341,8 @@ bool FluoSimModel::loadBackgroundImage(string& imageFile_path)
 
 void FluoSimModel::renderBioWorld()
 {
+	PROFILE_ZONE("rendering");
+
 	int renderedObjectTypes;
     if(m_simulation_states.simulator_mode == GEOMETRY_MODE/* || m_simulation_states.simulator_mode == ANALYSIS_MODE*/) \
 		renderedObjectTypes = BiologicalWorld::REGION_BIT;
@@ -2352,6 +2397,7 @@ void FluoSimModel::renderBioWorld()
 
             if(m_current_rendering_params->isUsingPoissonNoise == true)
 			{
+				PROFILE_ZONE("noise");
 				m_scrn.applyPoissonNoise();
 			}
 
@@ -2404,8 +2450,11 @@ void FluoSimModel::renderBioWorld()
 				m_scrn.drawBuffer(m_current_rendering_params->rendering_target);
 			}
 
-            if(m_current_rendering_params == &m_cameraRendering_params) \
+            if(m_current_rendering_params == &m_cameraRendering_params)
+            {
+                PROFILE_ZONE("noise");
                 m_scrn.applyOffsetsAndNoises();
+            }
 
             if(m_current_rendering_params->rendering_target == Screen::SCREEN_FRAMEBUFFER) \
 				m_scrn.refreshScreen();
@@ -2604,12 +2653,16 @@ void FluoSimModel::captureCamera(string tiff_path, myTiff::OPENING_MODE mode)
 //COPY FRAMEBUFFER IN TEXTURE
 	vector<uint16> text_data_16;
 	gstd::gTexture& texture = m_scrn.getCameraTexture();
-	texture.getTextureData(text_data_16, GL_RED, GL_UNSIGNED_SHORT, 1);
+	{
+		PROFILE_ZONE("readback");
+		texture.getTextureData(text_data_16, GL_RED, GL_UNSIGNED_SHORT, 1);
+	}
 	m_scrn.clearCamera();
 
 //SAVE DATA IN A .BMP image file
 	vec2 screen_size = texture.getSize();
 	if(tiff_path.empty() == true) tiff_path = "screen_capture_camera.tiff";
+	PROFILE_ZONE("tiff I/O");
 	myTiff tiff;
 	tiff.open(tiff_path, mode);
 	tiff.setSamplesPerPixel(1);
@@ -2632,7 +2685,10 @@ void FluoSimModel::captureCamera(TinyTIFFFile* tiff_hdl, myTiff::OPENING_MODE mo
 // COPY FRAMEBUFFER IN TEXTURE
 	vector<uint16> text_data_16;
 	gstd::gTexture& texture = m_scrn.getCameraTexture();
-	texture.getTextureData(text_data_16, GL_RED, GL_UNSIGNED_SHORT, 1);
+	{
+		PROFILE_ZONE("readback");
+		texture.getTextureData(text_data_16, GL_RED, GL_UNSIGNED_SHORT, 1);
+	}
 	m_scrn.clearCamera();
 
 	if(m_stack_tiffHdl == 0)
@@ -2663,6 +2719,7 @@ void FluoSimModel::captureCamera(TinyTIFFFile* tiff_hdl, myTiff::OPENING_MODE mo
 
 	if (m_stack_tiffHdl == 0) return; //->
 
+	PROFILE_ZONE("tiff I/O");
 	TinyTIFFWriter_writeImage(m_stack_tiffHdl, text_data_16.data());
 }
 
@@ -2701,6 +2758,17 @@ void FluoSimModel::runSimulator()
 		   m_simulation_states.simulationPaused == false  &&
 		   m_simulation_params.current_plane <= m_experiment_params.N_planes-1)
 		{
+			//checkpoint : state at the beginning of the plane
+			if(isCheckpointPlane(m_simulation_params.current_plane) == true && m_isCheckpointRestored == false)
+			{
+				string destination_path = getAbsoluteDestinationPath();
+				if(destination_path.empty() == false)
+				{
+					saveCheckpoint(destination_path + "/checkpoint_rep" + to_string(m_experiment_params.index_repetion) +
+								   "_plane" + to_string(m_simulation_params.current_plane) + ".bin");
+				}
+			}
+			m_isCheckpointRestored = false;
 
             //steps : FRAP/PAF/DRUG -> measure -> bioWorld update
 			//FRAP
@@ -2709,12 +2777,8 @@ void FluoSimModel::runSimulator()
 			   m_simulation_params.current_plane >= m_experiment_params.N_frap &&
 			   m_simulation_params.current_plane <= m_experiment_params.N_frap + m_experiment_params.dN_frap-1)
 			{
-				auto frapHead = m_experimental_frapHead_v.begin();
-				while(frapHead != m_experimental_frapHead_v.end())
-				{
-					frapHead->bleachRegion(m_experiment_params.k_off_frap, m_simulation_params.dt_sim);
-					frapHead++;
-				}
+				FrapHead::bleachRegions(m_experimental_frapHead_v, m_experiment_params.k_off_frap, m_simulation_params.dt_sim,
+										m_engine->getRandomFactoriesRef());
 			}
 
 			//PAF
@@ -2723,12 +2787,8 @@ void FluoSimModel::runSimulator()
 			   m_simulation_params.current_plane >= m_experiment_params.N_photoActivation &&
 			   m_simulation_params.current_plane <= m_experiment_params.N_photoActivation + m_experiment_params.dN_photoActivation-1)
 			{
-				auto frapHead = m_experimental_frapHead_v.begin();
-				while(frapHead != m_experimental_frapHead_v.end())
-				{
-					frapHead->photoActivateRegion(m_experiment_params.k_on_photoActivation, m_simulation_params.dt_sim);
-					frapHead++;
-				}
+				FrapHead::photoActivateRegions(m_experimental_frapHead_v, m_experiment_params.k_on_photoActivation, m_simulation_params.dt_sim,
+											   m_engine->getRandomFactoriesRef());
 			}
 
 			//DRUG
@@ -2769,6 +2829,7 @@ void FluoSimModel::runSimulator()
 
 						clearProbeSignals();
 						m_scrn.clearCamera();
+						m_sriAccumulator.clear();
 
 						m_simulation_params.current_plane = -m_experiment_params.N_presequ;
 						m_simulation_params.current_time = -m_experiment_params.N_presequ * m_simulation_params.dt_sim;
@@ -2877,6 +2938,7 @@ void FluoSimModel::stopSimulation()
 	clearProbeSignals();
 	clearRecordedProbeSignals();
 	m_scrn.clearCamera();
+	m_sriAccumulator.clear();
 
 	m_experiment_params.index_repetion = 0;
 
@@ -2928,7 +2990,7 @@ void FluoSimModel::setDestinationPath(string path)
 	m_experiment_params.file_destination = path;
 }
 
-void FluoSimModel::saveSimulationProducts()
+string FluoSimModel::getAbsoluteDestinationPath()
 {
 //create an absolute path from m_experiment_params.file_destination
 	QDir app_dir = m_main_app->applicationDirPath();
@@ -2947,11 +3009,19 @@ void FluoSimModel::saveSimulationProducts()
 			{
 				destinationDir_str = app_dir.absolutePath().toStdString() + '/' + destinationDir_str;
 			}
-			else return; //->
+			else return string(); //->
 		}
 	}
 
-	if(app_dir.exists(destinationDir_str.data()) == false) return; //->
+	if(app_dir.exists(destinationDir_str.data()) == false) return string(); //->
+
+	return destinationDir_str;
+}
+
+void FluoSimModel::saveSimulationProducts()
+{
+	string destinationDir_str = getAbsoluteDestinationPath();
+	if(destinationDir_str.empty()) return; //->
 
 //start saving
 	int m_nb_experimental_probes = m_experimental_probes_v.size();
@@ -2965,7 +3035,7 @@ void FluoSimModel::saveSimulationProducts()
                 Probe* probe = m_experimental_probes_v[probe_idx];
                 if(probe->getMeasureType() == Probe::TRACE_TRACKER)
 				{
-					auto traces = m_experimental_probes_v[probe_idx]->getAllTraces();
+					auto traces = m_experimental_probes_v[probe_idx]->takeAllTraces();
 					m_experimental_probes_v[probe_idx]->resetProbeMeasure();
 
 					string rgn_str = to_string(m_bioWorld->getRegionIdx(probe->getRegion1()));
@@ -3357,14 +3427,30 @@ void FluoSimModel::saveSimulationProducts()
 
 		case SRI_EXPERIMENT :
 		{
+			if(m_experiment_params.SRI_isCpuAccumulation == true)
+			{
+				string rep_str = to_string(m_experiment_params.index_repetion);
+				m_sriAccumulator.saveImage(destinationDir_str + string("/SRI_image_rep") + rep_str + string(".tiff"));
+				if(m_experiment_params.SRI_isExportingLocalisations == true)
+				{
+					m_sriAccumulator.saveLocalisations(destinationDir_str + string("/SRI_localisations_rep") + rep_str + string(".csv"),
+													   m_simulation_params.dt_sim, m_simulation_params.pixel_size);
+				}
+				break; //->
+			}
+
 			myGLScreen* window = m_scrn.getRenderWindow();
 			window->makeCurrent();
 
             vector<uint16> data_text;
 			gstd::gTexture& texture = m_scrn.getCameraTexture();
-            texture.getTextureData(data_text, GL_RED, GL_UNSIGNED_SHORT, 1);
+            {
+                PROFILE_ZONE("readback");
+                texture.getTextureData(data_text, GL_RED, GL_UNSIGNED_SHORT, 1);
+            }
             vec2 screen_size = texture.getSize();
 
+			PROFILE_ZONE("tiff I/O");
 			myTiff tiff;
 			string file_name =	destinationDir_str +
                                 string("/SRI_screen_capture_rep") +
@@ -3379,6 +3465,200 @@ void FluoSimModel::saveSimulationProducts()
         }
 		break;
 	}
+
+	//exported once all the saving zones above are closed
+	if(myProfiler::isEnabled())
+	{
+		myProfiler::exportChromeTrace(destinationDir_str + string("/profile_rep") +
+									  to_string(m_experiment_params.index_repetion) + string(".json"));
+		myProfiler::clear();
+	}
+}
+
+void FluoSimModel::accumulateLocalisations()
+{
+	if(m_bioWorld == 0 || m_bioWorld->getNbRegions() == 0) return; //->
+
+	//without background image there is no camera field : the image then covers the cell
+	if(m_sriAccumulator.isFieldSet() == false)
+	{
+		vec2 bottomLeft, topRight;
+		Region& cell = m_bioWorld->getRegionRef(0);
+		if(cell.getBottomLeft(bottomLeft) == false || cell.getTopRight(topRight) == false) return; //->
+
+		m_sriAccumulator.setField(bottomLeft, topRight, ivec2(m_experiment_params.SRI_zoom*(topRight - bottomLeft)));
+	}
+
+	m_sriAccumulator.setPointingAccuracy(m_experiment_params.SRI_pointingAccuracy / m_simulation_params.pixel_size);
+	m_sriAccumulator.setIsRecordingLocalisations(m_experiment_params.SRI_isExportingLocalisations);
+	m_bioWorld->accumulateLocalisations(m_sriAccumulator, m_simulation_params.current_plane);
+}
+
+int FluoSimModel::getNbPlanesToNextEvent()
+{
+	if(m_simulation_params.isTimeLapseFastForward == false ||
+	   m_simulation_states.simulator_mode != EXPERIMENT_MODE ||
+	   m_experiment_params.acquisitionType != TIMELAPSE_ACQUISITION) return 1; //->
+
+	long acquisition_period = lround(m_experiment_params.acquisitionPeriod/m_simulation_params.dt_sim);
+	if(acquisition_period <= 1) return 1; //->
+
+	//the skipped planes must not be acquired, bleached, photo-activated, drug-affected or checkpointed
+	int plane = m_simulation_params.current_plane + 1;
+	while(plane < m_experiment_params.N_planes)
+	{
+		if(plane >= 0 && plane % acquisition_period == 0) break; //->
+		if(isCheckpointPlane(plane)) break; //->
+		if(m_experiment_params.experimentType == FRAP_EXPERIMENT &&
+		   plane >= m_experiment_params.N_frap &&
+		   plane <= m_experiment_params.N_frap + m_experiment_params.dN_frap-1) break; //->
+		if(m_experiment_params.experimentType == PAF_EXPERIMENT &&
+		   plane >= m_experiment_params.N_photoActivation &&
+		   plane <= m_experiment_params.N_photoActivation + m_experiment_params.dN_photoActivation-1) break; //->
+		if(m_experiment_params.experimentType == DRUG_EXPERIMENT &&
+		   plane == m_experiment_params.N_drug) break; //->
+
+		plane++;
+	}
+
+	return std::max(plane - m_simulation_params.current_plane, 1);
+}
+
+static const unsigned int checkpoint_magic = 0x4B435346; //"FSCK" in little endian
+static const int checkpoint_version = 2; //2 : engine mode and world stream in the engine state
+
+bool FluoSimModel::isCheckpointPlane(int plane)
+{
+	if(m_simulation_states.simulator_mode != EXPERIMENT_MODE ||
+	   m_simulation_params.checkpoint_plane == NO_CHECKPOINT_PLANE) return false; //->
+
+	int dPlane = plane - m_simulation_params.checkpoint_plane;
+	if(dPlane == 0) return true; //->
+
+	return (dPlane > 0 && m_simulation_params.checkpoint_period > 0 && dPlane % m_simulation_params.checkpoint_period == 0);
+}
+
+bool FluoSimModel::saveCheckpoint(string file_path)
+{
+	if(m_bioWorld == 0) return false; //->
+
+	myBinaryWriter writer;
+	if(writer.open(file_path) == false)
+	{
+		cout<<"In FluoSimModel::saveCheckpoint : error (cannot open "<<file_path<<")\n";
+		return false; //->
+	}
+
+	//the C generator (used to create particles) can't be saved : it is reseeded here and at restoring
+	unsigned int crand_seed = rand();
+	srand(crand_seed);
+
+	writer.write(checkpoint_magic);
+	writer.write<int>(checkpoint_version);
+	writer.write<int>(m_experiment_params.index_repetion);
+	writer.write<int>(m_simulation_params.current_plane);
+	writer.write<float>(m_simulation_params.current_time);
+	writer.write<unsigned int>(crand_seed);
+
+	writer.write<int>(m_recordedSignalValues_perRep_perProbe.size());
+	for(auto& recordedSignalValues_perProbe : m_recordedSignalValues_perRep_perProbe)
+	{
+		writer.write<int>(recordedSignalValues_perProbe.size());
+		for(auto& recordedSignalValues : recordedSignalValues_perProbe) writer.writeVector(recordedSignalValues);
+	}
+
+	m_bioWorld->saveState(writer);
+	m_engine->saveState(writer);
+	m_probe.saveState(writer);
+
+	writer.write<int>(m_experimental_probes_v.size());
+	for(Probe* probe : m_experimental_probes_v) probe->saveState(writer);
+
+	writer.write(checkpoint_magic);
+
+	bool isSaved = writer.isGood();
+	writer.close();
+	if(isSaved == false) cout<<"In FluoSimModel::saveCheckpoint : error (cannot write "<<file_path<<")\n";
+
+	return isSaved;
+}
+
+bool FluoSimModel::loadCheckpoint(string file_path)
+{
+	if(m_bioWorld == 0) return false; //->
+
+	myBinaryReader reader;
+	if(reader.open(file_path) == false)
+	{
+		cout<<"In FluoSimModel::loadCheckpoint : error (cannot open "<<file_path<<")\n";
+		return false; //->
+	}
+
+	unsigned int magic;
+	int version;
+	reader.read(magic);
+	reader.read(version);
+	if(reader.isGood() == false || magic != checkpoint_magic || version != checkpoint_version)
+	{
+		cout<<"In FluoSimModel::loadCheckpoint : error ("<<file_path<<" is not a checkpoint of this version)\n";
+		return false; //->
+	}
+
+	int index_repetion, current_plane;
+	float current_time;
+	unsigned int crand_seed;
+	reader.read(index_repetion);
+	reader.read(current_plane);
+	reader.read(current_time);
+	reader.read(crand_seed);
+
+	vector<vector<vector<vec2> > > recordedSignalValues_perRep_perProbe;
+	int nb_reps;
+	reader.read(nb_reps);
+	for(int rep_idx = 0; rep_idx <= nb_reps-1 && reader.isGood(); rep_idx++)
+	{
+		int nb_probes;
+		reader.read(nb_probes);
+		recordedSignalValues_perRep_perProbe.push_back(vector<vector<vec2> >(std::max(nb_probes, 0)));
+		for(auto& recordedSignalValues : recordedSignalValues_perRep_perProbe.back()) reader.readVector(recordedSignalValues);
+	}
+
+	//the drug has already been administered : the world gets its drug parameters before its state
+	if(m_simulation_states.simulator_mode == EXPERIMENT_MODE &&
+	   m_experiment_params.experimentType == DRUG_EXPERIMENT &&
+	   current_plane > m_experiment_params.N_drug)
+	{
+		m_dynamic_params.isDrugAffected = true;
+		updateDynamicParams();
+		m_dynamic_params.isDrugAffected = false;
+	}
+
+	bool isLoaded = reader.isGood() && m_bioWorld->loadState(reader) && m_engine->loadState(reader) && m_probe.loadState(reader);
+
+	int nb_experimentalProbes = -1;
+	if(isLoaded) reader.read(nb_experimentalProbes);
+	if(nb_experimentalProbes != int(m_experimental_probes_v.size())) isLoaded = false;
+	for(int probe_idx = 0; probe_idx <= nb_experimentalProbes-1 && isLoaded; probe_idx++)
+	{
+		isLoaded = m_experimental_probes_v[probe_idx]->loadState(reader);
+	}
+
+	if(isLoaded) reader.read(magic);
+	if(isLoaded == false || reader.isGood() == false || magic != checkpoint_magic)
+	{
+		cout<<"In FluoSimModel::loadCheckpoint : error ("<<file_path<<" does not match the project or is corrupted)\n";
+		clearProbeSignals();
+		return false; //->
+	}
+
+	m_experiment_params.index_repetion = index_repetion;
+	m_simulation_params.current_plane = current_plane;
+	m_simulation_params.current_time = current_time;
+	m_recordedSignalValues_perRep_perProbe = recordedSignalValues_perRep_perProbe;
+	srand(crand_seed);
+	m_isCheckpointRestored = true;
+
+	return true;
 }
 
 void FluoSimModel::setSimulatorMode(SIMULATOR_MODE simulator_mode)
@@ -3487,8 +3767,10 @@ void FluoSimModel::updateBioWorld()
 {
 	if(m_bioWorld == 0) return; //->
 
-    m_engine->updateSystem(m_simulation_params.dt_sim);
-	m_simulation_params.current_plane++;
+	int nb_planes = getNbPlanesToNextEvent();
+	if(nb_planes > 1) m_engine->updateSystem(m_simulation_params.dt_sim, nb_planes);
+	else m_engine->updateSystem(m_simulation_params.dt_sim);
+	m_simulation_params.current_plane += nb_planes;
     m_simulation_params.current_time = m_simulation_params.current_plane*m_simulation_params.dt_sim;
 }
 
@@ -3496,6 +3778,8 @@ void FluoSimModel::measureBioWorld()
 {
 	if(m_bioWorld == 0) return; //->
 
+	PROFILE_ZONE("measure");
+
 	if(m_simulation_states.simulator_mode == LIVE_MODE ||
 	   m_experiment_params.acquisitionType == STREAM_ACQUISITION)
 	{
@@ -3508,8 +3792,12 @@ void FluoSimModel::measureBioWorld()
 		{
 			if(m_experiment_params.experimentType == SRI_EXPERIMENT)
 			{
-                setRenderingParams(&m_stormRendering_params);
-                renderBioWorld();
+				if(m_experiment_params.SRI_isCpuAccumulation == true) accumulateLocalisations();
+				else
+				{
+					setRenderingParams(&m_stormRendering_params);
+					renderBioWorld();
+				}
 			}
 			else
 			{
@@ -3534,8 +3822,12 @@ void FluoSimModel::measureBioWorld()
 			if(m_experiment_params.experimentType == SRI_EXPERIMENT)
 			{
 //				renderBioWorldCamera();
-                setRenderingParams(&m_stormRendering_params);
-                renderBioWorld();
+				if(m_experiment_params.SRI_isCpuAccumulation == true) accumulateLocalisations();
+				else
+				{
+					setRenderingParams(&m_stormRendering_params);
+					renderBioWorld();
+				}
             }
 			else
 			{
@@ -3854,6 +4146,7 @@ void FluoSimModel::updateExperimentParams()
 		}
 		break;
 	}
+	bindProbesToEngine(); //gaussian beam measures draw from the engine streams
 
 //FRAP HEADS
 	m_experimental_frapHead_v.clear();
@@ -3995,6 +4288,7 @@ void FluoSimModel::updateRenderingParams()
 		m_scrn.setCameraDefinition(size);
 		m_scrn.setCameraField(bottomLeft,
 							  topRight);
+		m_sriAccumulator.setField(bottomLeft, topRight, ivec2(size));
 	}
 
 
@@ -43,6 +43,7 @@
 
 #include "cellEngine_library_global.h"
     #include "Measure/Trace.h"
+    #include "Measure/TraceBatchAnalyser.h"
     #include "Measure/Signal.h"
 
 #include "toolBox_src/toolbox_library_global.h"
@@ -320,6 +321,9 @@ public  :
 	void filter();
 	void computeMSDsAndDs(float pixel_size, float dt);
 
+	myTraceAnalysisParams getAnalysisParams() const;
+	void exportDsHistogramsInBatch(); //<file>_D.txt for each file of m_tracePaths_v, without loading them in the player
+
 	//rendering text
 
 	void updateCurrentPlaneWord();
@@ -328,6 +332,11 @@ public  :
 
 protected :
 
+	void _uploadTraces(); //traces to the gl buffers and textures
+	void _connectColorUniforms(gstd::gProgram& program);
+	void _renderTrajectories(glm::mat4& world_to_screen);
+	void _renderEvents(glm::mat4& world_to_screen);
+
 	//file
 	string m_last_dir;
 	float m_pixel_size;
@@ -368,7 +377,7 @@ protected :
 
 	//data
 	std::vector<Trace> m_traces;
-	std::vector<Trace> m_filteredTraces;
+	std::vector<int> m_filteredIdx_v; //view of m_traces : indices of the traces passing the filters
 
 	long m_current_plane;
 	long m_min_plane;
@@ -388,19 +397,33 @@ protected :
 	float m_lineIntensity;
 	glm::mat4 m_scaling_matrix;
 
-	gstd::gProgram m_pgm_gaussianBandW;
-	gstd::gProgram m_pgm_gaussianColor;
-	gstd::gProgram m_pgm_lineColor;
-	gstd::gProgram m_pgm_lineBandW;
-
 	gstd::gProgram m_pgm_events;
 	gstd::gProgram m_pgm_trajectories;
+	gstd::gTexture m_gaussian_texture;
 
-	gstd::gVector<glm::vec4> m_gColor;
+	//all the traces, uploaded once per loading or D computation : the events trace after trace, colors looked up in the shaders
 	gstd::gVector<glm::vec2> m_gR;
-	gstd::gVector<glm::vec2> m_gR_traces;
-	gstd::gVector<glm::vec4> m_gColor_traces;
-	gstd::gTexture m_gaussian_texture;
+	gstd::gVector<int> m_gPlanes;
+	gstd::gVector<int> m_gTraceIdx;
+	gstd::gTexture m_traceColors_texture; //per trace : random color
+	gstd::gTexture m_traceValues_texture; //per trace : log D, is D calculated, length
+	gstd::gTexture m_eventValues_texture; //per event : log DInst, color kind
+	gstd::gTexture m_lut_texture;
+	bool m_isTraces_modified;
+	bool m_isLut_modified;
+
+	std::vector<GLint> m_traceFirsts_v; //first event of each trace in the buffers
+	std::vector<GLsizei> m_traceLengths_v;
+	std::vector<glm::ivec2> m_tracePlaneRanges_v;
+
+	//draw ranges and uniforms of the filtered traces, current plane and modes
+	std::vector<GLint> m_trajectoriesFirsts_v;
+	std::vector<GLsizei> m_trajectoriesCounts_v;
+	std::vector<GLint> m_eventsFirsts_v;
+	std::vector<GLsizei> m_eventsCounts_v;
+	int m_eventsPlane; //-1 : every plane
+	glm::vec2 m_lutRange;
+	glm::vec2 m_lengthRange;
 
 	Signal m_D_distribution_sig;
 	Signal m_lengths_distribution_sig;
@@ -651,7 +651,7 @@ void TracePlayerControl::onExportButtonGetClicked()
 													  "SimulationOutputs", this);
 			if(isFile_selected == true)
 			{
-				saveTracesMSDsAsString(m_filteredTraces, file_path);
+				saveTracesMSDsAsString(m_traces, m_filteredIdx_v, file_path);
 			}
 
 		}
@@ -664,7 +664,7 @@ void TracePlayerControl::onExportButtonGetClicked()
 													  "SimulationOutputs", this);
 			if(isFile_selected == true)
 			{
-				saveTracesDsAsString(m_filteredTraces, file_path);
+				saveTracesDsAsString(m_traces, m_filteredIdx_v, file_path);
 			}
 		}
 		break;
@@ -676,7 +676,7 @@ void TracePlayerControl::onExportButtonGetClicked()
 													  "SimulationOutputs", this);
 			if(isFile_selected == true)
 			{
-				saveTracesDInstsAsString(m_filteredTraces, file_path);
+				saveTracesDInstsAsString(m_traces, m_filteredIdx_v, file_path);
 			}
 		}
 		break;
@@ -700,7 +700,7 @@ void TracePlayerControl::onExportButtonGetClicked()
 															  "SimulationOutputs", this);
 					if(isFile_selected == true)
 					{
-						saveTracesLogDsHistogramAsString(m_filteredTraces, file_path,
+						saveTracesLogDsHistogramAsString(m_traces, m_filteredIdx_v, file_path,
 														 m_DsHistogram_nbIntervals,
 														 m_DsHistogram_minValue,
 														 m_DsHistogram_maxValue);
@@ -711,37 +711,7 @@ void TracePlayerControl::onExportButtonGetClicked()
 
 				case true :
 				{
-					int trace_path_idx = 0;
-					QString path_qstr;
-
-					auto trace_path = m_tracePaths_v.begin();
-					while(trace_path != m_tracePaths_v.end())
-					{
-
-						path_qstr = QString(trace_path->data());
-						if(path_qstr.endsWith(".trc"))
-						{
-							cout<<"****"<<path_qstr.toLocal8Bit().data()<<"\n";
-							setTracesFromStringFile(path_qstr.toLocal8Bit().data());
-						}
-
-						if(path_qstr.endsWith(".btrc"))
-						{
-							setTracesFromBinaryFile(path_qstr.toLocal8Bit().data());
-						}
-
-						render();
-						getGLWidget()->swapBuffers();
-						D_path = *trace_path
-							   + "_D.txt";
-
-						trace_path_idx++;
-						trace_path++;
-
-						saveTracesLogDsHistogramAsString(m_filteredTraces, D_path, m_DsHistogram_nbIntervals,
-																		 m_DsHistogram_minValue,
-																		 m_DsHistogram_maxValue);
-					}
+					exportDsHistogramsInBatch();
 				}
 				break;
 			}
@@ -768,7 +738,7 @@ void TracePlayerControl::onExportButtonGetClicked()
 															  "SimulationOutputs", this);
 					if(isFile_selected == true)
 					{
-						saveTracesLogDInstsHistogramAsString(m_filteredTraces, file_path, m_DsHistogram_nbIntervals,
+						saveTracesLogDInstsHistogramAsString(m_traces, m_filteredIdx_v, file_path, m_DsHistogram_nbIntervals,
 															 m_DsHistogram_minValue,
 															 m_DsHistogram_maxValue);
 					}
@@ -830,7 +800,7 @@ void TracePlayerControl::onExportButtonGetClicked()
 													  "SimulationOutputs", this);
 			if(isFile_selected == true)
 			{
-				saveTracesLengthsHistogramAsString(m_filteredTraces, file_path, m_lengthsHistogram_nbIntervals,
+				saveTracesLengthsHistogramAsString(m_traces, m_filteredIdx_v, file_path, m_lengthsHistogram_nbIntervals,
 												   m_lengthsHistogram_minValue,
 												   m_lengthsHistogram_maxValue);
 			}
@@ -886,7 +856,7 @@ void TracePlayerControl::onExportButtonGetClicked()
 						exported_format = SVG_MULTICOLOR_FORMAT;
 					}
 
-					saveTracesAsString(m_filteredTraces, file_path, exported_format, m_timestep, 0, m_pixel_size);
+					saveTracesAsString(m_traces, m_filteredIdx_v, file_path, exported_format, m_timestep, 0, m_pixel_size);
 				}
 			}
 		}
@@ -974,12 +944,12 @@ void TracePlayerControl::onClearMovieAction()
 void TracePlayerControl::onSaveFileAction()
 {
 	string file_dir = "Ds.txt";
-	saveTracesDsAsString(TracePlayerControl::m_filteredTraces, file_dir);
+	saveTracesDsAsString(m_traces, m_filteredIdx_v, file_dir);
 }
 
 void TracePlayerControl::onMSDExportAction()
 {
-    saveTracesMSDsAsString(m_filteredTraces, "MSD.txt");
+    saveTracesMSDsAsString(m_traces, m_filteredIdx_v, "MSD.txt");
 }
 
 void TracePlayerControl::onMultipageTiffExportAction()
@@ -1045,7 +1015,7 @@ void TracePlayerControl::onDsHistogramExportAction()
 				   + "_mx"
 				   + to_string(int(m_DsHistogram_maxValue))
 				   + ".txt";
-			saveTracesLogDsHistogramAsString(m_filteredTraces, D_path, m_DsHistogram_nbIntervals,
+			saveTracesLogDsHistogramAsString(m_traces, m_filteredIdx_v, D_path, m_DsHistogram_nbIntervals,
 															 m_DsHistogram_minValue,
 															 m_DsHistogram_maxValue);
 		}
@@ -1054,37 +1024,7 @@ void TracePlayerControl::onDsHistogramExportAction()
 
 		case true :
 		{
-			int trace_path_idx = 0;
-			QString path_qstr;
-
-			auto trace_path = m_tracePaths_v.begin();
-			while(trace_path != m_tracePaths_v.end())
-			{
-
-				path_qstr = QString(trace_path->data());
-				if(path_qstr.endsWith(".trc"))
-				{
-					setTracesFromStringFile(path_qstr.toLocal8Bit().data());
-				}
-
-				if(path_qstr.endsWith(".btrc"))
-				{
-					setTracesFromBinaryFile(path_qstr.toLocal8Bit().data());
-				}
-
-				render();
-				getGLWidget()->swapBuffers();
-
-				D_path = *trace_path
-					   + "_D.txt";
-
-				trace_path_idx++;
-				trace_path++;
-
-				saveTracesLogDsHistogramAsString(m_filteredTraces, D_path, m_DsHistogram_nbIntervals,
-																 m_DsHistogram_minValue,
-																 m_DsHistogram_maxValue);
-			}
+			exportDsHistogramsInBatch();
 		}
 		break;
 	}
@@ -1102,7 +1042,7 @@ void TracePlayerControl::onLengthsHistogramExportAction()
 		   + to_string(int(m_lengthsHistogram_maxValue))
 		   + ".txt";
 
-	saveTracesLengthsHistogramAsString(m_filteredTraces, file, m_lengthsHistogram_nbIntervals,
+	saveTracesLengthsHistogramAsString(m_traces, m_filteredIdx_v, file, m_lengthsHistogram_nbIntervals,
 													   m_lengthsHistogram_minValue,
 													   m_lengthsHistogram_maxValue);
 }
@@ -20,8 +20,16 @@
 
 
 
+#include "functional"
+#include "limits"
+
+#include "QtWidgets/QMessageBox"
+
 #include "TracePlayer.h"
 
+#include "toolBox_src/toolbox_library_global.h"
+    #include "toolBox_src/parallelTools/myWorkStealingPool.h"
+
 using namespace glm;
 
 
@@ -35,13 +43,13 @@ bool comp(vec2 v1, vec2 v2)
 
 TracePlayerModel::TracePlayerModel(myGLWidget* glWidget, QWidget* parent) : TracePlayerView(parent),
 
-	m_pgm_gaussianBandW("gaussianBandW"),
-	m_pgm_gaussianColor("gaussianColor"),
-	m_pgm_lineColor("lineColor"),
-	m_pgm_lineBandW("lineBandW"),
 	m_pgm_events("events"),
 	m_pgm_trajectories("trajectories"),
 	m_gaussian_texture(GL_TEXTURE_2D),
+	m_traceColors_texture(GL_TEXTURE_2D),
+	m_traceValues_texture(GL_TEXTURE_2D),
+	m_eventValues_texture(GL_TEXTURE_2D),
+	m_lut_texture(GL_TEXTURE_2D),
     m_font("Resources/Fonts/font_glWord.png", test_desc),
 	m_currentPlane_word(&m_font),
 	m_numberTraces_word(&m_font),
@@ -51,61 +59,86 @@ TracePlayerModel::TracePlayerModel(myGLWidget* glWidget, QWidget* parent) : Trac
 
 	m_lut.loadLUT("ncl_default.rgb");
 
-	string vsBandW_src;
-	vsBandW_src +=	"#version 150 core\n"
-				"\n"
-				"in vec2 R;\n"
-				"out vec4 color;\n"
+	//per trace or per event color, selected by color_mode (COLOR_MODE) : nothing is uploaded when the LUT range or the mode change
+	string colorFunction_src;
+	colorFunction_src +=	"uniform int color_mode;\n"
+				"uniform vec2 lut_range;\n"
+				"uniform vec2 length_range;\n"
+				"uniform sampler2D lut_texture;\n"
+				"uniform sampler2D traceColors_texture;\n"
+				"uniform sampler2D traceValues_texture;\n"
+				"uniform sampler2D eventValues_texture;\n"
 				"\n"
-				"void main(void)\n"
+				"ivec2 getTexel(int idx)\n"
 				"{\n"
-				"	vec4 temp = vec4(R,0.0, 1.0);\n"
-				"	gl_Position = temp;\n"
-				"	color = vec4(1,1,1,1);\n"
-				"}\n";
-
-	string vsColor_src;
-	vsColor_src +=	"#version 150 core\n"
+				"	return ivec2(idx % 4096, idx / 4096);\n"
+				"}\n"
 				"\n"
-				"in vec2 R;\n"
-				"in vec4 color_in;\n"
-				"out vec4 color;\n"
+				"vec4 getLUTColor(float alpha)\n"
+				"{\n"
+				"	return texelFetch(lut_texture, ivec2(int(clamp(alpha, 0.0, 1.0)*253.0), 0), 0);\n"
+				"}\n"
 				"\n"
-				"void main(void)\n"
+				"vec4 getColor(int trace_idx, int event_idx)\n"
 				"{\n"
-				"	vec4 temp = vec4(R,0.0, 1.0);\n"
-				"	gl_Position = temp;\n"
-				"	color = color_in;\n"
+				"	if(color_mode == 1) return texelFetch(traceColors_texture, getTexel(trace_idx), 0);\n"
+				"\n"
+				"	vec4 trace_values = texelFetch(traceValues_texture, getTexel(trace_idx), 0);\n"
+				"	if(color_mode == 2)\n"
+				"	{\n"
+				"		if(trace_values.y == 0.0) return vec4(1,1,1,1);\n"
+				"		return getLUTColor((trace_values.x - lut_range.x)/(lut_range.y - lut_range.x));\n"
+				"	}\n"
+				"	if(color_mode == 3)\n"
+				"	{\n"
+				"		vec4 event_values = texelFetch(eventValues_texture, getTexel(event_idx), 0);\n"
+				"		if(event_values.y == 1.0) return vec4(1,1,1,1);\n"
+				"		if(event_values.y == 2.0) return vec4(0,0,0,1);\n"
+				"		return getLUTColor((event_values.x - lut_range.x)/(lut_range.y - lut_range.x));\n"
+				"	}\n"
+				"	if(color_mode == 4)\n"
+				"	{\n"
+				"		if(length_range.y == length_range.x) return vec4(1,1,1,1);\n"
+				"		return getLUTColor((trace_values.z - length_range.x)/(length_range.y - length_range.x));\n"
+				"	}\n"
+				"	return vec4(1,1,1,1);\n"
 				"}\n";
 
-	string vsLineColor_src;
-	vsLineColor_src +=	"#version 150 core\n"
+	string vsEvents_src;
+	vsEvents_src +=	"#version 150 core\n"
 				"\n"
 				"in vec2 R;\n"
-				"in vec4 color_in;\n"
-				"uniform mat4 scaling_matrix;\n"
+				"in int plane;\n"
+				"in int trace_idx;\n"
+				"uniform int current_plane;\n"
 				"out vec4 color;\n"
+				"flat out int isVisible;\n"
+				"\n"
+				+ colorFunction_src +
 				"\n"
 				"void main(void)\n"
 				"{\n"
 				"	vec4 temp = vec4(R,0.0, 1.0);\n"
-				"	gl_Position = scaling_matrix*temp;\n"
-				"	color = color_in;\n"
+				"	gl_Position = temp;\n"
+				"	color = getColor(trace_idx, gl_VertexID);\n"
+				"	isVisible = (current_plane == -1 || plane == current_plane) ? 1 : 0;\n"
 				"}\n";
 
-	string vsLineBandW_src;
-	vsLineBandW_src +=	"#version 150 core\n"
+	string vsTrajectories_src;
+	vsTrajectories_src +=	"#version 150 core\n"
 				"\n"
 				"in vec2 R;\n"
-				"in vec4 color_in;\n"
+				"in int trace_idx;\n"
 				"uniform mat4 scaling_matrix;\n"
-				"out vec4 color;\n"
+				"flat out vec4 color;\n"
+				"\n"
+				+ colorFunction_src +
 				"\n"
 				"void main(void)\n"
 				"{\n"
 				"	vec4 temp = vec4(R,0.0, 1.0);\n"
 				"	gl_Position = scaling_matrix*temp;\n"
-				"	color =  vec4(1,1,1,1);\n"
+				"	color = getColor(trace_idx, gl_VertexID);\n"
 				"}\n";
 
 	string gs_src;
@@ -115,7 +148,7 @@ TracePlayerModel::TracePlayerModel(myGLWidget* glWidget, QWidget* parent) : Trac
 	gs_src+= "layout (triangle_strip, max_vertices = 4) out ;\n";
 	gs_src+= "uniform vec2 square_size;\n";
 	gs_src+= "uniform mat4 scaling_matrix;\n";
-//		gs_src+= "in int isVisible[];\n";
+	gs_src+= "flat in int isVisible[];\n";
 	gs_src+= "in vec4 color[];\n";
 	gs_src+= "out vec2 TexCoords_GS;\n";
 	gs_src+= "out vec4 colorGS;\n";
@@ -123,9 +156,8 @@ TracePlayerModel::TracePlayerModel(myGLWidget* glWidget, QWidget* parent) : Trac
 	gs_src+= "\n\n";
 	gs_src+= "void main(void)\n";
 	gs_src+= "{\n";
-//		gs_src+= "	if(isVisible[0] == 1)\n";
-//		gs_src+= "	{\n";
-	gs_src+= "		float size_text = 10;\n";
+	gs_src+= "	if(isVisible[0] == 1)\n";
+	gs_src+= "	{\n";
 	gs_src+= "		colorGS = color[0];\n";
 	gs_src+= "		gl_Position = scaling_matrix*(gl_in[0].gl_Position + vec4(square_size.x,square_size.y,0,0));\n";
 	gs_src+= "		TexCoords_GS = vec2(1,1);\n";
@@ -142,7 +174,7 @@ TracePlayerModel::TracePlayerModel(myGLWidget* glWidget, QWidget* parent) : Trac
 	gs_src+= "		gl_Position = scaling_matrix*(gl_in[0].gl_Position + vec4(-square_size.x,-square_size.y,0,0));\n";
 	gs_src+= "		TexCoords_GS = vec2(0,0);\n";
 	gs_src+= "		EmitVertex();\n";
-//		gs_src+= "	}\n";
+	gs_src+= "	}\n";
 	gs_src+= "}";
 
 	string fs_src;
@@ -159,10 +191,11 @@ TracePlayerModel::TracePlayerModel(myGLWidget* glWidget, QWidget* parent) : Trac
 				"	gl_FragColor = spot_intensity*length(texture(texture_id, TexCoords_GS).xyz)*colorGS;\n"
 				"}\n";
 
-	string fsLineColor_src;
-	fsLineColor_src +=	"#version 150 core\n\n"
+	//flat : a segment takes the color of its last event
+	string fsTrajectories_src;
+	fsTrajectories_src +=	"#version 150 core\n\n"
 				"\n"
-				"in vec4 color;\n"
+				"flat in vec4 color;\n"
 				"out vec4 gl_FragColor;\n"
 				"uniform float line_intensity;\n"
 				"\n"
@@ -172,21 +205,13 @@ TracePlayerModel::TracePlayerModel(myGLWidget* glWidget, QWidget* parent) : Trac
 				"}\n";
 
 //vs_shaders
-	gstd::gShader vs_BandW(gstd::VERTEX_SHADER);
-		vs_BandW.setSource(vsBandW_src, 0);
-		vs_BandW.compile();
-
-	gstd::gShader vs_Color(gstd::VERTEX_SHADER);
-		vs_Color.setSource(vsColor_src, 0);
-		vs_Color.compile();
-
-	gstd::gShader vs_lineColor(gstd::VERTEX_SHADER);
-		vs_lineColor.setSource(vsLineColor_src, 0);
-		vs_lineColor.compile();
+	gstd::gShader vs_events(gstd::VERTEX_SHADER);
+		vs_events.setSource(vsEvents_src, 0);
+		vs_events.compile();
 
-	gstd::gShader vs_lineBandW(gstd::VERTEX_SHADER);
-		vs_lineBandW.setSource(vsLineBandW_src, 0);
-		vs_lineBandW.compile();
+	gstd::gShader vs_trajectories(gstd::VERTEX_SHADER);
+		vs_trajectories.setSource(vsTrajectories_src, 0);
+		vs_trajectories.compile();
 
 //gs_shaders
 	gstd::gShader gs(gstd::GEOMETRY_SHADER);
@@ -202,30 +227,27 @@ TracePlayerModel::TracePlayerModel(myGLWidget* glWidget, QWidget* parent) : Trac
 		fs.setSource(fs_src, 0);
 		fs.compile();
 
-	gstd::gShader fs_lineColor(gstd::FRAGMENT_SHADER);
-		fs_lineColor.setSource(fsLineColor_src, 0);
-		fs_lineColor.compile();
+	gstd::gShader fs_trajectories(gstd::FRAGMENT_SHADER);
+		fs_trajectories.setSource(fsTrajectories_src, 0);
+		fs_trajectories.compile();
 
 	string log;
 
-	m_pgm_gaussianBandW.addShader(vs_BandW);
-	m_pgm_gaussianBandW.addShader(gs);
-	m_pgm_gaussianBandW.addShader(fs);
-	m_pgm_gaussianBandW.linkShaders(log);
-	m_pgm_gaussianBandW.useProgram(0);
+	m_pgm_events.addShader(vs_events);
+	m_pgm_events.addShader(gs);
+	m_pgm_events.addShader(fs);
+	m_pgm_events.linkShaders(log);
+	m_pgm_events.useProgram(0);
 
-	m_pgm_gaussianColor.addShader(vs_Color);
-	m_pgm_gaussianColor.addShader(gs);
-	m_pgm_gaussianColor.addShader(fs);
-	m_pgm_gaussianColor.linkShaders(log);
+	m_pgm_trajectories.addShader(vs_trajectories);
+	m_pgm_trajectories.addShader(fs_trajectories);
+	m_pgm_trajectories.linkShaders(log);
 
-	m_pgm_lineColor.addShader(vs_lineColor);
-	m_pgm_lineColor.addShader(fs_lineColor);
-	m_pgm_lineColor.linkShaders(log);
-
-	m_pgm_lineBandW.addShader(vs_lineBandW);
-	m_pgm_lineBandW.addShader(fs_lineColor);
-	m_pgm_lineBandW.linkShaders(log);
+	m_isTraces_modified = true;
+	m_isLut_modified = true;
+	m_eventsPlane = -1;
+	m_lutRange = vec2(0,1);
+	m_lengthRange = vec2(0,0);
 
 	m_gaussian_texture = gstd::genGaussianTexture(vec2(256,256), 0.2);
 
@@ -256,6 +278,7 @@ TracePlayerModel::TracePlayerModel(myGLWidget* glWidget, QWidget* parent) : Trac
 void TracePlayerModel::setLUT(const string& lut_path)
 {
 	m_lut.loadLUT(lut_path);
+	m_isLut_modified = true;
 	updateRenderingPipeline();
 }
 
@@ -330,6 +353,7 @@ void TracePlayerModel::clearTraces()
 {
 	m_trace_path = "";
 	m_traces.clear();
+	m_isTraces_modified = true;
 	filter();
 
 	updateRenderingPipeline();
@@ -349,6 +373,8 @@ void TracePlayerModel::clearTraces()
 void TracePlayerModel::setTracesDsFromStringFile(string path)
 {
 	loadDAsString(m_traces, path);
+
+	m_isTraces_modified = true;
 }
 
 void TracePlayerModel::setMovieFromStringFile(string path)
@@ -399,113 +425,203 @@ long TracePlayerModel::getCurrentPlane()
 	return m_current_plane;
 }
 
-void TracePlayerModel::updateRenderingPipeline()
+//the per trace (or per event) data are laid out in rows of 4096 texels, read with texelFetch
+static void loadDataTexture(gstd::gTexture& texture, vector<vec4>& data_v)
 {
-	vector<vec2> r_events_v;
-	vector<vec4> color_events_v;
-	vector<vec2> r_trajectories_v;
-	vector<vec4> color_trajectories_v;
+	const int row_size = 4096;
+	int nb_rows = std::max(1, (int(data_v.size()) + row_size-1)/row_size);
+	data_v.resize(nb_rows*row_size, vec4(0,0,0,0));
 
-	//***Color Mode***
-	switch(m_colorMode)
+	texture.loadTexture(row_size, nb_rows, GL_RGBA32F, GL_RGBA, GL_FLOAT, data_v.data());
+}
+
+//process(trc_idx) for every trace, by blocks of traces on a work-stealing pool (inline for a single block)
+static void forEachTrace(int nb_traces, const function<void(int)>& process)
+{
+	const int nb_traces_perTask = 4096;
+	int nb_tasks = (nb_traces + nb_traces_perTask-1)/nb_traces_perTask;
+
+	myWorkStealingPool pool;
+	pool.run(nb_tasks, [&](int task_idx, int worker_idx)
 	{
-		case BANDW_COLOR_MODE :
-		{
-			m_pgm_events = m_pgm_gaussianBandW;
-			m_pgm_trajectories = m_pgm_lineBandW;
-		}
-		break;
+		int last_trc = std::min(nb_traces, (task_idx+1)*nb_traces_perTask);
+		for(int trc_idx = task_idx*nb_traces_perTask; trc_idx < last_trc; trc_idx++) process(trc_idx);
+	});
+}
 
-		case RANDOM_COLOR_MODE :
-		{
-			m_pgm_events = m_pgm_gaussianColor;
-			m_pgm_trajectories = m_pgm_lineColor;
+void TracePlayerModel::_uploadTraces()
+{
+	int nb_traces = m_traces.size();
 
-			setTracesColorsRandom(m_filteredTraces);
-		}
-		break;
+	//offsets of the traces in the buffers, then each trace is written at its offset in parallel
+	m_traceFirsts_v.resize(nb_traces);
+	m_traceLengths_v.resize(nb_traces);
+	m_tracePlaneRanges_v.resize(nb_traces);
 
-		case D_COLOR_MODE :
-		{
-			m_pgm_events = m_pgm_gaussianColor;
-			m_pgm_trajectories = m_pgm_lineColor;
+	int nb_events = 0;
+	for(int trc_idx = 0; trc_idx <= nb_traces-1; trc_idx++)
+	{
+		m_traceFirsts_v[trc_idx] = nb_events;
+		m_traceLengths_v[trc_idx] = m_traces[trc_idx].getLength();
+		nb_events += m_traceLengths_v[trc_idx];
+	}
 
-			setTracesColorsUsingDs(m_filteredTraces, m_lut, m_lut_minValue, m_lut_maxValue);
-		}
-		break;
+	vector<vec2> r_v(nb_events);
+	vector<int> planes_v(nb_events);
+	vector<int> traceIdx_v(nb_events);
+	vector<vec4> eventValues_v(nb_events);
+	vector<vec4> traceColors_v(nb_traces);
+	vector<vec4> traceValues_v(nb_traces);
 
+	forEachTrace(nb_traces, [&](int trc_idx)
+	{
+		Trace& trc = m_traces[trc_idx];
+		int length = m_traceLengths_v[trc_idx];
 
-		case DINST_COLOR_MODE :
-		{
-			m_pgm_events = m_pgm_gaussianColor;
-			m_pgm_trajectories = m_pgm_lineColor;
+		if(length == 0) m_tracePlaneRanges_v[trc_idx] = ivec2(1,0); //never inside the range
+		else m_tracePlaneRanges_v[trc_idx] = ivec2(trc.getFirstEvent().plane, trc.getLastEvent().plane);
 
-			setTracesColorsUsingDInsts(m_filteredTraces, m_lut, m_lut_minValue, m_lut_maxValue);
-		}
-		break;
+		traceColors_v[trc_idx] = trc.getUniqueColor();
+		if(trc.isDCalculated()) traceValues_v[trc_idx] = vec4(log10(trc.getD()), 1, length, 0);
+		else traceValues_v[trc_idx] = vec4(0, 0, length, 0);
 
-		case LENGTH_COLOR_MODE :
+		const vector<float>* DInsts_v = trc.isDInstCalculated() ? &trc.getDInsts() : 0;
+		for(int event_idx = 0; event_idx <= length-1; event_idx++)
 		{
-			m_pgm_events = m_pgm_gaussianColor;
-			m_pgm_trajectories = m_pgm_lineColor;
+			int vertex_idx = m_traceFirsts_v[trc_idx] + event_idx;
 
-			setTracesColorsUsingLengths(m_filteredTraces, m_lut);
+			const FluoEvent& event = trc.getFluoEventByRef(event_idx);
+			r_v[vertex_idx] = vec2(event.x, event.y);
+			planes_v[vertex_idx] = event.plane;
+			traceIdx_v[vertex_idx] = trc_idx;
+
+			//color kind : 0 LUT, 1 white (no DInst), 2 black (negative DInst)
+			if(DInsts_v == 0) eventValues_v[vertex_idx] = vec4(0, 1, 0, 0);
+			else if((*DInsts_v)[event_idx] < 0) eventValues_v[vertex_idx] = vec4(0, 2, 0, 0);
+			else eventValues_v[vertex_idx] = vec4(log10((*DInsts_v)[event_idx]), 0, 0, 0);
 		}
-		break;
+	});
+
+	m_gR.clear();
+	m_gPlanes.clear();
+	m_gTraceIdx.clear();
+
+	m_gR.insert(0, r_v);
+	m_gPlanes.insert(0, planes_v);
+	m_gTraceIdx.insert(0, traceIdx_v);
+
+	loadDataTexture(m_traceColors_texture, traceColors_v);
+	loadDataTexture(m_traceValues_texture, traceValues_v);
+	loadDataTexture(m_eventValues_texture, eventValues_v);
+}
+
+void TracePlayerModel::updateRenderingPipeline()
+{
+	//the traces and the LUT are uploaded only when they changed :
+	//the filters, the plane, the rendering modes and the LUT range only change draw ranges and uniforms
+	if(m_isTraces_modified)
+	{
+		_uploadTraces();
+		m_isTraces_modified = false;
 	}
 
-	//***Trajectories Mode***
-	switch(m_trajectories_renderingMode)
+	if(m_isLut_modified)
 	{
-		case NONE_TRAJECTORIES_RENDERING_MODE :
-		{
-		}
-		break;
+		vector<vec4> lut_colors = m_lut.getColors();
+		m_lut_texture.loadTexture(lut_colors.size(), 1, GL_RGBA32F, GL_RGBA, GL_FLOAT, lut_colors.data());
+		m_isLut_modified = false;
+	}
 
-		case CURRENT_TRAJECTORIES_RENDERING_MODE :
-		{
-			getTracesCoordsInPlane(m_current_plane, m_filteredTraces, r_trajectories_v, color_trajectories_v);
-		}
-		break;
+	//***Trajectories and Events Modes***
+	m_trajectoriesFirsts_v.clear();
+	m_trajectoriesCounts_v.clear();
+	m_eventsFirsts_v.clear();
+	m_eventsCounts_v.clear();
 
-		case ALL_TRAJECTORIES_RENDERING_MODE :
-		{
-			getTracesCoords(m_filteredTraces, r_trajectories_v, color_trajectories_v);
-		}
-		break;
-	}
+	int min_length = std::numeric_limits<int>::max();
+	int max_length = 0;
+	float min_D = std::numeric_limits<float>::max();
+	float max_D = std::numeric_limits<float>::min();
 
-	//***Events Mode***
-	switch(m_events_renderingMode)
+	for(int trc_idx : m_filteredIdx_v)
 	{
-		case NONE_EVENTS_RENDERING_MODE :
-		{
-		}
-		break;
+		min_length = std::min(min_length, int(m_traceLengths_v[trc_idx]));
+		max_length = std::max(max_length, int(m_traceLengths_v[trc_idx]));
+		min_D = std::min(min_D, m_traces[trc_idx].getD());
+		max_D = std::max(max_D, m_traces[trc_idx].getD());
 
-		case CURRENT_EVENTS_RENDERING_MODE :
+		bool isInsideRange = (m_current_plane >= m_tracePlaneRanges_v[trc_idx].x && m_current_plane <= m_tracePlaneRanges_v[trc_idx].y);
+		bool isLongEnough = (m_traceLengths_v[trc_idx] >= 2);
+
+		bool isTrajectoryDrawn = (m_trajectories_renderingMode == CURRENT_TRAJECTORIES_RENDERING_MODE && isInsideRange && isLongEnough) ||
+								 (m_trajectories_renderingMode == ALL_TRAJECTORIES_RENDERING_MODE && isLongEnough);
+		if(isTrajectoryDrawn)
 		{
-			getEventCoordsInPlane(m_current_plane, m_filteredTraces, r_events_v, color_events_v);
+			m_trajectoriesFirsts_v.push_back(m_traceFirsts_v[trc_idx]);
+			m_trajectoriesCounts_v.push_back(m_traceLengths_v[trc_idx]);
 		}
-		break;
 
-		case ALL_EVENTS_RENDERING_MODE :
+		//current plane : the whole trace is drawn, the other events are culled in the geometry shader
+		bool isEventsDrawn = (m_events_renderingMode == CURRENT_EVENTS_RENDERING_MODE && isInsideRange) ||
+							 (m_events_renderingMode == ALL_EVENTS_RENDERING_MODE && isLongEnough);
+		if(isEventsDrawn)
 		{
-			getEventsCoords(m_filteredTraces, r_events_v, color_events_v);
+			m_eventsFirsts_v.push_back(m_traceFirsts_v[trc_idx]);
+			m_eventsCounts_v.push_back(m_traceLengths_v[trc_idx]);
 		}
-		break;
 	}
 
-	m_gR_traces.clear();
-	m_gColor_traces.clear();
-	m_gR.clear();
-	m_gColor.clear();
+	m_eventsPlane = (m_events_renderingMode == CURRENT_EVENTS_RENDERING_MODE) ? m_current_plane : -1;
 
-	m_gR_traces.insert(0, r_trajectories_v);
-	m_gColor_traces.insert(0, color_trajectories_v);
-	m_gR.insert(0, r_events_v);
-	m_gColor.insert(0, color_events_v);
+	//***Color Mode***
+	if(m_filteredIdx_v.size() == 0) m_lengthRange = vec2(0,0);
+	else m_lengthRange = vec2(min_length, max_length);
 
+	m_lutRange = vec2(m_lut_minValue, m_lut_maxValue);
+	if(m_lut_minValue == -1 && m_lut_maxValue == -1 && m_filteredIdx_v.size() != 0) m_lutRange = vec2(log10(min_D), log10(max_D));
+}
+
+void TracePlayerModel::_connectColorUniforms(gstd::gProgram& program)
+{
+	int color_mode = m_colorMode;
+
+	gstd::connectUniform(program, "color_mode", &color_mode, 1);
+	gstd::connectUniform(program, "lut_range", &m_lutRange, 1);
+	gstd::connectUniform(program, "length_range", &m_lengthRange, 1);
+	gstd::connectTexture(program, "lut_texture", m_lut_texture, 1);
+	gstd::connectTexture(program, "traceColors_texture", m_traceColors_texture, 2);
+	gstd::connectTexture(program, "traceValues_texture", m_traceValues_texture, 3);
+	gstd::connectTexture(program, "eventValues_texture", m_eventValues_texture, 4);
+}
+
+void TracePlayerModel::_renderTrajectories(mat4& world_to_screen)
+{
+	if(m_trajectoriesFirsts_v.size() == 0) return; //->
+
+	m_pgm_trajectories.useProgram(true);
+		gstd::myConnector<vec2>::connect(m_pgm_trajectories, "R", m_gR);
+		gstd::myConnector<int>::connect(m_pgm_trajectories, "trace_idx", m_gTraceIdx);
+		gstd::connectUniform(m_pgm_trajectories, "scaling_matrix",  &world_to_screen,1);
+		gstd::connectUniform(m_pgm_trajectories, "line_intensity", &m_lineIntensity, 1);
+		_connectColorUniforms(m_pgm_trajectories);
+	glMultiDrawArrays(GL_LINE_STRIP, m_trajectoriesFirsts_v.data(), m_trajectoriesCounts_v.data(), m_trajectoriesFirsts_v.size());
+}
+
+void TracePlayerModel::_renderEvents(mat4& world_to_screen)
+{
+	if(m_eventsFirsts_v.size() == 0) return; //->
+
+	m_pgm_events.useProgram(true);
+		gstd::myConnector<vec2>::connect(m_pgm_events, "R", m_gR);
+		gstd::myConnector<int>::connect(m_pgm_events, "plane", m_gPlanes);
+		gstd::myConnector<int>::connect(m_pgm_events, "trace_idx", m_gTraceIdx);
+		gstd::connectUniform(m_pgm_events, "current_plane", &m_eventsPlane, 1);
+		gstd::connectUniform(m_pgm_events, "square_size", &m_square_size,1);
+		gstd::connectUniform(m_pgm_events, "scaling_matrix", &world_to_screen,1);
+		gstd::connectUniform(m_pgm_events, "spot_intensity", &m_spotIntensity,1);
+		gstd::connectTexture(m_pgm_events, "texture_id", m_gaussian_texture, 0);
+		_connectColorUniforms(m_pgm_events);
+	glMultiDrawArrays(GL_POINTS, m_eventsFirsts_v.data(), m_eventsCounts_v.data(), m_eventsFirsts_v.size());
 }
 
 void TracePlayerModel::render(myGLWidget* window)
@@ -529,28 +645,13 @@ void TracePlayerModel::render(myGLWidget* window)
 
 	mat4 m = window->getWorldToExtendedHomMatrix();
 
-	if(m_lineWidth != 0)
-	{
-        m_pgm_trajectories.useProgram(true);
-            gstd::myConnector<vec2>::connect(m_pgm_lineColor, "R", m_gR_traces);
-            gstd::myConnector<vec4>::connect(m_pgm_lineColor, "color_in", m_gColor_traces);
-            gstd::connectUniform(m_pgm_lineColor, "scaling_matrix",  &m,1);
-            gstd::connectUniform(m_pgm_lineColor, "line_intensity", &m_lineIntensity, 1);
-        glDrawArrays(GL_LINES, 0, m_gR_traces.size());
-	}
+	if(m_lineWidth != 0) _renderTrajectories(m);
 
     ////	//***Events Rendering***
     glEnable(GL_BLEND);
 	glBlendFunc(GL_ONE, GL_ONE);
 
-	m_pgm_events.useProgram(true);
-		gstd::myConnector<vec2>::connect(m_pgm_gaussianColor, "R", m_gR);
-		gstd::myConnector<vec4>::connect(m_pgm_gaussianColor, "color_in", m_gColor);
-		gstd::connectUniform(m_pgm_gaussianColor, "square_size", &m_square_size,1);
-		gstd::connectUniform(m_pgm_gaussianColor, "scaling_matrix", &m,1);
-		gstd::connectUniform(m_pgm_gaussianColor, "spot_intensity", &m_spotIntensity,1);
-		gstd::connectTexture(m_pgm_gaussianColor, "texture_id", m_gaussian_texture, 0);
-	glDrawArrays(GL_POINTS, 0, m_gR.size());
+	_renderEvents(m);
 
 	glBlendFunc(GL_ONE, GL_ZERO);
 
@@ -578,22 +679,10 @@ void TracePlayerModel::captureScreen(myGLWidget* window, string& file_path)
 
 	mat4 m = window->getWorldToExtendedHomMatrix();
 
-			m_pgm_trajectories.useProgram(true);
-				gstd::myConnector<vec2>::connect(m_pgm_lineColor, "R", m_gR_traces);
-				gstd::myConnector<vec4>::connect(m_pgm_lineColor, "color_in", m_gColor_traces);
-				gstd::connectUniform(m_pgm_lineColor, "scaling_matrix",  &m,1);
-				gstd::connectUniform(m_pgm_lineColor, "line_intensity", &m_lineIntensity, 1);
-			glDrawArrays(GL_LINES, 0, m_gR_traces.size());
+	_renderTrajectories(m);
 
     //***Events Rendering***
-	m_pgm_events.useProgram(true);
-		gstd::myConnector<vec2>::connect(m_pgm_gaussianColor, "R", m_gR);
-		gstd::myConnector<vec4>::connect(m_pgm_gaussianColor, "color_in", m_gColor);
-		gstd::connectUniform(m_pgm_gaussianColor, "square_size", &m_square_size,1);
-		gstd::connectUniform(m_pgm_gaussianColor, "scaling_matrix", &m,1);
-		gstd::connectUniform(m_pgm_gaussianColor, "spot_intensity", &m_spotIntensity,1);
-		gstd::connectTexture(m_pgm_gaussianColor, "texture_id", m_gaussian_texture, 0);
-	glDrawArrays(GL_POINTS, 0, m_gR.size());
+	_renderEvents(m);
 
 	glBlendFunc(GL_ONE, GL_ZERO);
 
@@ -642,23 +731,11 @@ void TracePlayerModel::captureScreen2(myGLWidget* window)
 
 		mat4 m = window->getWorldToExtendedHomMatrix();
 
-				m_pgm_trajectories.useProgram(true);
-					gstd::myConnector<vec2>::connect(m_pgm_lineColor, "R", m_gR_traces);
-					gstd::myConnector<vec4>::connect(m_pgm_lineColor, "color_in", m_gColor_traces);
-					gstd::connectUniform(m_pgm_lineColor, "scaling_matrix",  &m,1);
-					gstd::connectUniform(m_pgm_lineColor, "line_intensity", &m_lineIntensity, 1);
-				glDrawArrays(GL_LINES, 0, m_gR_traces.size());
+		_renderTrajectories(m);
 
         //***Events Rendering***
 
-		m_pgm_events.useProgram(true);
-			gstd::myConnector<vec2>::connect(m_pgm_gaussianColor, "R", m_gR);
-			gstd::myConnector<vec4>::connect(m_pgm_gaussianColor, "color_in", m_gColor);
-			gstd::connectUniform(m_pgm_gaussianColor, "square_size", &m_square_size,1);
-			gstd::connectUniform(m_pgm_gaussianColor, "scaling_matrix", &m,1);
-			gstd::connectUniform(m_pgm_gaussianColor, "spot_intensity", &m_spotIntensity,1);
-			gstd::connectTexture(m_pgm_gaussianColor, "texture_id", m_gaussian_texture, 0);
-		glDrawArrays(GL_POINTS, 0, m_gR.size());
+		_renderEvents(m);
 
 		glBlendFunc(GL_ONE, GL_ZERO);
 
@@ -698,24 +775,25 @@ void TracePlayerModel::captureScreen2(myGLWidget* window)
 
 void TracePlayerModel::filter()
 {
-	m_filteredTraces.clear();
-	if(m_traces.size() == 0) return; //->
+	m_filteredIdx_v.clear();
+
+	//the traces are tested in parallel, the view keeps the order of m_traces
+	int nb_traces = m_traces.size();
+	vector<unsigned char> isAccepted_v(nb_traces, 0);
 
-	auto trace = m_traces.begin();
-	while(trace != m_traces.end())
+	forEachTrace(nb_traces, [&](int trc_idx)
 	{
-		if(trace->getLength() <= m_max_length && trace->getLength() >= m_min_length)
-		{
-			float logD = log10(trace->getD());
-
-			if(trace->isDCalculated() &&
-			   logD >= TracePlayerModel::m_minLogD &&
-			   logD <= TracePlayerModel::m_maxLogD)
-			{
-				m_filteredTraces.push_back(*trace);
-			}
-		}
-		trace++;
+		Trace& trace = m_traces[trc_idx];
+		if(trace.getLength() > m_max_length || trace.getLength() < m_min_length) return; //->
+		if(trace.isDCalculated() == false) return; //->
+
+		float logD = log10(trace.getD());
+		isAccepted_v[trc_idx] = (logD >= TracePlayerModel::m_minLogD && logD <= TracePlayerModel::m_maxLogD);
+	});
+
+	for(int trc_idx = 0; trc_idx <= nb_traces-1; trc_idx++)
+	{
+		if(isAccepted_v[trc_idx]) m_filteredIdx_v.push_back(trc_idx);
 	}
 
 	nbTracesChanged(m_traces.size()); //to keep empty plane...
@@ -727,12 +805,66 @@ void TracePlayerModel::filter()
 }
 
 
-
 void TracePlayerModel::computeMSDsAndDs(float pixel_size, float dt)
 {
 	computeMSDs(m_traces, m_MSD_maxDPplane);
 	computeDs(m_traces, pixel_size, dt, 1, m_D_nbPointsMSDFit);
 	computeDInst(m_traces, pixel_size, dt, m_DInst_nbPointsBeforeMSDFit, m_DInst_nbPointsAfterMSDFit);
+
+	m_isTraces_modified = true;
+}
+
+myTraceAnalysisParams TracePlayerModel::getAnalysisParams() const
+{
+	myTraceAnalysisParams params;
+		params.pixel_size = m_pixel_size;
+		params.timestep = m_timestep;
+		params.MSD_maxDPlane = m_MSD_maxDPplane;
+		params.D_nbPointsMSDFit = m_D_nbPointsMSDFit;
+		params.DInst_nbPointsBeforeMSDFit = m_DInst_nbPointsBeforeMSDFit;
+		params.DInst_nbPointsAfterMSDFit = m_DInst_nbPointsAfterMSDFit;
+		params.min_length = m_min_length;
+		params.max_length = m_max_length;
+		params.minLogD = m_minLogD;
+		params.maxLogD = m_maxLogD;
+		params.DsHistogram_nbIntervals = m_DsHistogram_nbIntervals;
+		params.DsHistogram_minValue = m_DsHistogram_minValue;
+		params.DsHistogram_maxValue = m_DsHistogram_maxValue;
+		params.lengthsHistogram_nbIntervals = m_lengthsHistogram_nbIntervals;
+		params.lengthsHistogram_minValue = m_lengthsHistogram_minValue;
+		params.lengthsHistogram_maxValue = m_lengthsHistogram_maxValue;
+
+	return params;
+}
+
+void TracePlayerModel::exportDsHistogramsInBatch()
+{
+	if(m_tracePaths_v.empty()) return; //->
+
+	QPoint center_pos = this->mapToGlobal(m_mainWindow->centralWidget()->pos() + QPoint(m_mainWindow->centralWidget()->size().width()/2.0f, m_mainWindow->centralWidget()->size().height()/2.0f)
+						- QPoint(m_progressWdgt->size().width()/2.0f, m_progressWdgt->size().height()/2.0f));
+	m_progressWdgt->setText("Analysing Trajectories...");
+	m_progressWdgt->move(center_pos);
+	m_progressWdgt->show();
+	m_main_app->processEvents();
+
+	//the files are analysed in parallel, the traces displayed are left untouched
+	TraceBatchAnalyser analyser;
+	analyser.setParams(getAnalysisParams());
+	for(const string& path : m_tracePaths_v) analyser.addPath(path);
+	bool areAllFilesSucceeded = analyser.run();
+
+	m_progressWdgt->hide();
+
+	if(areAllFilesSucceeded == false)
+	{
+		string failedFiles_str;
+		for(const myTraceFileReport& report : analyser.getReports())
+		{
+			if(report.isSucceeded == false) failedFiles_str += report.path + "\n";
+		}
+		QMessageBox::warning(this, "Batch analysis", ("These files could not be analysed :\n" + failedFiles_str).data());
+	}
 }
 
 /*virtual*/ void TracePlayerModel::nbTracesChanged(int new_nb_traces){}
@@ -759,7 +891,7 @@ void TracePlayerModel::updateCurrentPlaneWord()
 void TracePlayerModel::updateNbTracesWord()
 {
 	string nbTraces_str = "NB_TRACES :";
-	nbTraces_str += floatToString(m_filteredTraces.size());
+	nbTraces_str += floatToString(m_filteredIdx_v.size());
 	m_numberTraces_word.setText(nbTraces_str);
 	m_numberTraces_word.setDirection(vec2(1,0));
 	m_numberTraces_word.setColor(vec4(0,1,0,1));
@@ -769,8 +901,11 @@ void TracePlayerModel::updateNbTracesWord()
 
 void TracePlayerModel::updateNbEventsWord()
 {
+	long nb_events = 0;
+	for(int trc_idx : m_filteredIdx_v) nb_events += m_traces[trc_idx].getLength();
+
 	string nbEvents_str = "NB_EVENTS :";
-	nbEvents_str += floatToString(getNbEvents(m_filteredTraces));
+	nbEvents_str += floatToString(nb_events);
 	m_numberEvents_word.setText(nbEvents_str);
 	m_numberEvents_word.setDirection(vec2(1,0));
 	m_numberEvents_word.setColor(vec4(0.3,0.3,1,1));
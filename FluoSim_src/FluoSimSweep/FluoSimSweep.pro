@@ -0,0 +1,69 @@
+
+include($$PWD/../../FluoSim_withLibraries.pri)
+
+QT += \
+    core
+
+CONFIG += \
+    CONSOLE \
+    C++11
+
+TEMPLATE = app
+TARGET = FluoSimSweep
+equals(isUsingStaticLib, true) {
+    DEFINES += GPUTOOLS_LIBRARYSTATIC #needed to link to the static library
+    DEFINES += TOOLBOX_LIBRARYSTATIC #needed to link to the static library
+    message("Using Staticlib.")
+}
+else {
+    message("Using dll.")
+}
+
+GPUTOOLS_LIBRARY_PATH = $$PWD/../gpuTools
+TOOLBOX_LIBRARY_PATH = $$PWD/../toolBox
+FLUOSIM_DEPENDENCIES_PATH = $$PWD/../../FluoSim_dependencies
+DESTDIR = $$PWD/FluoSimSweep_build/release
+OBJECTS_DIR = $$PWD/FluoSimSweep_build/release
+MOC_DIR = $$PWD/FluoSimSweep_build/release
+INSTALL_DIR = $$PWD/../../FluoSim_build/release #where to put the executable after compilation, next to FluoSim
+
+INCLUDEPATH += \
+\
+    FluoSimSweep_src \
+    $$TOOLBOX_LIBRARY_PATH/ \
+        $$TOOLBOX_LIBRARY_PATH/toolBox_src \
+    $$GPUTOOLS_LIBRARY_PATH/ \
+        $$GPUTOOLS_LIBRARY_PATH/gpuTools_src \
+    $$FLUOSIM_DEPENDENCIES_PATH/openGL/include \
+    $$FLUOSIM_DEPENDENCIES_PATH/glm \
+    $$FLUOSIM_DEPENDENCIES_PATH/glew/include
+
+LIBS += \
+\
+    -L$$FLUOSIM_DEPENDENCIES_PATH/glew/bin \
+    -L$$FLUOSIM_DEPENDENCIES_PATH/openGL \
+    -L$$GPUTOOLS_LIBRARY_PATH/gpuTools_build/release \
+    -L$$TOOLBOX_LIBRARY_PATH/toolBox_build/release \
+\
+        -lglew32 \
+        -lopengl32 \
+        -lgpuTools_library \
+        -ltoolBox_library
+
+SOURCES += \
+\
+    FluoSimSweep_src/main.cpp \
+    FluoSimSweep_src/SweepRunner.cpp
+
+HEADERS += \
+\
+    FluoSimSweep_src/SweepRunner.h
+
+win32 {
+    DESTDIR ~= s,/,\\,g
+    INSTALL_DIR ~= s,/,\\,g
+    message($$DESTDIR)
+    message($$INSTALL_DIR)
+}
+
+QMAKE_POST_LINK += xcopy $$quote($$DESTDIR\\$${TARGET}.exe) $$quote($$INSTALL_DIR\\$${TARGET}.exe*) /Y
@@ -0,0 +1,394 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#include "SweepRunner.h"
+
+#include "cstdio"
+#include "fstream"
+#include "iostream"
+#include "mutex"
+#include "sstream"
+
+#include "QCoreApplication"
+#include "QDir"
+#include "QFileInfo"
+#include "QProcess"
+
+#include "toolBox_src/developmentTools/myClock.h"
+#include "toolBox_src/fileAndstring_manipulation/file_manipulation.h"
+#include "toolBox_src/parallelTools/myWorkStealingPool.h"
+
+
+using namespace std;
+
+
+//the jobs run in experiment mode and quit once their experiment is over
+static const vector<pair<string, string> > jobStates_v =
+{
+	{"simulationState.simulator_mode", "EXPERIMENT_MODE"},
+	{"simulationState.simulationStarted", "TRUE"},
+	{"simulationState.simulationPaused", "FALSE"},
+	{"simulationState.simulationEnded", "FALSE"},
+	{"simulationState.isSingleShot", "TRUE"}
+};
+
+static bool getPropertyName(const string& line, string& property_name, size_t& ket_pos)
+{
+	size_t bra_pos = line.find_first_not_of(" \t");
+	if(bra_pos == string::npos || line[bra_pos] != '[') return false; //->
+
+	ket_pos = line.find(']', bra_pos);
+	if(ket_pos == string::npos) return false; //->
+
+	property_name = line.substr(bra_pos+1, ket_pos-bra_pos-1);
+	return true;
+}
+
+
+SweepRunner::SweepRunner()
+{
+	m_executable_path = (QCoreApplication::applicationDirPath() + "/FluoSim").toStdString();
+#ifdef _WIN32
+	m_executable_path += ".exe";
+#endif
+	m_mode = GRID_SWEEP_MODE;
+	m_nbWorkers = 0;
+	m_baseSeed = 1;
+}
+
+bool SweepRunner::loadSweepFile(string sweep_filePath)
+{
+	ifstream file(sweep_filePath.data());
+	if(!file.is_open())
+	{
+		cout<<"In SweepRunner::loadSweepFile : error (cannot open "<<sweep_filePath<<")\n";
+		return false; //->
+	}
+
+	//relative paths are relative to the sweep file
+	QDir sweep_dir = QFileInfo(sweep_filePath.data()).absoluteDir();
+
+	string line;
+	while(getline(file, line))
+	{
+		string property_name;
+		size_t ket_pos;
+		if(getPropertyName(line, property_name, ket_pos) == false) continue; //<-
+
+		istringstream values_stream(line.substr(ket_pos+1));
+		vector<string> values_v;
+		string value;
+		while(values_stream >> value) values_v.push_back(value);
+		if(values_v.empty() == true) continue; //<-
+
+		if(property_name == "sweep.baseProject") setBaseProject(QFileInfo(sweep_dir, values_v[0].data()).absoluteFilePath().toStdString());
+		else if(property_name == "sweep.destination") setDestination(QFileInfo(sweep_dir, values_v[0].data()).absoluteFilePath().toStdString());
+		else if(property_name == "sweep.executable") setExecutable(QFileInfo(sweep_dir, values_v[0].data()).absoluteFilePath().toStdString());
+		else if(property_name == "sweep.mode")
+		{
+			if(values_v[0] == "GRID") setMode(GRID_SWEEP_MODE);
+			else if(values_v[0] == "LIST") setMode(LIST_SWEEP_MODE);
+			else cout<<"In SweepRunner::loadSweepFile : error (unknown mode "<<values_v[0]<<")\n";
+		}
+		else if(property_name == "sweep.nbWorkers" || property_name == "sweep.seed")
+		{
+			try
+			{
+				if(property_name == "sweep.nbWorkers") setNbWorkers(stoi(values_v[0]));
+				else setBaseSeed(stoul(values_v[0]));
+			}
+			catch(const exception&)
+			{
+				cout<<"In SweepRunner::loadSweepFile : error (invalid value in \""<<line<<"\")\n";
+				return false; //->
+			}
+		}
+		else addProperty(property_name, values_v);
+	}
+
+	return true;
+}
+
+void SweepRunner::setBaseProject(string project_filePath)
+{
+	m_baseProject_filePath = project_filePath;
+}
+
+void SweepRunner::setDestination(string destination_path)
+{
+	m_destination_path = destination_path;
+}
+
+void SweepRunner::setExecutable(string executable_path)
+{
+	m_executable_path = executable_path;
+}
+
+void SweepRunner::setMode(SWEEP_MODE mode)
+{
+	m_mode = mode;
+}
+
+void SweepRunner::setNbWorkers(int nb_workers)
+{
+	m_nbWorkers = nb_workers;
+}
+
+void SweepRunner::setBaseSeed(unsigned int seed)
+{
+	m_baseSeed = seed;
+}
+
+void SweepRunner::addProperty(string property_name, vector<string> values_v)
+{
+	m_propertyNames_v.push_back(property_name);
+	m_propertyValues_v.push_back(values_v);
+}
+
+const vector<sweepJob>& SweepRunner::getJobs() const
+{
+	return m_jobs_v;
+}
+
+bool SweepRunner::expandJobs()
+{
+	m_jobs_v.clear();
+
+	if(getFileContent(m_baseProject_filePath, m_baseProject_content) == false)
+	{
+		cout<<"In SweepRunner::expandJobs : error (cannot open the base project "<<m_baseProject_filePath<<")\n";
+		return false; //->
+	}
+
+	int nb_properties = m_propertyNames_v.size();
+	int nb_jobs = 1;
+
+	if(m_mode == GRID_SWEEP_MODE)
+	{
+		for(auto& values_v : m_propertyValues_v) nb_jobs *= values_v.size();
+	}
+	else
+	{
+		if(nb_properties != 0) nb_jobs = m_propertyValues_v[0].size();
+		for(auto& values_v : m_propertyValues_v)
+		{
+			if(int(values_v.size()) == nb_jobs) continue; //<-
+
+			cout<<"In SweepRunner::expandJobs : error (the properties of a LIST sweep need the same number of values)\n";
+			return false; //->
+		}
+	}
+
+	for(int job_idx = 0; job_idx <= nb_jobs-1; job_idx++)
+	{
+		sweepJob job;
+		job.job_idx = job_idx;
+		job.seed = m_baseSeed + job_idx;
+		job.exit_code = -1;
+		job.duration = 0.0;
+
+		//grid : the last property varies the fastest
+		int remaining_idx = job_idx;
+		for(int property_idx = nb_properties-1; property_idx >= 0; property_idx--)
+		{
+			const vector<string>& values_v = m_propertyValues_v[property_idx];
+			int value_idx = job_idx;
+			if(m_mode == GRID_SWEEP_MODE)
+			{
+				value_idx = remaining_idx%values_v.size();
+				remaining_idx /= values_v.size();
+			}
+			job.overrides_v.insert(job.overrides_v.begin(), {m_propertyNames_v[property_idx], values_v[value_idx]});
+		}
+
+		char job_name[32];
+		snprintf(job_name, sizeof(job_name), "job_%04d", job_idx);
+		job.directory = m_destination_path + "/" + job_name;
+		job.project_filePath = job.directory + "/project.txt";
+
+		m_jobs_v.push_back(job);
+	}
+
+	return true;
+}
+
+bool SweepRunner::run()
+{
+	if(m_jobs_v.empty() == true && expandJobs() == false) return false; //->
+
+	if(QDir().mkpath(m_destination_path.data()) == false)
+	{
+		cout<<"In SweepRunner::run : error (cannot create "<<m_destination_path<<")\n";
+		return false; //->
+	}
+
+	//the jobs are prepared upfront so that a failing preparation does not leave half a sweep running
+	for(sweepJob& job : m_jobs_v)
+	{
+		if(_prepareJob(job) == false) return false; //->
+	}
+
+	myWorkStealingPool pool(m_nbWorkers);
+	cout<<m_jobs_v.size()<<" jobs on "<<pool.getNbWorkers()<<" workers\n";
+
+	pool.run(m_jobs_v.size(), [this](int job_idx, int)
+	{
+		_runJob(m_jobs_v[job_idx]);
+	});
+
+	return _saveSweepManifest();
+}
+
+bool SweepRunner::_prepareJob(sweepJob& job)
+{
+	if(QDir().mkpath(job.directory.data()) == false)
+	{
+		cout<<"In SweepRunner::_prepareJob : error (cannot create "<<job.directory<<")\n";
+		return false; //->
+	}
+
+	vector<pair<string, string> > overrides_v = job.overrides_v;
+	overrides_v.insert(overrides_v.end(), jobStates_v.begin(), jobStates_v.end());
+	vector<bool> isOverrideWritten_v(overrides_v.size(), false);
+
+	//base project lines, the overridden ones being replaced
+	ofstream project_file(job.project_filePath.data());
+	if(!project_file.is_open())
+	{
+		cout<<"In SweepRunner::_prepareJob : error (cannot create "<<job.project_filePath<<")\n";
+		return false; //->
+	}
+
+	istringstream base_stream(m_baseProject_content);
+	string line;
+	while(getline(base_stream, line))
+	{
+		string property_name;
+		size_t ket_pos;
+		bool isOverridden = false;
+
+		if(getPropertyName(line, property_name, ket_pos) == true)
+		{
+			for(uint override_idx = 0; override_idx < overrides_v.size(); override_idx++)
+			{
+				if(overrides_v[override_idx].first != property_name) continue; //<-
+
+				project_file<<"["<<property_name<<"] "<<overrides_v[override_idx].second<<"\n";
+				isOverrideWritten_v[override_idx] = true;
+				isOverridden = true;
+				break; //->
+			}
+		}
+
+		if(isOverridden == false) project_file<<line<<"\n";
+	}
+
+	for(uint override_idx = 0; override_idx < overrides_v.size(); override_idx++)
+	{
+		if(isOverrideWritten_v[override_idx] == true) continue; //<-
+		project_file<<"["<<overrides_v[override_idx].first<<"] "<<overrides_v[override_idx].second<<"\n";
+	}
+
+	return _saveJobManifest(job);
+}
+
+void SweepRunner::_runJob(sweepJob& job)
+{
+	myChrono clock;
+	clock.startTour();
+
+	//one process per job : each has its own biological world, probes and seeded random streams
+	QProcess process;
+	QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+	environment.insert("FLUOSIM_SEED", QString::number(job.seed));
+	process.setProcessEnvironment(environment);
+	process.setWorkingDirectory(QFileInfo(m_executable_path.data()).absolutePath()); //resources are loaded relatively
+	process.setStandardOutputFile((job.directory + "/output.txt").data());
+	process.setStandardErrorFile((job.directory + "/output.txt").data(), QIODevice::Append);
+
+	process.start(m_executable_path.data(), QStringList() << job.project_filePath.data() << job.directory.data());
+	if(process.waitForStarted(-1) == false)
+	{
+		lock_guard<mutex> lock(m_cout_mutex);
+		cout<<"In SweepRunner::_runJob : error (cannot start "<<m_executable_path<<")\n";
+	}
+	else
+	{
+		process.waitForFinished(-1);
+		if(process.exitStatus() == QProcess::NormalExit) job.exit_code = process.exitCode();
+	}
+
+	job.duration = clock.endTour();
+	_saveJobManifest(job);
+
+	lock_guard<mutex> lock(m_cout_mutex); //the jobs end on several workers
+	cout<<"job "<<job.job_idx<<" done (exit code "<<job.exit_code<<", "<<job.duration<<" s)\n";
+}
+
+bool SweepRunner::_saveJobManifest(const sweepJob& job)
+{
+	ofstream file((job.directory + "/job_manifest.txt").data());
+	if(!file.is_open())
+	{
+		cout<<"In SweepRunner::_saveJobManifest : error (cannot write in "<<job.directory<<")\n";
+		return false; //->
+	}
+
+	file<<"[job.index] "<<job.job_idx<<"\n";
+	file<<"[job.seed] "<<job.seed<<"\n";
+	file<<"[job.baseProject] "<<m_baseProject_filePath<<"\n";
+	file<<"[job.project] "<<job.project_filePath<<"\n";
+	for(auto& job_override : job.overrides_v)
+	{
+		file<<"["<<job_override.first<<"] "<<job_override.second<<"\n";
+	}
+	file<<"[job.exitCode] "<<job.exit_code<<"\n";
+	file<<"[job.duration_s] "<<job.duration<<"\n";
+
+	return true;
+}
+
+bool SweepRunner::_saveSweepManifest()
+{
+	string manifest_path = m_destination_path + "/sweep_manifest.txt";
+	ofstream file(manifest_path.data());
+	if(!file.is_open())
+	{
+		cout<<"In SweepRunner::_saveSweepManifest : error (cannot open "<<manifest_path<<")\n";
+		return false; //->
+	}
+
+	//tab separated values, one line per job
+	file<<"job_idx\tdirectory\tseed\texit_code\tduration_s";
+	for(string& property_name : m_propertyNames_v) file<<"\t"<<property_name;
+	file<<"\n";
+
+	bool areAllJobsSucceeded = true;
+	for(sweepJob& job : m_jobs_v)
+	{
+		file<<job.job_idx<<"\t"<<job.directory<<"\t"<<job.seed<<"\t"<<job.exit_code<<"\t"<<job.duration;
+		for(auto& job_override : job.overrides_v) file<<"\t"<<job_override.second;
+		file<<"\n";
+
+		if(job.exit_code != 0) areAllJobsSucceeded = false;
+	}
+
+	return areAllJobsSucceeded;
+}
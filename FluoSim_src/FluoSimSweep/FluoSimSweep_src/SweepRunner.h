@@ -0,0 +1,102 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#ifndef SWEEPRUNNER_H
+#define SWEEPRUNNER_H
+
+#include "mutex"
+#include "string"
+#include "utility"
+#include "vector"
+
+
+//one FluoSim run : the base project with some properties overridden
+struct sweepJob
+{
+	int job_idx;
+	unsigned int seed;
+	std::vector<std::pair<std::string, std::string> > overrides_v; //(project property, value)
+	std::string directory;
+	std::string project_filePath;
+	int exit_code; //-1 : not run or crashed
+	double duration; //s
+};
+
+
+//sweep file (same syntax as the project files) :
+//	[sweep.baseProject] path of the project the jobs are derived from
+//	[sweep.destination] directory receiving one sub-directory per job and the sweep manifest
+//	[sweep.executable] FluoSim executable (optional, default : FluoSim next to the sweep executable)
+//	[sweep.mode] GRID (every combination of the values) or LIST (i-th value of every property)
+//	[sweep.nbWorkers] number of simultaneous jobs (optional, default : one per hardware thread)
+//	[sweep.seed] seed of the first job, job i uses seed+i (optional, default : 1)
+//	[dynamicParams.k_on] 0.1 0.5 1.0	any single-word project property followed by its values
+//	...
+
+class SweepRunner
+{
+public :
+
+	enum SWEEP_MODE {GRID_SWEEP_MODE, LIST_SWEEP_MODE};
+
+	SweepRunner();
+
+	bool loadSweepFile(std::string sweep_filePath);
+
+	void setBaseProject(std::string project_filePath);
+	void setDestination(std::string destination_path);
+	void setExecutable(std::string executable_path);
+	void setMode(SWEEP_MODE mode);
+	void setNbWorkers(int nb_workers);
+	void setBaseSeed(unsigned int seed);
+	void addProperty(std::string property_name, std::vector<std::string> values_v);
+
+	bool expandJobs();
+	bool run();
+
+	const std::vector<sweepJob>& getJobs() const;
+
+private :
+
+	bool _prepareJob(sweepJob& job);
+	void _runJob(sweepJob& job);
+	bool _saveJobManifest(const sweepJob& job);
+	bool _saveSweepManifest();
+
+private :
+
+	std::string m_baseProject_filePath;
+	std::string m_destination_path;
+	std::string m_executable_path;
+	SWEEP_MODE m_mode;
+	int m_nbWorkers;
+	unsigned int m_baseSeed;
+
+	std::vector<std::string> m_propertyNames_v;
+	std::vector<std::vector<std::string> > m_propertyValues_v;
+
+	std::string m_baseProject_content;
+	std::vector<sweepJob> m_jobs_v;
+
+	std::mutex m_cout_mutex; //serialises the console output of the workers
+};
+
+
+#endif // SWEEPRUNNER_H
@@ -0,0 +1,52 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#include "iostream"
+#include "string"
+
+#include "QCoreApplication"
+
+#include "SweepRunner.h"
+
+
+using namespace std;
+
+
+//usage : FluoSimSweep sweep_file
+//each job is a FluoSim run of the base project with its own overrides, products and manifest (see SweepRunner.h)
+int main(int argc, char* argv[])
+{
+	QCoreApplication main_app(argc, argv);
+
+	if(argc < 2)
+	{
+		cout<<"usage : FluoSimSweep sweep_file\n";
+		return 1;
+	}
+
+	SweepRunner sweep_runner;
+	if(sweep_runner.loadSweepFile(argv[1]) == false) return 1;
+	if(sweep_runner.expandJobs() == false) return 1;
+
+	bool areAllJobsSucceeded = sweep_runner.run();
+	if(areAllJobsSucceeded == false) cout<<"some jobs failed, see the sweep manifest\n";
+
+	return areAllJobsSucceeded ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+
+include($$PWD/../../FluoSim_withLibraries.pri)
+
+QT += \
+    core \
+    gui \
+    widgets
+
+CONFIG += \
+    CONSOLE \
+    C++11
+
+TEMPLATE = app
+TARGET = TracePlayerBatch
+equals(isUsingStaticLib, true) {
+    DEFINES += GPUTOOLS_LIBRARYSTATIC #needed to link to the static library
+    DEFINES += TOOLBOX_LIBRARYSTATIC #needed to link to the static library
+    message("Using Staticlib.")
+}
+else {
+    message("Using dll.")
+}
+
+GPUTOOLS_LIBRARY_PATH = $$PWD/../gpuTools
+TOOLBOX_LIBRARY_PATH = $$PWD/../toolBox
+CELLENGINE_LIBRARY_PATH = $$PWD/../cellEngine
+FLUOSIM_DEPENDENCIES_PATH = $$PWD/../../FluoSim_dependencies
+DESTDIR = $$PWD/TracePlayerBatch_build/release
+OBJECTS_DIR = $$PWD/TracePlayerBatch_build/release
+MOC_DIR = $$PWD/TracePlayerBatch_build/release
+INSTALL_DIR = $$PWD/../../FluoSim_build/release #where to put the executable after compilation
+
+INCLUDEPATH += \
+\
+    TracePlayerBatch_src \
+    $$TOOLBOX_LIBRARY_PATH/ \
+        $$TOOLBOX_LIBRARY_PATH/toolBox_src \
+    $$GPUTOOLS_LIBRARY_PATH/ \
+        $$GPUTOOLS_LIBRARY_PATH/gpuTools_src \
+    $$CELLENGINE_LIBRARY_PATH/ \
+        $$CELLENGINE_LIBRARY_PATH/cellEngine_src \
+    $$FLUOSIM_DEPENDENCIES_PATH/openGL/include \
+    $$FLUOSIM_DEPENDENCIES_PATH/glm \
+    $$FLUOSIM_DEPENDENCIES_PATH/libtiff/include \
+    $$FLUOSIM_DEPENDENCIES_PATH/glew/include \
+    $$FLUOSIM_DEPENDENCIES_PATH/lmfit/include
+
+LIBS += \
+\
+    -L$$FLUOSIM_DEPENDENCIES_PATH/glew/bin \
+    -L$$FLUOSIM_DEPENDENCIES_PATH/openGL \
+    -L$$FLUOSIM_DEPENDENCIES_PATH/libtiff/bin \
+    -L$$FLUOSIM_DEPENDENCIES_PATH/lmfit/bin \
+    -L$$GPUTOOLS_LIBRARY_PATH/gpuTools_build/release \
+    -L$$TOOLBOX_LIBRARY_PATH/toolBox_build/release \
+    -L$$CELLENGINE_LIBRARY_PATH/cellEngine_build/release \
+\
+        -lglew32 \
+        -lopengl32 \
+        -llibtiff3 \
+        -lgpuTools_library \
+        -ltoolBox_library \
+        -lcellEngine_library \
+        -llmfit
+
+SOURCES += \
+\
+    TracePlayerBatch_src/main.cpp
+
+win32 {
+    DESTDIR ~= s,/,\\,g
+    INSTALL_DIR ~= s,/,\\,g
+    message($$DESTDIR)
+    message($$INSTALL_DIR)
+}
+
+QMAKE_POST_LINK += xcopy $$quote($$DESTDIR\\$${TARGET}.exe) $$quote($$INSTALL_DIR\\$${TARGET}.exe*) /Y
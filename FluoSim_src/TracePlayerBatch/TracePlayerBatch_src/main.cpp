@@ -0,0 +1,106 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#include "cstdlib"
+#include "iostream"
+#include "string"
+
+#include "QCoreApplication"
+
+#include "Measure/TraceBatchAnalyser.h"
+
+
+using namespace std;
+
+
+static void printUsage()
+{
+	cout<<"usage : TracePlayerBatch [options] path...\n"
+		  "  path : .trc/.btrc file or directory of trace files\n"
+		  "  -dt s, -px um                   timestep and pixel size\n"
+		  "  -msdPlanes n, -fitPoints n      MSD length and number of MSD points fitted for D\n"
+		  "  -minLength n, -maxLength n      length filter\n"
+		  "  -minLogD x, -maxLogD x          log10(D) filter\n"
+		  "  -link minDelay maxDelay dist    stitch the traces interrupted by blinking before the analysis\n"
+		  "  -hist n min max                 log10(D) histogram (<file>_D.txt)\n"
+		  "  -DInst, -lengths, -Ds           also export <file>_DInst.txt, <file>_lgth.txt, <file>_DPerTrack.txt\n"
+		  "  -workers n                      simultaneous files (default : one per hardware thread)\n"
+		  "  -memory MB                      memory budget of the files being processed\n";
+}
+
+//headless TracePlayer batch mode, see TraceBatchAnalyser
+int main(int argc, char* argv[])
+{
+	QCoreApplication main_app(argc, argv);
+
+	TraceBatchAnalyser analyser;
+	myTraceAnalysisParams params;
+
+	for(int arg_idx = 1; arg_idx < argc; arg_idx++)
+	{
+		string arg = argv[arg_idx];
+		int nb_args_left = argc-1 - arg_idx;
+
+		if(arg == "-dt" && nb_args_left >= 1) params.timestep = atof(argv[++arg_idx]);
+		else if(arg == "-px" && nb_args_left >= 1) params.pixel_size = atof(argv[++arg_idx]);
+		else if(arg == "-msdPlanes" && nb_args_left >= 1) params.MSD_maxDPlane = atoi(argv[++arg_idx]);
+		else if(arg == "-fitPoints" && nb_args_left >= 1) params.D_nbPointsMSDFit = atoi(argv[++arg_idx]);
+		else if(arg == "-minLength" && nb_args_left >= 1) params.min_length = atoi(argv[++arg_idx]);
+		else if(arg == "-maxLength" && nb_args_left >= 1) params.max_length = atoi(argv[++arg_idx]);
+		else if(arg == "-minLogD" && nb_args_left >= 1) params.minLogD = atof(argv[++arg_idx]);
+		else if(arg == "-maxLogD" && nb_args_left >= 1) params.maxLogD = atof(argv[++arg_idx]);
+		else if(arg == "-hist" && nb_args_left >= 3)
+		{
+			params.DsHistogram_nbIntervals = atoi(argv[++arg_idx]);
+			params.DsHistogram_minValue = atof(argv[++arg_idx]);
+			params.DsHistogram_maxValue = atof(argv[++arg_idx]);
+		}
+		else if(arg == "-link" && nb_args_left >= 3)
+		{
+			params.isGapClosing_enabled = true;
+			params.gapClosing_minDelay = atoi(argv[++arg_idx]);
+			params.gapClosing_maxDelay = atoi(argv[++arg_idx]);
+			params.gapClosing_maxDistance = atof(argv[++arg_idx]);
+		}
+		else if(arg == "-DInst") params.isDInstHistogram_exported = true;
+		else if(arg == "-lengths") params.isLengthsHistogram_exported = true;
+		else if(arg == "-Ds") params.areDs_exported = true;
+		else if(arg == "-workers" && nb_args_left >= 1) analyser.setNbWorkers(atoi(argv[++arg_idx]));
+		else if(arg == "-memory" && nb_args_left >= 1) analyser.setMemoryBudget(atoll(argv[++arg_idx])*1024*1024);
+		else if(arg.empty() == false && arg[0] == '-')
+		{
+			printUsage();
+			return 1;
+		}
+		else analyser.addPath(arg);
+	}
+
+	if(analyser.getPaths().empty())
+	{
+		printUsage();
+		return 1;
+	}
+
+	analyser.setParams(params);
+	bool areAllFilesSucceeded = analyser.run();
+	if(areAllFilesSucceeded == false) cout<<"some files could not be analysed\n";
+
+	return areAllFilesSucceeded ? 0 : 1;
+}
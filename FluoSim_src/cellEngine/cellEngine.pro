@@ -26,6 +26,12 @@ else {
     message("Using dll.")
 }
 
+#the heap allocations of the library are counted (cellEngineBenchmark : the step loop must not allocate)
+countAllocations {
+    DEFINES += CELLENGINE_COUNT_ALLOCATIONS
+    message("Counting the heap allocations.")
+}
+
 GPUTOOLS_LIBRARY_PATH = $$PWD/../gpuTools
 TOOLBOX_LIBRARY_PATH = $$PWD/../toolBox
 FLUOSIM_DEPENDENCIES_PATH = $$PWD/../../FluoSim_dependencies
@@ -63,7 +69,9 @@ LIBS += \
 
 
 SOURCES += \
+    cellEngine_src/cellEngine_allocationCounter.cpp \
     cellEngine_src/biologicalWorld/Region_gpu.cpp \
+    cellEngine_src/biologicalWorld/RegionEdges.cpp \
     cellEngine_src/biologicalWorld/BiologicalWorld.cpp \
     cellEngine_src/biologicalWorld/ChemicalSpecies.cpp \
     cellEngine_src/biologicalWorld/Fluorophore.cpp \
@@ -71,34 +79,54 @@ SOURCES += \
     cellEngine_src/biologicalWorld/FrapHead.cpp \
     cellEngine_src/biologicalWorld/Particle.cpp \
     cellEngine_src/biologicalWorld/Probe.cpp \
+    cellEngine_src/biologicalWorld/SteadyStateCache.cpp \
     cellEngine_src/displayAndcontrol/Graphics/Axis.cpp \
     cellEngine_src/displayAndcontrol/Graphics/Graphic.cpp \
+    cellEngine_src/displayAndcontrol/RegionRenderer.cpp \
     cellEngine_src/displayAndcontrol/Screen.cpp \
     cellEngine_src/displayAndcontrol/ScreenHandler.cpp \
+    cellEngine_src/Measure/CrossingAnalyser.cpp \
     cellEngine_src/Measure/FluoEvent.cpp \
     cellEngine_src/Measure/Signal.cpp \
+    cellEngine_src/Measure/SRIAccumulator.cpp \
+    cellEngine_src/Measure/StatsAccumulator.cpp \
     cellEngine_src/Measure/Trace.cpp \
+    cellEngine_src/Measure/TraceBatchAnalyser.cpp \
+    cellEngine_src/Measure/TraceLinker.cpp \
+    cellEngine_src/Measure/TraceTracker.cpp \
     cellEngine_src/physicsEngine/DiffusionSubEngine.cpp \
+    cellEngine_src/physicsEngine/PhotophysicsSubEngine.cpp \
     cellEngine_src/physicsEngine/RandomNumberGenerator.cpp
 
 HEADERS +=\
     cellEngine_src/cellEngine_library_global.h \
+    cellEngine_src/cellEngine_allocationCounter.h \
     cellEngine_src/biologicalWorld/ChemicalSpecies.h \
     cellEngine_src/biologicalWorld/Region_gpu.h \
+    cellEngine_src/biologicalWorld/RegionEdges.h \
     cellEngine_src/biologicalWorld/BiologicalWorld.h \
     cellEngine_src/biologicalWorld/Fluorophore.h \
     cellEngine_src/biologicalWorld/FluorophoreSpecies.h \
     cellEngine_src/biologicalWorld/FrapHead.h \
     cellEngine_src/biologicalWorld/Particle.h \
     cellEngine_src/biologicalWorld/Probe.h \
+    cellEngine_src/biologicalWorld/SteadyStateCache.h \
     cellEngine_src/displayAndcontrol/Graphics/Axis.h \
     cellEngine_src/displayAndcontrol/Graphics/Graphic.h \
+    cellEngine_src/displayAndcontrol/RegionRenderer.h \
     cellEngine_src/displayAndcontrol/Screen.h \
     cellEngine_src/displayAndcontrol/ScreenHandler.h \
+    cellEngine_src/Measure/CrossingAnalyser.h \
     cellEngine_src/Measure/FluoEvent.h \
     cellEngine_src/Measure/Signal.h \
+    cellEngine_src/Measure/SRIAccumulator.h \
+    cellEngine_src/Measure/StatsAccumulator.h \
     cellEngine_src/Measure/Trace.h \
+    cellEngine_src/Measure/TraceBatchAnalyser.h \
+    cellEngine_src/Measure/TraceLinker.h \
+    cellEngine_src/Measure/TraceTracker.h \
     cellEngine_src/physicsEngine/DiffusionSubEngine.h \
+    cellEngine_src/physicsEngine/PhotophysicsSubEngine.h \
     cellEngine_src/physicsEngine/RandomNumberGenerator.h
 
 win32 {
@@ -0,0 +1,386 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+
+
+#include "algorithm"
+#include "fstream"
+
+#include "CrossingAnalyser.h"
+
+#include "toolBox_src/toolbox_library_global.h"
+    #include "toolBox_src/parallelTools/myWorkStealingPool.h"
+
+using namespace std;
+using namespace glm;
+
+
+CrossingAnalyser::CrossingAnalyser(int max_dwell, int nb_workers)
+{
+	m_max_dwell = std::max(1, max_dwell);
+	m_nbWorkers = nb_workers;
+
+	m_grid_origin = vec2(0,0);
+	m_grid_invCellSize = 1.0f;
+	m_grid_size = ivec2(0,0);
+}
+
+void CrossingAnalyser::setRegions(const list<Region>& regions)
+{
+	m_regions_v.clear();
+	m_surfaces_v.clear();
+	m_bottomLeft_v.clear();
+	m_topRight_v.clear();
+	m_gridCellStart_v.clear();
+	m_gridRgns_v.clear();
+	m_grid_size = ivec2(0,0);
+
+	vector<float> rgn_sizes;
+	vec2 world_bottomLeft, world_topRight;
+	bool isWorld_set = false;
+	vector<vec2> points_v;
+
+	for(const Region& rgn : regions)
+	{
+		vec2 bottom_left(0,0), top_right(-1,-1); //empty regions : top right < bottom left
+		if(rgn.getBottomLeft(bottom_left) == true)
+		{
+			rgn.getTopRight(top_right);
+
+			vec2 rgn_size = top_right - bottom_left;
+			rgn_sizes.push_back(std::max(rgn_size.x, rgn_size.y));
+
+			if(isWorld_set == false)
+			{
+				world_bottomLeft = bottom_left;
+				world_topRight = top_right;
+				isWorld_set = true;
+			}
+			world_bottomLeft = glm::min(world_bottomLeft, bottom_left);
+			world_topRight = glm::max(world_topRight, top_right);
+		}
+
+		points_v.clear();
+		rgn.getRegionSubData(&points_v, 0, rgn.getSize());
+
+		m_regions_v.push_back(&rgn);
+		m_surfaces_v.push_back(computeSurface(points_v));
+		m_bottomLeft_v.push_back(bottom_left);
+		m_topRight_v.push_back(top_right);
+	}
+
+	if(isWorld_set == false) return; //->
+
+	//about one typical region per cell, at most 512 cells per side (as the biological world region lookup)
+	nth_element(rgn_sizes.begin(), rgn_sizes.begin() + rgn_sizes.size()/2, rgn_sizes.end());
+	vec2 world_size = world_topRight - world_bottomLeft;
+	float cell_size = rgn_sizes[rgn_sizes.size()/2];
+	cell_size = std::max(cell_size, std::max(world_size.x, world_size.y)/512.0f);
+	if(cell_size <= 0.0f) cell_size = 1.0f;
+
+	m_grid_origin = world_bottomLeft;
+	m_grid_invCellSize = 1.0f/cell_size;
+	m_grid_size = ivec2(int(world_size.x*m_grid_invCellSize) + 1, int(world_size.y*m_grid_invCellSize) + 1);
+
+	//compressed rows of the cells overlapped by each bounding box, by increasing region index
+	int nb_cells = m_grid_size.x*m_grid_size.y;
+	m_gridCellStart_v.assign(nb_cells + 1, 0);
+
+	for(int pass = 0; pass < 2; pass++)
+	{
+		vector<int> cellFill_v;
+		if(pass == 1)
+		{
+			for(int cell_idx = 0; cell_idx <= nb_cells-1; cell_idx++) m_gridCellStart_v[cell_idx+1] += m_gridCellStart_v[cell_idx];
+			m_gridRgns_v.resize(m_gridCellStart_v.back());
+			cellFill_v.assign(m_gridCellStart_v.begin(), m_gridCellStart_v.end() - 1);
+		}
+
+		for(int rgn_idx = 0; rgn_idx < int(m_regions_v.size()); rgn_idx++)
+		{
+			if(m_topRight_v[rgn_idx].x < m_bottomLeft_v[rgn_idx].x) continue; //<- empty region
+
+			ivec2 cell_min = ivec2((m_bottomLeft_v[rgn_idx] - m_grid_origin)*m_grid_invCellSize);
+			ivec2 cell_max = ivec2((m_topRight_v[rgn_idx] - m_grid_origin)*m_grid_invCellSize);
+			cell_max = glm::min(cell_max, m_grid_size - 1);
+
+			for(int y = cell_min.y; y <= cell_max.y; y++)
+			{
+				for(int x = cell_min.x; x <= cell_max.x; x++)
+				{
+					int cell_idx = y*m_grid_size.x + x;
+					if(pass == 0) m_gridCellStart_v[cell_idx+1]++;
+					else
+					{
+						m_gridRgns_v[cellFill_v[cell_idx]] = rgn_idx;
+						cellFill_v[cell_idx]++;
+					}
+				}
+			}
+		}
+	}
+}
+
+int CrossingAnalyser::getNbRegions() const
+{
+	return m_regions_v.size();
+}
+
+void CrossingAnalyser::_getContainingRegions(const vec2& r, vector<int>& rgns_v) const
+{
+	rgns_v.clear();
+	if(m_gridRgns_v.empty()) return; //->
+
+	ivec2 cell = ivec2(glm::floor((r - m_grid_origin)*m_grid_invCellSize));
+	if(cell.x < 0 || cell.y < 0 || cell.x >= m_grid_size.x || cell.y >= m_grid_size.y) return; //->
+
+	int cell_idx = cell.y*m_grid_size.x + cell.x;
+	for(int entry_idx = m_gridCellStart_v[cell_idx]; entry_idx < m_gridCellStart_v[cell_idx+1]; entry_idx++)
+	{
+		int rgn_idx = m_gridRgns_v[entry_idx];
+		if(glm::any(glm::lessThan(r, m_bottomLeft_v[rgn_idx])) || glm::any(glm::greaterThan(r, m_topRight_v[rgn_idx]))) continue; //<-
+
+		if(m_regions_v[rgn_idx]->isInside(r)) rgns_v.push_back(rgn_idx);
+	}
+}
+
+int CrossingAnalyser::_getInnermostRegion(const vector<int>& rgns_v) const
+{
+	//smallest surface, the last region on equal surfaces
+	int innermost_idx = -1;
+	for(int rgn_idx : rgns_v)
+	{
+		if(innermost_idx == -1 || m_surfaces_v[rgn_idx] <= m_surfaces_v[innermost_idx]) innermost_idx = rgn_idx;
+	}
+
+	return innermost_idx;
+}
+
+int CrossingAnalyser::getRegionIdx(const vec2& r) const
+{
+	vector<int> rgns_v;
+	_getContainingRegions(r, rgns_v);
+
+	return _getInnermostRegion(rgns_v);
+}
+
+void CrossingAnalyser::_initialiseData(vector<myRegionCrossingStats>& stats_v, vector<long long>& stays_v) const
+{
+	myRegionCrossingStats empty_stats;
+		empty_stats.insideDwell_v.assign(m_max_dwell+1, 0);
+		empty_stats.outsideDwell_v.assign(m_max_dwell+1, 0);
+
+	stats_v.assign(m_regions_v.size(), empty_stats);
+	stays_v.assign(m_regions_v.size()+1, 0);
+}
+
+void CrossingAnalyser::_record(vector<long long>& histogram_v, int dwell) const
+{
+	histogram_v[std::min(dwell, m_max_dwell)]++;
+}
+
+void CrossingAnalyser::_analyseTrace(const Trace& trace, workerData& data) const
+{
+	const vector<FluoEvent>& events = trace.m_fluo_events;
+	long long nb_states = m_regions_v.size()+1;
+
+	data.runs_v.clear();
+	int previous_state = -1;
+
+	for(int event_pos = 0; event_pos < int(events.size()); event_pos++)
+	{
+		_getContainingRegions(vec2(events[event_pos].x, events[event_pos].y), data.rgns_v);
+
+		int state = _getInnermostRegion(data.rgns_v);
+		if(event_pos != 0)
+		{
+			if(state == previous_state) data.stays_v[state+1]++;
+			else data.changes_map[(previous_state+1)*nb_states + state+1]++;
+		}
+		previous_state = state;
+
+		//exits
+		for(regionRun& run : data.runs_v)
+		{
+			if(run.isInside == false) continue; //<-
+			if(binary_search(data.rgns_v.begin(), data.rgns_v.end(), run.rgn_idx)) continue; //<- still inside
+
+			myRegionCrossingStats& stats = data.stats_v[run.rgn_idx];
+			stats.nb_exits++;
+			if(run.isFirstRun == false) _record(stats.insideDwell_v, event_pos - run.beg_pos - 1);
+
+			run.isInside = false;
+			run.beg_pos = event_pos;
+			run.isFirstRun = false;
+		}
+
+		//entries
+		for(int rgn_idx : data.rgns_v)
+		{
+			myRegionCrossingStats& stats = data.stats_v[rgn_idx];
+			stats.nb_eventsInside++;
+
+			auto run = find_if(data.runs_v.begin(), data.runs_v.end(), [rgn_idx](const regionRun& rgn_run)
+			{
+				return rgn_run.rgn_idx == rgn_idx;
+			});
+
+			if(run == data.runs_v.end())
+			{
+				//outside since the beginning of the trace : that first run is not recorded
+				if(event_pos != 0) stats.nb_entries++;
+				data.runs_v.push_back({rgn_idx, true, event_pos, event_pos == 0});
+			}
+			else if(run->isInside == false)
+			{
+				stats.nb_entries++;
+				if(run->isFirstRun == false) _record(stats.outsideDwell_v, event_pos - run->beg_pos - 1);
+
+				run->isInside = true;
+				run->beg_pos = event_pos;
+				run->isFirstRun = false;
+			}
+		}
+	}
+}
+
+void CrossingAnalyser::analyse(vector<Trace>& traces)
+{
+	_initialiseData(m_stats_v, m_stays_v);
+	m_changes_map.clear();
+
+	myWorkStealingPool pool(m_nbWorkers);
+	vector<workerData> workersData_v(pool.getNbWorkers());
+	for(workerData& data : workersData_v) _initialiseData(data.stats_v, data.stays_v);
+
+	const int nb_traces_perTask = 256;
+	int nb_traces = traces.size();
+	int nb_tasks = (nb_traces + nb_traces_perTask-1)/nb_traces_perTask;
+
+	pool.run(nb_tasks, [&](int task_idx, int worker_idx)
+	{
+		int last_trc = std::min(nb_traces, (task_idx+1)*nb_traces_perTask);
+		for(int trc_idx = task_idx*nb_traces_perTask; trc_idx < last_trc; trc_idx++)
+		{
+			_analyseTrace(traces[trc_idx], workersData_v[worker_idx]);
+		}
+	});
+
+	//reduction of the workers histograms
+	for(workerData& data : workersData_v)
+	{
+		for(int rgn_idx = 0; rgn_idx < int(m_stats_v.size()); rgn_idx++)
+		{
+			myRegionCrossingStats& stats = m_stats_v[rgn_idx];
+			const myRegionCrossingStats& worker_stats = data.stats_v[rgn_idx];
+
+			stats.nb_entries += worker_stats.nb_entries;
+			stats.nb_exits += worker_stats.nb_exits;
+			stats.nb_eventsInside += worker_stats.nb_eventsInside;
+			for(int dwell = 0; dwell <= m_max_dwell; dwell++)
+			{
+				stats.insideDwell_v[dwell] += worker_stats.insideDwell_v[dwell];
+				stats.outsideDwell_v[dwell] += worker_stats.outsideDwell_v[dwell];
+			}
+		}
+
+		for(int state_idx = 0; state_idx < int(m_stays_v.size()); state_idx++) m_stays_v[state_idx] += data.stays_v[state_idx];
+		for(auto& change : data.changes_map) m_changes_map[change.first] += change.second;
+	}
+}
+
+const myRegionCrossingStats& CrossingAnalyser::getStats(int rgn_idx) const
+{
+	return m_stats_v[rgn_idx];
+}
+
+long long CrossingAnalyser::getTransitionCount(int from_state, int to_state) const
+{
+	int nb_states = m_regions_v.size()+1;
+	if(from_state < -1 || to_state < -1 || from_state >= nb_states-1 || to_state >= nb_states-1) return 0; //->
+	if(from_state == to_state) return m_stays_v.empty() ? 0 : m_stays_v[from_state+1]; //->
+
+	auto change = m_changes_map.find((long long)(from_state+1)*nb_states + to_state+1);
+	if(change == m_changes_map.end()) return 0; //->
+
+	return change->second;
+}
+
+vector<myStateTransition> CrossingAnalyser::getTransitions() const
+{
+	long long nb_states = m_regions_v.size()+1;
+
+	vector<myStateTransition> transitions_v;
+	for(auto& change : m_changes_map)
+	{
+		transitions_v.push_back({int(change.first/nb_states) - 1, int(change.first%nb_states) - 1, change.second});
+	}
+
+	sort(transitions_v.begin(), transitions_v.end(), [](const myStateTransition& t1, const myStateTransition& t2)
+	{
+		if(t1.from_state != t2.from_state) return t1.from_state < t2.from_state;
+		return t1.to_state < t2.to_state;
+	});
+
+	return transitions_v;
+}
+
+void CrossingAnalyser::saveStatsAsString(string file_path) const
+{
+	ofstream myfile(file_path);
+	if(myfile.is_open() == false)
+	{
+		cout<<"In CrossingAnalyser::saveStatsAsString : error (cannot open "<<file_path<<")\n";
+		return; //->
+	}
+
+	myfile<<"region\tname\tentries\texits\tevents inside\tstays\n";
+	for(int rgn_idx = 0; rgn_idx < int(m_stats_v.size()); rgn_idx++)
+	{
+		const myRegionCrossingStats& stats = m_stats_v[rgn_idx];
+		myfile<<rgn_idx<<'\t'<<m_regions_v[rgn_idx]->getName()<<'\t'<<stats.nb_entries<<'\t'<<stats.nb_exits<<'\t'
+			  <<stats.nb_eventsInside<<'\t'<<m_stays_v[rgn_idx+1]<<'\n';
+	}
+
+	//one column per region, one row per dwell (in events), the last row gathering the longer dwells
+	for(int histogram_idx = 0; histogram_idx < 2; histogram_idx++)
+	{
+		myfile<<'\n'<<(histogram_idx == 0 ? "nbEventsBeforeLeaving" : "nbEventsBeforeEntering");
+		for(int rgn_idx = 0; rgn_idx < int(m_stats_v.size()); rgn_idx++) myfile<<'\t'<<rgn_idx;
+		myfile<<'\n';
+
+		for(int dwell = 0; dwell <= m_max_dwell; dwell++)
+		{
+			myfile<<dwell;
+			for(const myRegionCrossingStats& stats : m_stats_v)
+			{
+				myfile<<'\t'<<(histogram_idx == 0 ? stats.insideDwell_v[dwell] : stats.outsideDwell_v[dwell]);
+			}
+			myfile<<'\n';
+		}
+	}
+
+	myfile<<"\nfrom\tto\tcount\n";
+	for(const myStateTransition& transition : getTransitions())
+	{
+		myfile<<transition.from_state<<'\t'<<transition.to_state<<'\t'<<transition.count<<'\n';
+	}
+	myfile.close();
+}
@@ -0,0 +1,129 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#ifndef CROSSINGANALYSER_H
+#define CROSSINGANALYSER_H
+
+#include "list"
+#include "string"
+#include "unordered_map"
+#include "vector"
+
+#include "glm.hpp"
+
+#include "cellEngine_library_global.h"
+    #include "Trace.h"
+    #include "biologicalWorld/Region_gpu.h"
+
+
+//crossing statistics of one region, the dwell times are in events, as in analyseTracesCrossings :
+//a run starting with the trace is not recorded (its start is unknown), nor is the one ending with it
+struct myRegionCrossingStats
+{
+	long long nb_entries = 0;
+	long long nb_exits = 0;
+	long long nb_eventsInside = 0;
+	std::vector<long long> insideDwell_v; //nbEventsBeforeLeaving histogram, last bin : longer dwells
+	std::vector<long long> outsideDwell_v; //nbEventsBeforeEntering histogram
+};
+
+struct myStateTransition
+{
+	int from_state; //region index, -1 : outside every region
+	int to_state;
+	long long count;
+};
+
+
+//crossings of a set of traces with every region of a geometry, in one pass :
+//	- the regions are indexed by a grid of their bounding boxes, an event is only tested against the regions of its cell,
+//	- the traces are split in blocks run by a myWorkStealingPool, each worker filling its own histograms,
+//	- the state of an event (for the transition matrix) is the smallest region containing it, -1 if none.
+
+class CELLENGINE_LIBRARYSHARED_EXPORT CrossingAnalyser
+{
+public :
+
+	CrossingAnalyser(int max_dwell = 200, int nb_workers = 0);
+
+	void setRegions(const std::list<Region>& regions); //the regions are referenced until the next setRegions
+	int getNbRegions() const;
+	int getRegionIdx(const glm::vec2& r) const; //state of a position
+
+	void analyse(std::vector<Trace>& traces);
+
+	const myRegionCrossingStats& getStats(int rgn_idx) const;
+	long long getTransitionCount(int from_state, int to_state) const;
+	std::vector<myStateTransition> getTransitions() const; //the state changes, stays excluded
+
+	void saveStatsAsString(std::string file_path) const;
+
+private :
+
+	struct regionRun //current run of a trace inside or outside a region
+	{
+		int rgn_idx;
+		bool isInside;
+		int beg_pos;
+		bool isFirstRun;
+	};
+
+	struct workerData
+	{
+		std::vector<int> rgns_v; //regions containing the current event
+		std::vector<regionRun> runs_v; //regions met by the current trace
+
+		std::vector<myRegionCrossingStats> stats_v;
+		std::vector<long long> stays_v; //transitions from a state to itself, state+1
+		std::unordered_map<long long, long long> changes_map; //(from_state+1)*(nb_regions+1) + to_state+1
+	};
+
+	void _getContainingRegions(const glm::vec2& r, std::vector<int>& rgns_v) const;
+	int _getInnermostRegion(const std::vector<int>& rgns_v) const;
+	void _initialiseData(std::vector<myRegionCrossingStats>& stats_v, std::vector<long long>& stays_v) const;
+	void _analyseTrace(const Trace& trace, workerData& data) const;
+	void _record(std::vector<long long>& histogram_v, int dwell) const;
+
+private :
+
+	int m_max_dwell;
+	int m_nbWorkers;
+
+//regions
+	std::vector<const Region*> m_regions_v;
+	std::vector<float> m_surfaces_v;
+	std::vector<glm::vec2> m_bottomLeft_v;
+	std::vector<glm::vec2> m_topRight_v;
+
+//bounding boxes grid
+	glm::vec2 m_grid_origin;
+	float m_grid_invCellSize;
+	glm::ivec2 m_grid_size;
+	std::vector<int> m_gridCellStart_v; //regions of cell i : m_gridRgns_v[start_i, start_i+1[
+	std::vector<int> m_gridRgns_v;
+
+//results
+	std::vector<myRegionCrossingStats> m_stats_v;
+	std::vector<long long> m_stays_v;
+	std::unordered_map<long long, long long> m_changes_map;
+};
+
+
+#endif // CROSSINGANALYSER_H
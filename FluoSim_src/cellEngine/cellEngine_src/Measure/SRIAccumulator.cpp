@@ -0,0 +1,273 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+#include "cmath"
+
+#include "SRIAccumulator.h"
+#include "toolBox_src/imageTools/image_format/tiff_format.h"
+#include "toolBox_src/developmentTools/myProfiler.h"
+
+using namespace std;
+using namespace glm;
+
+
+const int SRI_NB_CHUNKS = 64;
+const int SRI_JITTER_BLOCK = 256;
+
+
+SRIAccumulator::SRIAccumulator()
+{
+	m_bottomLeft = vec2(0,0);
+	m_topRight = vec2(0,0);
+	m_definition = ivec2(0,0);
+	m_pxPerUnit = vec2(0,0);
+	m_pointingAccuracy = 0.0f;
+	m_isRecordingLocalisations = false;
+	m_nbBands = 0;
+
+	m_randomFactories_v.resize(SRI_NB_CHUNKS);
+	setRandomSeed(std::default_random_engine::default_seed); //consecutive seeds would give correlated streams
+}
+
+void SRIAccumulator::setField(vec2 bottomLeft, vec2 topRight, ivec2 definition)
+{
+	vec2 diag = topRight - bottomLeft;
+	if(definition.x <= 0 || definition.y <= 0 || diag.x <= 0 || diag.y <= 0)
+	{
+		cout<<"In SRIAccumulator::setField : error (empty field or definition)\n";
+		return;
+	}
+
+	if(bottomLeft == m_bottomLeft && topRight == m_topRight && definition == m_definition) return; //->
+
+	m_bottomLeft = bottomLeft;
+	m_topRight = topRight;
+	m_definition = definition;
+	m_pxPerUnit = vec2(definition)/diag;
+	clear();
+}
+
+bool SRIAccumulator::isFieldSet() const
+{
+	return m_definition.x > 0 && m_definition.y > 0;
+}
+
+void SRIAccumulator::setPointingAccuracy(float pointingAccuracy_px)
+{
+	m_pointingAccuracy = pointingAccuracy_px;
+}
+
+void SRIAccumulator::setRandomSeed(unsigned int seed)
+{
+	for(uint chunk_idx = 0; chunk_idx < m_randomFactories_v.size(); chunk_idx++)
+	{
+		std::seed_seq seed_sequence{seed, chunk_idx};
+		unsigned int chunk_seed;
+		seed_sequence.generate(&chunk_seed, &chunk_seed + 1);
+
+		m_randomFactories_v[chunk_idx].setSeed(chunk_seed);
+	}
+}
+
+void SRIAccumulator::setIsRecordingLocalisations(bool isRecording)
+{
+	m_isRecordingLocalisations = isRecording;
+}
+
+void SRIAccumulator::clear()
+{
+	m_image_v.assign(m_definition.x*m_definition.y, 0.0f);
+	m_localisations_v.clear();
+}
+
+void SRIAccumulator::accumulate(list<Particle>& particles, int plane)
+{
+	if(isFieldSet() == false) return; //->
+
+	PROFILE_ZONE("SRI accumulation");
+
+	m_r_v.clear();
+	for(Particle& ptcl : particles)
+	{
+		if(ptcl.getIntensity() != 0.0) m_r_v.push_back(ptcl.getR());
+	}
+	m_pixelIdx_v.resize(m_r_v.size());
+
+	_setBands(std::min(m_pool.getNbWorkers(), m_definition.y));
+	m_chunkBandOffsets_v.assign(SRI_NB_CHUNKS*m_nbBands, 0);
+
+	m_pool.run(SRI_NB_CHUNKS, [this](int chunk_idx, int){_jitterChunk(chunk_idx);});
+
+	//band-major offsets : the localisations of a band are contiguous, in the order of the chunks
+	int offset = 0;
+	for(int band_idx = 0; band_idx < m_nbBands; band_idx++)
+	{
+		m_bandOffsets_v[band_idx] = offset;
+		for(int chunk_idx = 0; chunk_idx < SRI_NB_CHUNKS; chunk_idx++)
+		{
+			int& chunk_band = m_chunkBandOffsets_v[chunk_idx*m_nbBands + band_idx];
+			int nb_localisations = chunk_band;
+			chunk_band = offset;
+			offset += nb_localisations;
+		}
+	}
+	m_bandOffsets_v[m_nbBands] = offset;
+	m_bucketedPixelIdx_v.resize(offset);
+
+	m_pool.run(SRI_NB_CHUNKS, [this](int chunk_idx, int){_bucketChunk(chunk_idx);});
+	m_pool.run(m_nbBands, [this](int band_idx, int){_binBand(band_idx);});
+
+	if(m_isRecordingLocalisations == true)
+	{
+		for(vec2& r : m_r_v)
+		{
+			FluoEvent localisation = {0, plane, r.x, r.y, 0.0, 0, 1.0f};
+			m_localisations_v.push_back(localisation);
+		}
+	}
+}
+
+void SRIAccumulator::_setBands(int nb_bands)
+{
+	if(nb_bands == m_nbBands && int(m_rowBand_v.size()) == m_definition.y) return; //->
+
+	m_nbBands = nb_bands;
+	m_rowBand_v.resize(m_definition.y);
+	m_bandOffsets_v.resize(nb_bands+1);
+	for(int band_idx = 0; band_idx < nb_bands; band_idx++)
+	{
+		int row_beg = (long long)(m_definition.y)*band_idx/nb_bands;
+		int row_end = (long long)(m_definition.y)*(band_idx+1)/nb_bands;
+		for(int row_idx = row_beg; row_idx < row_end; row_idx++) m_rowBand_v[row_idx] = band_idx;
+	}
+}
+
+void SRIAccumulator::_jitterChunk(int chunk_idx)
+{
+	int nb_localisations = m_r_v.size();
+	int ptcl_beg = (long long)(nb_localisations)*chunk_idx/SRI_NB_CHUNKS;
+	int ptcl_end = (long long)(nb_localisations)*(chunk_idx+1)/SRI_NB_CHUNKS;
+	RandomNumberGenerator& factory = m_randomFactories_v[chunk_idx];
+
+	//box-muller by blocks : the uniform draws are serial, the transform is a branch-free loop the compiler can vectorize
+	float u1[SRI_JITTER_BLOCK], u2[SRI_JITTER_BLOCK];
+	for(int block_beg = ptcl_beg; block_beg < ptcl_end; block_beg += SRI_JITTER_BLOCK)
+	{
+		int block_size = std::min(SRI_JITTER_BLOCK, ptcl_end - block_beg);
+		vec2* r = m_r_v.data() + block_beg;
+		int* pixel_idx = m_pixelIdx_v.data() + block_beg;
+
+		if(m_pointingAccuracy > 0)
+		{
+			for(int idx = 0; idx < block_size; idx++)
+			{
+				u1[idx] = 1.0f - factory.uniformRandomNumber(); //]0,1]
+				u2[idx] = factory.uniformRandomNumber();
+			}
+
+			const float two_pi = 6.28318530718f;
+			for(int idx = 0; idx < block_size; idx++)
+			{
+				float radius = m_pointingAccuracy*std::sqrt(-2.0f*std::log(u1[idx]));
+				float angle = two_pi*u2[idx];
+				r[idx].x += radius*std::cos(angle);
+				r[idx].y += radius*std::sin(angle);
+			}
+		}
+
+		for(int idx = 0; idx < block_size; idx++)
+		{
+			vec2 pixel_r = (r[idx] - m_bottomLeft)*m_pxPerUnit;
+			bool isInside = pixel_r.x >= 0 && pixel_r.y >= 0 && pixel_r.x < m_definition.x && pixel_r.y < m_definition.y;
+			pixel_idx[idx] = isInside ? int(pixel_r.y)*m_definition.x + int(pixel_r.x) : -1;
+		}
+	}
+
+	//localisations per band, turned into offsets before the bucketing
+	int* band_counts = m_chunkBandOffsets_v.data() + chunk_idx*m_nbBands;
+	for(int ptcl_idx = ptcl_beg; ptcl_idx < ptcl_end; ptcl_idx++)
+	{
+		int pixel_idx = m_pixelIdx_v[ptcl_idx];
+		if(pixel_idx >= 0) band_counts[m_rowBand_v[pixel_idx/m_definition.x]]++;
+	}
+}
+
+void SRIAccumulator::_bucketChunk(int chunk_idx)
+{
+	int nb_localisations = m_r_v.size();
+	int ptcl_beg = (long long)(nb_localisations)*chunk_idx/SRI_NB_CHUNKS;
+	int ptcl_end = (long long)(nb_localisations)*(chunk_idx+1)/SRI_NB_CHUNKS;
+
+	//each chunk writes its own slice of each band
+	int* band_offsets = m_chunkBandOffsets_v.data() + chunk_idx*m_nbBands;
+	for(int ptcl_idx = ptcl_beg; ptcl_idx < ptcl_end; ptcl_idx++)
+	{
+		int pixel_idx = m_pixelIdx_v[ptcl_idx];
+		if(pixel_idx < 0) continue; //<-
+
+		int& offset = band_offsets[m_rowBand_v[pixel_idx/m_definition.x]];
+		m_bucketedPixelIdx_v[offset] = pixel_idx;
+		offset++;
+	}
+}
+
+void SRIAccumulator::_binBand(int band_idx)
+{
+	float* image = m_image_v.data();
+	for(int idx = m_bandOffsets_v[band_idx]; idx < m_bandOffsets_v[band_idx+1]; idx++)
+	{
+		image[m_bucketedPixelIdx_v[idx]] += 1.0f;
+	}
+}
+
+ivec2 SRIAccumulator::getDefinition() const
+{
+	return m_definition;
+}
+
+const vector<float>& SRIAccumulator::getImage() const
+{
+	return m_image_v;
+}
+
+const vector<FluoEvent>& SRIAccumulator::getLocalisations() const
+{
+	return m_localisations_v;
+}
+
+bool SRIAccumulator::saveImage(string tiff_path)
+{
+	if(isFieldSet() == false) return false; //->
+
+	PROFILE_ZONE("tiff I/O");
+	myTiff tiff;
+	if(tiff.open(tiff_path, myTiff::WRITE_MODE) == false) return false; //->
+
+	tiff.setSamplesPerPixel(1);
+	tiff.setBytesPerSample(4);
+	tiff.setSampleFormat(SAMPLEFORMAT_IEEEFP);
+	tiff.setTiffSize(vec2(m_definition));
+	tiff.addPage((uint8*) m_image_v.data());
+	return true;
+}
+
+void SRIAccumulator::saveLocalisations(string file_path, float dt, float pixel_size)
+{
+	saveLocalisationsAsString(m_localisations_v, file_path, THUNDERSTORM_FORMAT, dt, pixel_size);
+}
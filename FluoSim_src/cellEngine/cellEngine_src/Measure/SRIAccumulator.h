@@ -0,0 +1,96 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+#ifndef SRIACCUMULATOR_H
+#define SRIACCUMULATOR_H
+
+#include "list"
+#include "string"
+#include "vector"
+
+#include "cellEngine_library_global.h"
+    #include "FluoEvent.h"
+    #include "biologicalWorld/Particle.h"
+    #include "physicsEngine/RandomNumberGenerator.h"
+
+#include "toolBox_src/toolbox_library_global.h"
+    #include "toolBox_src/parallelTools/myWorkStealingPool.h"
+
+
+//super-resolution image built on the CPU : each visible particle gives one localisation per frame,
+//jittered by the pointing accuracy and binned in a float histogram covering the field
+//	- the jitter runs in fixed chunks with one random stream each : the image does not depend on the number of threads,
+//	- the localisations are bucketed by band of rows while jittered, each thread then bins the bucket of its band :
+//	  it owns its pixels, no reduction is needed.
+
+class CELLENGINE_LIBRARYSHARED_EXPORT SRIAccumulator
+{
+public :
+
+	SRIAccumulator();
+
+	void setField(glm::vec2 bottomLeft, glm::vec2 topRight, glm::ivec2 definition); //[px], a new field resets the image
+	bool isFieldSet() const;
+	void setPointingAccuracy(float pointingAccuracy_px);
+	void setRandomSeed(unsigned int seed);
+	void setIsRecordingLocalisations(bool isRecording);
+	void clear();
+
+	void accumulate(std::list<Particle>& particles, int plane);
+
+	glm::ivec2 getDefinition() const;
+	const std::vector<float>& getImage() const; //row-major, first row at the bottom of the field
+	const std::vector<FluoEvent>& getLocalisations() const;
+
+	bool saveImage(std::string tiff_path); //32-bit float tiff
+	void saveLocalisations(std::string file_path, float dt, float pixel_size); //thunderSTORM table
+
+private :
+
+	void _setBands(int nb_bands);
+	void _jitterChunk(int chunk_idx);
+	void _bucketChunk(int chunk_idx);
+	void _binBand(int band_idx);
+
+private :
+
+	glm::vec2 m_bottomLeft;
+	glm::vec2 m_topRight;
+	glm::ivec2 m_definition;
+	glm::vec2 m_pxPerUnit;
+	float m_pointingAccuracy;
+
+	std::vector<float> m_image_v;
+	bool m_isRecordingLocalisations;
+	std::vector<FluoEvent> m_localisations_v;
+
+	std::vector<glm::vec2> m_r_v; //localisations of the current frame
+	std::vector<int> m_pixelIdx_v; //-1 if outside the field
+
+	int m_nbBands;
+	std::vector<int> m_rowBand_v; //band of each row of the field
+	std::vector<int> m_chunkBandOffsets_v; //[chunk_idx*m_nbBands + band_idx] : count, then offset in m_bucketedPixelIdx_v
+	std::vector<int> m_bandOffsets_v; //m_nbBands+1 offsets in m_bucketedPixelIdx_v
+	std::vector<int> m_bucketedPixelIdx_v; //pixel indices of the field localisations, grouped by band
+	std::vector<RandomNumberGenerator> m_randomFactories_v; //one per chunk
+	myWorkStealingPool m_pool;
+};
+
+
+#endif // SRIACCUMULATOR_H
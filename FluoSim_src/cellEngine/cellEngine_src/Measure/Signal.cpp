@@ -20,11 +20,34 @@
 
 
 
+#include "algorithm"
+
 #include "Signal.h"
 
 using namespace std;
 using namespace glm;
 
+static myLodBucket makeLodBucket(const vec2& value)
+{
+	myLodBucket bucket;
+		bucket.bottom_left = value;
+		bucket.top_right = value;
+		bucket.y_min_pt = value;
+		bucket.y_max_pt = value;
+
+	return bucket;
+}
+
+//next_bucket follows bucket, on equal values the first sample is kept
+static void mergeLodBuckets(myLodBucket& bucket, const myLodBucket& next_bucket)
+{
+	bucket.bottom_left = glm::min(bucket.bottom_left, next_bucket.bottom_left);
+	bucket.top_right = glm::max(bucket.top_right, next_bucket.top_right);
+
+	if(next_bucket.y_min_pt.y < bucket.y_min_pt.y) bucket.y_min_pt = next_bucket.y_min_pt;
+	if(next_bucket.y_max_pt.y > bucket.y_max_pt.y) bucket.y_max_pt = next_bucket.y_max_pt;
+}
+
 Signal::Signal() :
 
 	myGLObject(myGLObject::IS_RENDERABLE_OBJECT,
@@ -80,6 +103,8 @@ Signal::Signal() :
 	setProgram(program);
 	m_color = vec4(1,1,1,1);
 	m_nbPts_insideRect = 0;
+	m_isXSorted = true;
+	_clearLod();
 }
 
 
@@ -129,6 +154,10 @@ void Signal::setValue(vec2 value, int value_idx)
     m_values_gv.clear();
     m_values_gv = gstd::gVector<vec2>(m_values);
 
+	m_isXSorted = std::is_sorted(m_values.begin(), m_values.end(),
+								 [](const vec2& r1, const vec2& r2) {return r1.x < r2.x;});
+	_updateLod(value_idx);
+
 	m_nbPts_insideRect = 0;
 
 	computeContourRect();
@@ -145,14 +174,17 @@ void Signal::addValue(vec2 value)
 {
     m_values.push_back(value);
 	m_values_gv.push_back(value);
+	_addToLod(m_values.size()-1);
 	computeContourRect();
 }
 
 
 void Signal::addValues(vector<vec2> values_v)
 {
+	int first_idx = m_values.size();
     m_values.insert(m_values.end(), values_v.begin(), values_v.end());
 	m_values_gv.insert(m_values_gv.size(), values_v);
+	for(int value_idx = first_idx; value_idx < int(m_values.size()); value_idx++) _addToLod(value_idx);
 	computeContourRect();
 }
 
@@ -168,6 +200,7 @@ void Signal::addValues(vec2* values_a, int nb_values)
     {
         m_values.push_back(values_a[value_idx]);
 		m_values_gv.push_back(values_a[value_idx]);
+		_addToLod(m_values.size()-1);
     }
 	computeContourRect();
 }
@@ -178,6 +211,8 @@ void Signal::clearValues()
     m_values_gv.clear();
 
 	m_nbPts_insideRect = 0;
+	m_isXSorted = true;
+	_clearLod();
 }
 
 void Signal::coutSignal()
@@ -202,57 +237,207 @@ void Signal::saveSignal(string file_dir)
 void Signal::render(myGLObject* screen)
 {
 	int nb_points = m_values.size();
-	if(m_isProgram_set && isVisible() == true)
+	if(m_isProgram_set && isVisible() == true && nb_points != 0)
     {
+		//visible samples, the ones just outside the screen included to draw the entering segments
+		int first_idx = 0;
+		int last_idx = nb_points-1;
+		int nb_pixels = std::max(1, int(screen->size().x));
+
+		if(m_isXSorted)
+		{
+			float x_start = screen->fromGLScrnToWorldCoordinate(vec2(0,0)).x;
+			float x_end = screen->fromGLScrnToWorldCoordinate(vec2(nb_pixels,0)).x;
+			if(x_start > x_end) std::swap(x_start, x_end);
+
+			auto isBefore = [](const vec2& r, float x) {return r.x < x;};
+			first_idx = std::lower_bound(m_values.begin(), m_values.end(), x_start, isBefore) - m_values.begin();
+			last_idx = std::lower_bound(m_values.begin(), m_values.end(), x_end, isBefore) - m_values.begin();
+
+			first_idx = std::max(0, first_idx-1);
+			last_idx = std::min(nb_points-1, last_idx);
+		}
+
 		mat4 worldExtendedHom_matrix = screen->getWorldToExtendedHomMatrix();
 		m_program->useProgram(1);
 
-		gstd::myConnector<vec2>::connect(*m_program, string("R"), m_values_gv);
 		gstd::connectUniform(*m_program, "color_uni", &m_color);
 		gstd::connectUniform(*m_program, "scaling_matrix", &worldExtendedHom_matrix);
 
-		glDrawArrays(GL_LINE_STRIP, 0, nb_points);
+		//a few points per pixel at most : the raw samples are drawn, otherwise their min/max decimation,
+		//which only makes sense for samples sorted along x (an unsorted signal is always drawn entirely)
+		if(m_isXSorted == false || last_idx-first_idx+1 <= (1<<LOD_BASE_LEVEL)*nb_pixels)
+		{
+			gstd::myConnector<vec2>::connect(*m_program, string("R"), m_values_gv);
+			glDrawArrays(GL_LINE_STRIP, first_idx, last_idx-first_idx+1);
+		}
+		else _renderLod(screen, first_idx, last_idx);
+
         glFlush();
 
         m_program->useProgram(0);
     }
 }
 
-gstd::gVector<vec2> Signal::getValues_gv()
+void Signal::_renderLod(myGLObject* screen, int value_start_idx, int value_endIncluded_idx)
 {
-    return m_values_gv;
+	int nb_pixels = std::max(1, int(screen->size().x));
+	int nb_values = value_endIncluded_idx-value_start_idx+1;
+
+	//coarsest detail still giving about one bucket per pixel
+	int level = 0;
+	while(level < int(m_lod_vv.size())-1 && (1<<(LOD_BASE_LEVEL+level))*nb_pixels < nb_values) level++;
+
+	int first_bucket = value_start_idx >> (LOD_BASE_LEVEL+level);
+	int last_bucket = value_endIncluded_idx >> (LOD_BASE_LEVEL+level);
+
+	if(m_isLod_modified || level != m_lodDrawn_level ||
+	   first_bucket != m_lodDrawn_first || last_bucket != m_lodDrawn_last)
+	{
+		m_lod_v.clear();
+		for(int bucket_idx = first_bucket; bucket_idx <= last_bucket; bucket_idx++)
+		{
+			const myLodBucket& bucket = m_lod_vv[level][bucket_idx];
+
+			if(bucket.y_min_pt.x <= bucket.y_max_pt.x)
+			{
+				m_lod_v.push_back(bucket.y_min_pt);
+				m_lod_v.push_back(bucket.y_max_pt);
+			}
+			else
+			{
+				m_lod_v.push_back(bucket.y_max_pt);
+				m_lod_v.push_back(bucket.y_min_pt);
+			}
+		}
+
+		m_lod_gv.clear();
+		m_lod_gv.insert(0, m_lod_v);
+
+		m_lodDrawn_level = level;
+		m_lodDrawn_first = first_bucket;
+		m_lodDrawn_last = last_bucket;
+		m_isLod_modified = false;
+	}
+
+	gstd::myConnector<vec2>::connect(*m_program, string("R"), m_lod_gv);
+	glDrawArrays(GL_LINE_STRIP, 0, m_lod_v.size());
 }
 
-void Signal::computeContourRect()
+void Signal::_addToLod(int value_idx)
 {
-	int nb_values = m_values.size();
-	if(nb_values == m_nbPts_insideRect) return; //->
+	const vec2& value = m_values[value_idx];
+
+	if(value_idx != 0 && value.x < m_values[value_idx-1].x) m_isXSorted = false;
+	if(m_lod_vv.empty()) m_lod_vv.resize(1);
 
-	float max = numeric_limits<float>::max();
-		vec2 bottom_left(max, max);
-		vec2 top_right(-max, -max);
+	for(int level = 0; level < int(m_lod_vv.size()); level++)
+	{
+		vector<myLodBucket>& buckets_v = m_lod_vv[level];
+		int bucket_idx = value_idx >> (LOD_BASE_LEVEL+level);
+
+		if(bucket_idx == int(buckets_v.size())) buckets_v.push_back(makeLodBucket(value));
+		else mergeLodBuckets(buckets_v[bucket_idx], makeLodBucket(value));
+	}
 
-	if(m_nbPts_insideRect == 0)
+	//the last level always holds a single bucket covering the whole signal
+	if(m_lod_vv.back().size() == 2)
 	{
-		bottom_left = vec2(max, max);
-		top_right = vec2(-max, -max);
+		myLodBucket top_bucket = m_lod_vv.back()[0];
+		mergeLodBuckets(top_bucket, m_lod_vv.back()[1]);
+
+		m_lod_vv.push_back(vector<myLodBucket>(1, top_bucket));
 	}
-	else
+
+	m_isLod_modified = true;
+}
+
+void Signal::_updateLod(int value_idx)
+{
+	if(m_lod_vv.empty()) return; //->
+
+	//level 0 from the samples, the next ones from the two buckets below
+	int bucket_idx = value_idx >> LOD_BASE_LEVEL;
+	int start_idx = bucket_idx << LOD_BASE_LEVEL;
+	int end_idx = std::min(int(m_values.size()), (bucket_idx+1) << LOD_BASE_LEVEL);
+
+	myLodBucket bucket = makeLodBucket(m_values[start_idx]);
+	for(int idx = start_idx+1; idx < end_idx; idx++) mergeLodBuckets(bucket, makeLodBucket(m_values[idx]));
+	m_lod_vv[0][bucket_idx] = bucket;
+
+	for(int level = 1; level < int(m_lod_vv.size()); level++)
 	{
-		bottom_left = m_contour_rect->getBottomLeft();
-		top_right = m_contour_rect->getTopRight();
+		bucket_idx = value_idx >> (LOD_BASE_LEVEL+level);
+
+		const vector<myLodBucket>& lower_v = m_lod_vv[level-1];
+		bucket = lower_v[2*bucket_idx];
+		if(2*bucket_idx+1 < int(lower_v.size())) mergeLodBuckets(bucket, lower_v[2*bucket_idx+1]);
+
+		m_lod_vv[level][bucket_idx] = bucket;
 	}
 
-	for(int value_idx = m_nbPts_insideRect; value_idx <= nb_values-1; value_idx++)
+	m_isLod_modified = true;
+}
+
+void Signal::_clearLod()
+{
+	m_lod_vv.clear();
+	m_lod_v.clear();
+	m_lodDrawn_level = -1;
+	m_lodDrawn_first = -1;
+	m_lodDrawn_last = -1;
+	m_isLod_modified = true;
+}
+
+bool Signal::getBounds(int value_start_idx, int value_endIncluded_idx, vec2& bottom_left, vec2& top_right)
+{
+	if(value_start_idx < 0 || value_endIncluded_idx >= int(m_values.size()) || value_start_idx > value_endIncluded_idx)
 	{
-		if(m_values[value_idx].x <= bottom_left.x) bottom_left.x = m_values[value_idx].x;
-		if(m_values[value_idx].y <= bottom_left.y) bottom_left.y = m_values[value_idx].y;
+		return false; //->
+	}
 
-		if(m_values[value_idx].x >= top_right.x) top_right.x = m_values[value_idx].x;
-		if(m_values[value_idx].y >= top_right.y) top_right.y = m_values[value_idx].y;
+	//largest aligned buckets fitting in the range, the samples at both ends one by one
+	myLodBucket bounds = makeLodBucket(m_values[value_start_idx]);
+	int value_idx = value_start_idx;
+	while(value_idx <= value_endIncluded_idx)
+	{
+		int level = int(m_lod_vv.size())-1;
+		for(; level >= 0; level--)
+		{
+			int bucket_size = 1<<(LOD_BASE_LEVEL+level);
+			if(value_idx % bucket_size == 0 && value_idx+bucket_size-1 <= value_endIncluded_idx) break;
+		}
+
+		if(level >= 0)
+		{
+			mergeLodBuckets(bounds, m_lod_vv[level][value_idx >> (LOD_BASE_LEVEL+level)]);
+			value_idx += 1<<(LOD_BASE_LEVEL+level);
+		}
+		else
+		{
+			mergeLodBuckets(bounds, makeLodBucket(m_values[value_idx]));
+			value_idx++;
+		}
 	}
 
-	m_contour_rect->setDiag(bottom_left, top_right);
+	bottom_left = bounds.bottom_left;
+	top_right = bounds.top_right;
+	return true;
+}
+
+gstd::gVector<vec2> Signal::getValues_gv()
+{
+    return m_values_gv;
+}
+
+void Signal::computeContourRect()
+{
+	int nb_values = m_values.size();
+	if(nb_values == m_nbPts_insideRect) return; //->
+
+	//the last lod level holds the bounds of the whole signal
+	const myLodBucket& top_bucket = m_lod_vv.back()[0];
+	m_contour_rect->setDiag(top_bucket.bottom_left, top_bucket.top_right);
 	m_nbPts_insideRect = m_values.size();
 }
 
@@ -46,6 +46,15 @@
 	#include "glGUI/glObjects/myGLObject.h"
 
 
+//bounds of a block of consecutive samples, and its lowest and highest samples
+struct myLodBucket
+{
+	glm::vec2 bottom_left;
+	glm::vec2 top_right;
+	glm::vec2 y_min_pt;
+	glm::vec2 y_max_pt;
+};
+
 class CELLENGINE_LIBRARYSHARED_EXPORT Signal: public myGLObject
 {
 public :
@@ -58,8 +67,9 @@ public :
     long getSize();
 	vector<glm::vec2> getValues_v(int value_start_idx, int value_endIncluded_idx);
 	gstd::gVector<glm::vec2> getValues_gv();
-	vector<glm::vec2>& getValuesRef_v();
+	vector<glm::vec2>& getValuesRef_v(); //read only, writing through it bypasses the lod pyramid
 	myRectangle& getRectangleContour();
+	bool getBounds(int value_start_idx, int value_endIncluded_idx, glm::vec2& bottom_left, glm::vec2& top_right);
 	float getMean();
 
 	void setColor(glm::vec4 color);
@@ -84,11 +94,28 @@ protected :
 
 private:
 
+	void _addToLod(int value_idx);
+	void _updateLod(int value_idx);
+	void _clearLod();
+	void _renderLod(myGLObject* screen, int value_start_idx, int value_endIncluded_idx);
+
 	vector<glm::vec2> m_values;
 	glm::vec4 m_color;
+	bool m_isXSorted; //x never decreases, the visible samples are then a contiguous range
+
+//level of detail : level l gathers the samples by blocks of 2^(LOD_BASE_LEVEL+l),
+//each level being updated as the values are appended, the last one holding a single bucket
+	static const int LOD_BASE_LEVEL = 4;
+	vector<vector<myLodBucket> > m_lod_vv;
+		vector<glm::vec2> m_lod_v; //decimated strip currently in m_lod_gv
+		int m_lodDrawn_level;
+		int m_lodDrawn_first;
+		int m_lodDrawn_last;
+		bool m_isLod_modified;
 
 //GPU Memory Data
 	gstd::gVector<glm::vec2> m_values_gv;
+	gstd::gVector<glm::vec2> m_lod_gv;
     gstd::gProgram* m_program;
         bool m_isProgram_set;
 
@@ -0,0 +1,313 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+
+
+#include "algorithm"
+#include "cmath"
+#include "fstream"
+#include "iostream"
+#include "limits"
+
+#include "StatsAccumulator.h"
+
+using namespace std;
+
+
+StatsAccumulator::StatsAccumulator(int nb_bins, float min_value, float max_value, BIN_SCALE scale, int sketch_size)
+{
+	m_scale = scale;
+	m_sketch_size = 2*((std::max(0, sketch_size) + 1)/2); //even, a full level is then exactly halved
+	m_compactionParity = false;
+	m_isLastBinClosed = false;
+
+	setBins(nb_bins, min_value, max_value);
+	clear();
+}
+
+void StatsAccumulator::setBins(int nb_bins, float min_value, float max_value)
+{
+	nb_bins = std::max(0, nb_bins);
+
+	m_bins_min = min_value;
+	m_bins_max = max_value;
+	m_bins_invWidth = (max_value > min_value) ? nb_bins/(max_value - min_value) : 0.0f;
+
+	//same float expressions as dataBiner, a value falls in the same bins
+	m_binStarts_v.resize(nb_bins);
+	m_binEnds_v.resize(nb_bins);
+	for(int bin_idx = 0; bin_idx <= nb_bins-1; bin_idx++)
+	{
+		m_binStarts_v[bin_idx] = min_value + bin_idx*(max_value - min_value)/nb_bins;
+		m_binEnds_v[bin_idx] = m_binStarts_v[bin_idx] + (max_value - min_value)/nb_bins;
+	}
+	m_binCounts_v.assign(nb_bins, 0);
+}
+
+void StatsAccumulator::setLastBinClosed(bool isLastBinClosed)
+{
+	m_isLastBinClosed = isLastBinClosed;
+	m_binCounts_v.assign(m_binCounts_v.size(), 0);
+}
+
+void StatsAccumulator::setScale(BIN_SCALE scale)
+{
+	m_scale = scale;
+	clear();
+}
+
+void StatsAccumulator::clear()
+{
+	m_count = 0;
+	m_nbRejected = 0;
+	m_min = std::numeric_limits<float>::max();
+	m_max = std::numeric_limits<float>::lowest();
+	m_mean = 0.0;
+	m_M2 = 0.0;
+
+	m_binCounts_v.assign(m_binCounts_v.size(), 0);
+	m_sketchLevels_vv.clear();
+	m_compactionParity = false;
+}
+
+void StatsAccumulator::addValue(float value)
+{
+	if(m_scale == LOG_BINS)
+	{
+		if((value > 0.0f) == false)
+		{
+			m_nbRejected++;
+			return; //->
+		}
+		value = log10(value);
+	}
+	if(std::isfinite(value) == false)
+	{
+		m_nbRejected++;
+		return; //->
+	}
+
+	//moments (Welford)
+	m_count++;
+	double delta = value - m_mean;
+	m_mean += delta/m_count;
+	m_M2 += delta*(value - m_mean);
+	m_min = std::min(m_min, value);
+	m_max = std::max(m_max, value);
+
+	//histogram : the bin is guessed and its neighbours are checked with the dataBiner bounds
+	int nb_bins = m_binCounts_v.size();
+	if(nb_bins != 0)
+	{
+		double bin_pos = double(value - m_bins_min)*m_bins_invWidth;
+		if(bin_pos >= -1.0 && bin_pos <= nb_bins + 1.0)
+		{
+			int bin_idx = int(floor(bin_pos));
+			for(int neighbour_idx = std::max(0, bin_idx-1); neighbour_idx <= std::min(nb_bins-1, bin_idx+1); neighbour_idx++)
+			{
+				bool isClosed = m_isLastBinClosed && neighbour_idx == nb_bins-1;
+				float bin_end = isClosed ? std::max(m_binEnds_v[neighbour_idx], m_bins_max) : m_binEnds_v[neighbour_idx];
+
+				if(value >= m_binStarts_v[neighbour_idx] && (value < bin_end || (isClosed && value == bin_end))) m_binCounts_v[neighbour_idx]++;
+			}
+		}
+	}
+
+	//quantile sketch
+	if(m_sketch_size != 0)
+	{
+		if(m_sketchLevels_vv.empty()) m_sketchLevels_vv.resize(1);
+		m_sketchLevels_vv[0].push_back(value);
+		if(int(m_sketchLevels_vv[0].size()) >= m_sketch_size) _compactLevel(0);
+	}
+}
+
+void StatsAccumulator::_compactLevel(int level_idx)
+{
+	if(int(m_sketchLevels_vv.size()) <= level_idx+1) m_sketchLevels_vv.resize(level_idx+2);
+
+	//one value out of two is kept with a doubled weight, alternating the kept half between compactions
+	vector<float>& level = m_sketchLevels_vv[level_idx];
+	vector<float>& next_level = m_sketchLevels_vv[level_idx+1];
+
+	//an odd leftover stays in the level with its weight, alternately the smallest and the largest value
+	sort(level.begin(), level.end());
+	bool isOdd = (level.size()%2 == 1);
+	float leftover_value = 0.0f;
+	if(isOdd)
+	{
+		leftover_value = m_compactionParity ? level.back() : level.front();
+		if(m_compactionParity) level.pop_back();
+		else level.erase(level.begin());
+	}
+
+	for(int value_idx = (m_compactionParity ? 1 : 0); value_idx < int(level.size()); value_idx += 2)
+	{
+		next_level.push_back(level[value_idx]);
+	}
+	m_compactionParity = !m_compactionParity;
+	level.clear();
+	if(isOdd) level.push_back(leftover_value);
+
+	if(int(m_sketchLevels_vv[level_idx+1].size()) >= m_sketch_size) _compactLevel(level_idx+1);
+}
+
+void StatsAccumulator::merge(const StatsAccumulator& stats)
+{
+	if(stats.m_scale != m_scale || stats.m_binCounts_v.size() != m_binCounts_v.size() ||
+	   stats.m_bins_min != m_bins_min || stats.m_bins_max != m_bins_max || stats.m_isLastBinClosed != m_isLastBinClosed)
+	{
+		cout<<"In StatsAccumulator::merge : error (the accumulators have different bins)\n";
+		return; //->
+	}
+
+	m_nbRejected += stats.m_nbRejected;
+	if(stats.m_count == 0) return; //->
+
+	//moments (Chan et al. pairwise update)
+	long long count = m_count + stats.m_count;
+	double delta = stats.m_mean - m_mean;
+	m_mean += delta*stats.m_count/count;
+	m_M2 += stats.m_M2 + delta*delta*double(m_count)*double(stats.m_count)/count;
+	m_count = count;
+	m_min = std::min(m_min, stats.m_min);
+	m_max = std::max(m_max, stats.m_max);
+
+	for(int bin_idx = 0; bin_idx < int(m_binCounts_v.size()); bin_idx++) m_binCounts_v[bin_idx] += stats.m_binCounts_v[bin_idx];
+
+	if(m_sketch_size != 0)
+	{
+		if(m_sketchLevels_vv.size() < stats.m_sketchLevels_vv.size()) m_sketchLevels_vv.resize(stats.m_sketchLevels_vv.size());
+		for(int level_idx = 0; level_idx < int(stats.m_sketchLevels_vv.size()); level_idx++)
+		{
+			const vector<float>& level = stats.m_sketchLevels_vv[level_idx];
+			m_sketchLevels_vv[level_idx].insert(m_sketchLevels_vv[level_idx].end(), level.begin(), level.end());
+		}
+
+		for(int level_idx = 0; level_idx < int(m_sketchLevels_vv.size()); level_idx++)
+		{
+			if(int(m_sketchLevels_vv[level_idx].size()) >= m_sketch_size) _compactLevel(level_idx);
+		}
+	}
+}
+
+StatsAccumulator::BIN_SCALE StatsAccumulator::getScale() const
+{
+	return m_scale;
+}
+
+long long StatsAccumulator::getCount() const
+{
+	return m_count;
+}
+
+long long StatsAccumulator::getNbRejected() const
+{
+	return m_nbRejected;
+}
+
+float StatsAccumulator::getMin() const
+{
+	return (m_count == 0) ? 0.0f : m_min;
+}
+
+float StatsAccumulator::getMax() const
+{
+	return (m_count == 0) ? 0.0f : m_max;
+}
+
+double StatsAccumulator::getMean() const
+{
+	return m_mean;
+}
+
+double StatsAccumulator::getVariance() const
+{
+	return (m_count <= 1) ? 0.0 : m_M2/(m_count - 1);
+}
+
+float StatsAccumulator::getQuantile(float q) const
+{
+	vector<pair<float, long long> > weightedValues_v;
+	long long total_weight = 0;
+	for(int level_idx = 0; level_idx < int(m_sketchLevels_vv.size()); level_idx++)
+	{
+		long long weight = 1LL<<level_idx;
+		for(float value : m_sketchLevels_vv[level_idx])
+		{
+			weightedValues_v.push_back({value, weight});
+			total_weight += weight;
+		}
+	}
+	if(weightedValues_v.empty()) return 0.0f; //->
+
+	sort(weightedValues_v.begin(), weightedValues_v.end());
+
+	double target_weight = std::min(1.0f, std::max(0.0f, q))*total_weight;
+	long long cumulated_weight = 0;
+	for(auto& weighted_value : weightedValues_v)
+	{
+		cumulated_weight += weighted_value.second;
+		if(cumulated_weight >= target_weight) return weighted_value.first; //->
+	}
+
+	return weightedValues_v.back().first;
+}
+
+int StatsAccumulator::getNbBins() const
+{
+	return m_binCounts_v.size();
+}
+
+float StatsAccumulator::getBinStart(int bin_idx) const
+{
+	return m_binStarts_v[bin_idx];
+}
+
+long long StatsAccumulator::getBinCount(int bin_idx) const
+{
+	return m_binCounts_v[bin_idx];
+}
+
+void StatsAccumulator::getHistogram(vector<pair<float, int> >& data_out) const
+{
+	for(int bin_idx = 0; bin_idx < int(m_binCounts_v.size()); bin_idx++)
+	{
+		data_out.push_back(pair<float, int>(m_binStarts_v[bin_idx], m_binCounts_v[bin_idx]));
+	}
+}
+
+bool StatsAccumulator::saveHistogramAsString(string file_path) const
+{
+	ofstream myfile;
+	myfile.open(file_path);
+	if(myfile.is_open() == false) return false; //->
+
+	for(int bin_idx = 0; bin_idx < int(m_binCounts_v.size()); bin_idx++)
+	{
+		myfile<<m_binStarts_v[bin_idx];
+		myfile<<'\t';
+		myfile<<m_binCounts_v[bin_idx];
+		myfile<<'\n';
+	}
+	myfile.close();
+
+	return true;
+}
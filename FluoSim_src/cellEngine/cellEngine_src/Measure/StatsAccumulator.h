@@ -0,0 +1,106 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+
+
+#ifndef STATSACCUMULATOR_H
+#define STATSACCUMULATOR_H
+
+#include "string"
+#include "utility"
+#include "vector"
+
+#include "cellEngine_library_global.h"
+
+
+//single pass statistics of a stream of values : count, extrema, mean and variance, fixed-bin histogram
+//and an approximate quantile sketch, in a memory that does not depend on the number of values.
+//	- LOG_BINS : the values are accumulated as log10(value), non-positive values are rejected,
+//	  the bins bounds and all the statistics are then expressed in decades,
+//	- the bins follow dataBiner (type 0) : bin i covers [start_i, start_i + width[,
+//	  the last bin can be closed to also count the upper bound (range taken from the values),
+//	- accumulators with the same bins can be merged (e.g. one per thread, reduced at the end).
+
+class CELLENGINE_LIBRARYSHARED_EXPORT StatsAccumulator
+{
+public :
+
+	enum BIN_SCALE {LINEAR_BINS, LOG_BINS};
+
+	//nb_bins = 0 : no histogram, sketch_size = 0 : no quantile sketch
+	StatsAccumulator(int nb_bins = 0, float min_value = 0, float max_value = 1,
+					 BIN_SCALE scale = LINEAR_BINS, int sketch_size = 128);
+
+	void setBins(int nb_bins, float min_value, float max_value); //the counts are reset
+	void setLastBinClosed(bool isLastBinClosed); //the counts are reset
+	void setScale(BIN_SCALE scale); //the accumulator is cleared
+	void clear(); //the bins are kept
+
+	void addValue(float value);
+	void merge(const StatsAccumulator& stats);
+
+	BIN_SCALE getScale() const;
+	long long getCount() const;
+	long long getNbRejected() const;
+	float getMin() const;
+	float getMax() const;
+	double getMean() const;
+	double getVariance() const;
+	float getQuantile(float q) const; //q in [0,1], rank error of about 1/sketch_size
+
+	int getNbBins() const;
+	float getBinStart(int bin_idx) const;
+	long long getBinCount(int bin_idx) const;
+	void getHistogram(std::vector<std::pair<float, int> >& data_out) const; //same layout as dataBiner
+	bool saveHistogramAsString(std::string file_path) const;
+
+private :
+
+	void _compactLevel(int level_idx);
+
+private :
+
+	BIN_SCALE m_scale;
+
+//moments
+	long long m_count;
+	long long m_nbRejected;
+	float m_min;
+	float m_max;
+	double m_mean;
+	double m_M2; //sum of the squared deviations to the mean
+
+//histogram
+	float m_bins_min;
+	float m_bins_max;
+	float m_bins_invWidth;
+	std::vector<float> m_binStarts_v;
+	std::vector<float> m_binEnds_v;
+	std::vector<long long> m_binCounts_v;
+	bool m_isLastBinClosed;
+
+//quantile sketch : the values of level h stand for 2^h values, a full level is halved into the next one
+	int m_sketch_size;
+	std::vector<std::vector<float> > m_sketchLevels_vv;
+	bool m_compactionParity;
+};
+
+
+#endif // STATSACCUMULATOR_H
@@ -21,7 +21,15 @@
 
 
 
+#include "atomic"
+#include "functional"
+#include "random"
+
 #include "Trace.h"
+    #include "StatsAccumulator.h"
+
+#include "toolBox_src/toolbox_library_global.h"
+    #include "toolBox_src/parallelTools/myWorkStealingPool.h"
 
 
 using namespace std;
@@ -33,6 +41,25 @@ double linear(double t, const double* coef)
 	return coef[0] + coef[1]*t;
 }
 
+static vec4 getRandomColor(float alpha)
+{
+	//one generator per thread : the traces are created by several workers (e.g. TraceBatchAnalyser)
+	static std::atomic<unsigned int> nb_generators(0);
+	thread_local std::minstd_rand generator = []()
+	{
+		std::seed_seq seed_sequence{(unsigned int) std::minstd_rand::default_seed, nb_generators++};
+		unsigned int generator_seed;
+		seed_sequence.generate(&generator_seed, &generator_seed + 1);
+		return std::minstd_rand(generator_seed);
+	}();
+
+	std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+	float r = distribution(generator);
+	float g = distribution(generator);
+	float b = distribution(generator);
+	return vec4(r, g, b, alpha);
+}
+
 /********************************
  *
  *			Class Trace
@@ -52,11 +79,7 @@ Trace::Trace()
 	m_Dplane_in_seconds = -1;
 
 	m_color_mode = UNIQUE_COLOR_MODE;
-	float r,g,b;
-	r = uniformDistributiion(0.0f,1.0f);
-	g = uniformDistributiion(0.0f,1.0f);
-	b = uniformDistributiion(0.0f,1.0f);
-	m_unique_color = vec4(r,g,b,1.0);
+	m_unique_color = getRandomColor(1.0);
 	m_external_color = vec4(1.0,1.0,1.0,1.0);
 
 	m_is_filtered = 0;
@@ -75,6 +98,16 @@ void Trace::addFluoEvent(FluoEvent event)
 	m_MSD_maxDPlane = -1;
 }
 
+void Trace::setFluoEventVector(vector<FluoEvent>&& events_v)
+{
+	m_fluo_events = std::move(events_v);
+
+	m_isMSDCalculated = false;
+	m_isDCalculated = false;
+	m_is_DinstCalculated = false;
+	m_MSD_maxDPlane = -1;
+}
+
 void Trace::setX(float x, int event_idx)
 {
 	if(event_idx < m_fluo_events.size()) m_fluo_events[event_idx].x = x;
@@ -117,24 +150,20 @@ void Trace::setColorMode(COLOR_MODE color_mode)
 
 void Trace::changeColor()
 {
-	float r,g,b;
-	r = uniformDistributiion(0.0f,1.0);
-	g = uniformDistributiion(0.0f,1.0);
-	b = uniformDistributiion(0.0f,1.0);
-	m_unique_color = vec4(r,g,b,0.0);
+	m_unique_color = getRandomColor(0.0);
 }
 
-FluoEvent Trace::getFluoEvent(int i)
+FluoEvent Trace::getFluoEvent(int i) const
 {
 	if(i < m_fluo_events.size()) return m_fluo_events[i];
 }
 
-FluoEvent Trace::getLastEvent()
+FluoEvent Trace::getLastEvent() const
 {
 	return m_fluo_events.back();
 }
 
-FluoEvent Trace::getFirstEvent()
+FluoEvent Trace::getFirstEvent() const
 {
 	return m_fluo_events.front();
 }
@@ -154,7 +183,7 @@ void Trace::clearFluoEventVector()
 	m_fluo_events.clear();
 }
 
-int Trace::getLength()
+int Trace::getLength() const
 {
 	return m_fluo_events.size();
 }
@@ -176,7 +205,7 @@ vec2 Trace::getBarycenter()
 
 }
 
-vec4 Trace::getColor()
+vec4 Trace::getColor() const
 {
 	vec4 color;
 	switch(m_color_mode)
@@ -196,17 +225,27 @@ vec4 Trace::getColor()
 	return color;
 }
 
+vec4 Trace::getUniqueColor() const
+{
+	return m_unique_color;
+}
+
 vector<vec4>& Trace::getColors()
 {
 	return m_external_colors_v;
 }
 
-Trace::COLOR_MODE Trace::getColorMode()
+const vector<vec4>& Trace::getColors() const
+{
+	return m_external_colors_v;
+}
+
+Trace::COLOR_MODE Trace::getColorMode() const
 {
 	return m_color_mode;
 }
 
-float Trace::getD()
+float Trace::getD() const
 {
 	return m_D;
 }
@@ -221,27 +260,32 @@ std::vector<double>& Trace::getMSDs()
 	return m_MSD_v;
 }
 
-const std::vector<float>& Trace::getDInsts()
+const std::vector<double>& Trace::getMSDs() const
+{
+	return m_MSD_v;
+}
+
+const std::vector<float>& Trace::getDInsts() const
 {
 	return m_Dinst_v;
 }
 
-int Trace::getTraceIdx()
+int Trace::getTraceIdx() const
 {
 	return m_trc_idx;
 }
 
-bool Trace::isMSDCalculated()
+bool Trace::isMSDCalculated() const
 {
 	return m_isMSDCalculated;
 }
 
-bool Trace::isDCalculated()
+bool Trace::isDCalculated() const
 {
 	return m_isDCalculated;
 }
 
-bool Trace::isDInstCalculated()
+bool Trace::isDInstCalculated() const
 {
 	return m_is_DinstCalculated;
 }
@@ -480,12 +524,9 @@ void Trace::computeDInst(float pxlSize_in_um, float Dplane_in_seconds,
 
 
 
-void Trace::elongateTrc(Trace& toBe_added_trc)
+void Trace::elongateTrc(const Trace& toBe_added_trc)
 {
-	for(int fluoEvent_idx = 0; fluoEvent_idx <= toBe_added_trc.getLength()-1; fluoEvent_idx++)
-	{
-		m_fluo_events.push_back(toBe_added_trc.getFluoEvent(fluoEvent_idx));
-	}
+	m_fluo_events.insert(m_fluo_events.end(), toBe_added_trc.m_fluo_events.begin(), toBe_added_trc.m_fluo_events.end());
 }
 
 Trace Trace::getElongatedTrace(Trace& toBe_added_trc)
@@ -528,7 +569,7 @@ int Trace::findClosestTrace(vector<Trace> & traces, int starting_idx, int min_de
 
 
 
-bool Trace::isConnectable(Trace trace, int min_delay, int max_delay, float max_distance, float* distance_out)
+bool Trace::isConnectable(const Trace& trace, int min_delay, int max_delay, float max_distance, float* distance_out) const
 {
 	// *this is considered as a - trace and is checked if connected to a + trace.
 	// the associated reaction is  - operator(+) + -> -+
@@ -939,8 +980,22 @@ vector<Trace> loadTracesAsBinary(string file)
 
 }
 
+//identity view : the exports of a whole vector go through the indexed ones
+static vector<int> _getAllTracesIdx(const vector<Trace>& traces)
+{
+	vector<int> trc_idx_v(traces.size());
+	for(int trc_idx = 0; trc_idx <= int(traces.size())-1; trc_idx++) trc_idx_v[trc_idx] = trc_idx;
+	return trc_idx_v;
+}
+
 void saveTracesAsString(vector<Trace> &traces, string file_directory, FLUOEVENT_FILE_FORMAT format, float dt,
 						QProgressBar* progressBar, float px)
+{
+	saveTracesAsString(traces, _getAllTracesIdx(traces), file_directory, format, dt, progressBar, px);
+}
+
+void saveTracesAsString(const vector<Trace> &traces, const vector<int>& trc_idx_v, string file_directory,
+						FLUOEVENT_FILE_FORMAT format, float dt, QProgressBar* progressBar, float px)
 {
 	switch(format)
 	{
@@ -955,15 +1010,16 @@ void saveTracesAsString(vector<Trace> &traces, string file_directory, FLUOEVENT_
 			myfile.open(file_directory);
 
 			string a;
-			int n_trc = traces.size();
+			int n_trc = trc_idx_v.size();
 			FluoEvent fluo_event;
 			for(int trc_idx = 0; trc_idx <= n_trc-1; trc_idx++)
 			{
-				int n_fluo_event = traces[trc_idx].getLength();
+				const Trace& trc = traces[trc_idx_v[trc_idx]];
+				int n_fluo_event = trc.getLength();
 
 				for(int fluo_idx = 0; fluo_idx<=n_fluo_event-1; fluo_idx++)
 				{
-					fluo_event = traces[trc_idx].getFluoEvent(fluo_idx);
+					fluo_event = trc.getFluoEvent(fluo_idx);
 					getDataStr(fluo_event, a, trc_idx+1, false, format, dt, px);
 					if(a.size() > 8*1024*1024)
 					{
@@ -988,7 +1044,7 @@ void saveTracesAsString(vector<Trace> &traces, string file_directory, FLUOEVENT_
 			ofstream myfile;
 			myfile.open(file_directory);
 
-			int n_trc = traces.size();
+			int n_trc = trc_idx_v.size();
 			FluoEvent fluo_event;
 
 			myfile<<"<svg width=\"400\" height=\"400\">\n";
@@ -1000,8 +1056,8 @@ void saveTracesAsString(vector<Trace> &traces, string file_directory, FLUOEVENT_
 
 			for(int trc_idx = 0; trc_idx <= n_trc-1; trc_idx++)
 			{
-				Trace& trc = traces[trc_idx];
-				int n_fluo_event = traces[trc_idx].getLength();
+				const Trace& trc = traces[trc_idx_v[trc_idx]];
+				int n_fluo_event = trc.getLength();
 				if(n_fluo_event >= 2)
 				{
 
@@ -1009,7 +1065,7 @@ void saveTracesAsString(vector<Trace> &traces, string file_directory, FLUOEVENT_
 
 					for(int fluo_idx = 0; fluo_idx<=n_fluo_event-1; fluo_idx++)
 					{
-						fluo_event = traces[trc_idx].getFluoEvent(fluo_idx);
+						fluo_event = trc.getFluoEvent(fluo_idx);
 						myfile<<fluo_event.x<<","<<fluo_event.y<<" ";
 					}
 
@@ -1050,7 +1106,7 @@ void saveTracesAsString(vector<Trace> &traces, string file_directory, FLUOEVENT_
 			ofstream myfile;
 			myfile.open(file_directory);
 
-			int n_trc = traces.size();
+			int n_trc = trc_idx_v.size();
 			FluoEvent fluo_event1, fluo_event2;
 
 			myfile<<"<svg width=\"400\" height=\"400\">\n";
@@ -1062,16 +1118,16 @@ void saveTracesAsString(vector<Trace> &traces, string file_directory, FLUOEVENT_
 
 			for(int trc_idx = 0; trc_idx <= n_trc-1; trc_idx++)
 			{
-				Trace& trc = traces[trc_idx];
-				int n_fluo_event = traces[trc_idx].getLength();
+				const Trace& trc = traces[trc_idx_v[trc_idx]];
+				int n_fluo_event = trc.getLength();
 				if(n_fluo_event >= 2)
 				{
 
 					myfile<<" <svg>\n";
 					for(int fluo_idx = 0; fluo_idx<=n_fluo_event-1-1; fluo_idx++)
 					{
-						fluo_event1 = traces[trc_idx].getFluoEvent(fluo_idx);
-						fluo_event2 = traces[trc_idx].getFluoEvent(fluo_idx+1);
+						fluo_event1 = trc.getFluoEvent(fluo_idx);
+						fluo_event2 = trc.getFluoEvent(fluo_idx+1);
 
 						char digit[2] = "0";
 						char fluoEvent_red[3] = "00", fluoEvent_green[3] = "00", fluoEvent_blue[3] = "00";
@@ -1145,6 +1201,12 @@ void saveTracesAsBinary(vector<Trace> &traces, string file_directory)
 
 
 void saveTracesDsAsString(std::vector<Trace> &traces, std::string file_dir, bool isVertical, bool isAppended)
+{
+	saveTracesDsAsString(traces, _getAllTracesIdx(traces), file_dir, isVertical, isAppended);
+}
+
+void saveTracesDsAsString(const std::vector<Trace> &traces, const std::vector<int>& trc_idx_v, std::string file_dir,
+						  bool isVertical, bool isAppended)
 {
 	ofstream myfile;
 	if(isAppended == true) myfile.open(file_dir, ios_base::app);
@@ -1153,11 +1215,11 @@ void saveTracesDsAsString(std::vector<Trace> &traces, std::string file_dir, bool
 
 	if(isVertical == true)
 	{
-		for(Trace& trace : traces)
+		for(int trc_idx : trc_idx_v)
 		{
-//			myfile<<trace.getTraceIdx()<<'\t';
-//			myfile<<trace.getLength()<<'\t';
-			myfile<<trace.getD()<<'\n';
+//			myfile<<traces[trc_idx].getTraceIdx()<<'\t';
+//			myfile<<traces[trc_idx].getLength()<<'\t';
+			myfile<<traces[trc_idx].getD()<<'\n';
 		}
 	}
 	else
@@ -1174,9 +1236,9 @@ void saveTracesDsAsString(std::vector<Trace> &traces, std::string file_dir, bool
 //		}
 //		myfile<<"\n";
 
-		for(Trace& trace : traces)
+		for(int trc_idx : trc_idx_v)
 		{
-			myfile<<trace.getD()<<'\t';
+			myfile<<traces[trc_idx].getD()<<'\t';
 		}
 		myfile<<"\n";
 	}
@@ -1184,16 +1246,22 @@ void saveTracesDsAsString(std::vector<Trace> &traces, std::string file_dir, bool
 }
 
 void saveTracesDInstsAsString(std::vector<Trace> &traces, std::string file_dir)
+{
+	saveTracesDInstsAsString(traces, _getAllTracesIdx(traces), file_dir);
+}
+
+void saveTracesDInstsAsString(const std::vector<Trace> &traces, const std::vector<int>& trc_idx_v, std::string file_dir)
 {
 	ofstream myfile;
 	myfile.open(file_dir);
 	if(myfile.is_open() == false) return; //->
 
-	int n_trc = traces.size();
+	int n_trc = trc_idx_v.size();
 	for(int trc_idx = 0; trc_idx <= n_trc-1; trc_idx++)
 	{
-		if(traces[trc_idx].isDInstCalculated() == false) continue; //|_>
-		const std::vector<float> DInsts_v = traces[trc_idx].getDInsts();
+		const Trace& trc = traces[trc_idx_v[trc_idx]];
+		if(trc.isDInstCalculated() == false) continue; //|_>
+		const std::vector<float>& DInsts_v = trc.getDInsts();
 
 		myfile<<trc_idx+1<<'\t';
 		int size = DInsts_v.size();
@@ -1230,14 +1298,20 @@ void saveTracesDInstsPulledAsString(std::vector<Trace> &traces, std::string file
 
 void saveTracesMSDsAsString(std::vector<Trace> &traces, std::string file_dir, bool isAppended)
 {
+	saveTracesMSDsAsString(traces, _getAllTracesIdx(traces), file_dir, isAppended);
+}
 
+void saveTracesMSDsAsString(const std::vector<Trace> &traces, const std::vector<int>& trc_idx_v, std::string file_dir,
+							bool isAppended)
+{
 	ofstream myfile;
 	if(isAppended == true) myfile.open(file_dir, ios_base::app);
 	else myfile.open(file_dir);
 	if(myfile.is_open() == false) return; //->
 
-	for(Trace& trace : traces)
+	for(int trc_idx : trc_idx_v)
 	{
+		const Trace& trace = traces[trc_idx];
 		if(trace.isMSDCalculated() == false) continue; //|_>
 
 		myfile<<trace.getTraceIdx()<<'\t';//trace_idx
@@ -1255,47 +1329,90 @@ void saveTracesMSDsAsString(std::vector<Trace> &traces, std::string file_dir, bo
 	myfile.close();
 }
 
+//one accumulator per worker over blocks of the indexed traces, merged into stats : no copy of the values is made
+static void _accumulateTraces(const vector<Trace>& traces, const vector<int>& trc_idx_v, StatsAccumulator& stats,
+							  const function<void(const Trace&, StatsAccumulator&)>& accumulate)
+{
+	const int nb_traces_perTask = 1024;
+	int nb_traces = trc_idx_v.size();
+	int nb_tasks = (nb_traces + nb_traces_perTask-1)/nb_traces_perTask;
+
+	myWorkStealingPool pool(nb_traces < 10000 ? 1 : 0);
+
+	StatsAccumulator empty_stats = stats;
+		empty_stats.clear();
+	vector<StatsAccumulator> workersStats_v(pool.getNbWorkers(), empty_stats);
+
+	pool.run(nb_tasks, [&](int task_idx, int worker_idx)
+	{
+		int last_trc = std::min(nb_traces, (task_idx+1)*nb_traces_perTask);
+		for(int view_idx = task_idx*nb_traces_perTask; view_idx < last_trc; view_idx++)
+		{
+			accumulate(traces[trc_idx_v[view_idx]], workersStats_v[worker_idx]);
+		}
+	});
+
+	for(StatsAccumulator& worker_stats : workersStats_v) stats.merge(worker_stats);
+}
+
+static void _saveTracesHistogramAsString(const vector<Trace>& traces, const vector<int>& trc_idx_v, string file_dir,
+										 int nb_intervals, float min_value, float max_value, StatsAccumulator::BIN_SCALE scale,
+										 const function<void(const Trace&, StatsAccumulator&)>& accumulate)
+{
+	//the range is taken from the values : one more pass, still without storing them
+	bool isRangeFromValues = (min_value == -1 && max_value == -1);
+	if(isRangeFromValues)
+	{
+		StatsAccumulator range_stats(0, 0, 1, scale, 0);
+		_accumulateTraces(traces, trc_idx_v, range_stats, accumulate);
+
+		min_value = range_stats.getMin();
+		max_value = range_stats.getMax();
+	}
+
+	//the largest value is the upper bound : the last bin is closed so that it is counted
+	StatsAccumulator stats(nb_intervals, min_value, max_value, scale, 0);
+	stats.setLastBinClosed(isRangeFromValues);
+	_accumulateTraces(traces, trc_idx_v, stats, accumulate);
+	stats.saveHistogramAsString(file_dir);
+}
+
 void saveTracesLogDsHistogramAsString(std::vector<Trace> &traces,
 								   std::string file_dir, int nb_intervals,
 								   float min_value, float max_value)
 {
-	vector<pair<float, int> > data_binned;
-	dataBiner(getLogDs(traces), data_binned, nb_intervals, min_value, max_value,0);
-
-	ofstream myfile;
-	myfile.open(file_dir);
-	if(myfile.is_open() == false) return; //->
+	saveTracesLogDsHistogramAsString(traces, _getAllTracesIdx(traces), file_dir, nb_intervals, min_value, max_value);
+}
 
-	int n = data_binned.size();
-	for(int data_idx = 0; data_idx <= n-1; data_idx++)
+void saveTracesLogDsHistogramAsString(const std::vector<Trace> &traces, const std::vector<int>& trc_idx_v,
+									   std::string file_dir, int nb_intervals,
+									   float min_value, float max_value)
+{
+	_saveTracesHistogramAsString(traces, trc_idx_v, file_dir, nb_intervals, min_value, max_value, StatsAccumulator::LOG_BINS,
+								 [](const Trace& trace, StatsAccumulator& stats)
 	{
-		myfile<<data_binned[data_idx].first;
-		myfile<<'\t';
-		myfile<<data_binned[data_idx].second;
-		myfile<<'\n';
-	}
-	myfile.close();
+		if(trace.isDCalculated()) stats.addValue(trace.getD());
+	});
 }
 
 void saveTracesLogDInstsHistogramAsString(std::vector<Trace> &traces,
 								   std::string file_dir, int nb_intervals,
 								   float min_value, float max_value)
 {
-	vector<pair<float, int> > data_binned;
-	dataBiner(getLogDInsts(traces), data_binned, nb_intervals, min_value, max_value,0);
-
-	ofstream myfile;
-	myfile.open(file_dir);
+	saveTracesLogDInstsHistogramAsString(traces, _getAllTracesIdx(traces), file_dir, nb_intervals, min_value, max_value);
+}
 
-	int n = data_binned.size();
-	for(int data_idx = 0; data_idx <= n-1; data_idx++)
+void saveTracesLogDInstsHistogramAsString(const std::vector<Trace> &traces, const std::vector<int>& trc_idx_v,
+									   std::string file_dir, int nb_intervals,
+									   float min_value, float max_value)
+{
+	_saveTracesHistogramAsString(traces, trc_idx_v, file_dir, nb_intervals, min_value, max_value, StatsAccumulator::LOG_BINS,
+								 [](const Trace& trace, StatsAccumulator& stats)
 	{
-		myfile<<data_binned[data_idx].first;
-		myfile<<'\t';
-		myfile<<data_binned[data_idx].second;
-		myfile<<'\n';
-	}
-	myfile.close();
+		if(trace.isDInstCalculated() == false) return; //->
+
+		for(float DInst : trace.getDInsts()) stats.addValue(DInst);
+	});
 }
 
 //void saveTracesLogDsEventHistogramAsString(std::vector<Trace> &traces,
@@ -1325,23 +1442,18 @@ void saveTracesLengthsHistogramAsString(std::vector<Trace> &traces,
 										std::string file_dir,  int nb_intervals,
 										float min_value, float max_value)
 {
-	vector<pair<float, int> > data_binned;
-	dataBiner(getLengths(traces), data_binned, nb_intervals, min_value, max_value,0);
-
-	auto lengths = getLengths(traces);
-
-	ofstream myfile;
-	myfile.open(file_dir);
+	saveTracesLengthsHistogramAsString(traces, _getAllTracesIdx(traces), file_dir, nb_intervals, min_value, max_value);
+}
 
-	int n = data_binned.size();
-	for(int data_idx = 0; data_idx <= n-1; data_idx++)
+void saveTracesLengthsHistogramAsString(const std::vector<Trace> &traces, const std::vector<int>& trc_idx_v,
+									   std::string file_dir, int nb_intervals,
+									   float min_value, float max_value)
+{
+	_saveTracesHistogramAsString(traces, trc_idx_v, file_dir, nb_intervals, min_value, max_value, StatsAccumulator::LINEAR_BINS,
+								 [](const Trace& trace, StatsAccumulator& stats)
 	{
-		myfile<<data_binned[data_idx].first;
-		myfile<<'\t';
-		myfile<<data_binned[data_idx].second;
-		myfile<<'\n';
-	}
-	myfile.close();
+		stats.addValue(trace.getLength());
+	});
 }
 
 vector<FluoEvent> getEventsInPlane(int plane_idx, vector<Trace> &traces) //traces is a copy we can operate on it!
@@ -56,9 +56,10 @@ class CELLENGINE_LIBRARYSHARED_EXPORT Trace
 {	
     friend void analyseTracesCrossings(std::vector<Trace>&,
 									   const Region&,
-									   vector<float>&,
-									   vector<float>&);
+									   std::vector<float>&,
+									   std::vector<float>&);
     friend void setTracesColorsUsingDInsts(std::vector<Trace>&,myLUT&, float, float);
+    friend class CrossingAnalyser;
 
 
 
@@ -69,6 +70,7 @@ public :
     Trace();
 
 	void addFluoEvent(FluoEvent event);
+	void setFluoEventVector(std::vector<FluoEvent>&& events_v);
 	void setX(float x, int event_idx);
 	void setY(float y, int event_idx);
 	void setTraceIdx(int trc_idx);
@@ -81,15 +83,15 @@ public :
 	bool isInsideRange(int plane_idx);
 	bool isInsideRegion(const Region& rgn, float& nbPoints_insideRgn);
 
-	FluoEvent getFluoEvent(int i);
-	FluoEvent getLastEvent();
-	FluoEvent getFirstEvent();
+	FluoEvent getFluoEvent(int i) const;
+	FluoEvent getLastEvent() const;
+	FluoEvent getFirstEvent() const;
 	FluoEvent& getFluoEventByRef(int i);
 	std::vector <FluoEvent> getFluoEventVector();
 
-	bool isMSDCalculated();
-	bool isDCalculated();
-	bool isDInstCalculated();
+	bool isMSDCalculated() const;
+	bool isDCalculated() const;
+	bool isDInstCalculated() const;
 
 
 	void getVecMSDFullTrace(std::vector<glm::vec2> *vecMSD_vect, glm::vec2 U, glm::vec2 V);
@@ -100,23 +102,26 @@ public :
 				  uint nbPoints_before, uint nbPoints_after);
 
 
-	int getLength();
+	int getLength() const;
 	glm::vec2 getBarycenter();
-	glm::vec4 getColor();
-	vector<glm::vec4>& getColors();
-	COLOR_MODE getColorMode();
-	float getD();
+	glm::vec4 getColor() const;
+	glm::vec4 getUniqueColor() const; //random color of the trace, whatever the color mode
+	std::vector<glm::vec4>& getColors();
+	const std::vector<glm::vec4>& getColors() const;
+	COLOR_MODE getColorMode() const;
+	float getD() const;
 	float getMSD0Fit();
 	std::vector<double>& getMSDs();
-	const std::vector<float>& getDInsts();
-	int getTraceIdx();
+	const std::vector<double>& getMSDs() const;
+	const std::vector<float>& getDInsts() const;
+	int getTraceIdx() const;
 
 	void clearFluoEventVector();
 
-    void elongateTrc(Trace& toBe_added_trc);
+    void elongateTrc(const Trace& toBe_added_trc);
     Trace getElongatedTrace(Trace& toBe_added_trc);
     int findClosestTrace(std::vector<Trace> & traces, int starting_idx, int min_delay, int max_delay, int max_distance);
-    bool isConnectable(Trace trace, int min_delay, int max_delay, float max_distance, float* distance_out);
+    bool isConnectable(const Trace& trace, int min_delay, int max_delay, float max_distance, float* distance_out) const;
 
 private :
 
@@ -182,6 +187,28 @@ CELLENGINE_LIBRARYSHARED_EXPORT void saveTracesLengthsHistogramAsString(std::vec
 																	 std::string file_dir,  int nb_intervals,
 																	 float min_value=-1, float max_value=-1);
 
+//same exports restricted to a view of the traces : traces[trc_idx] for each trc_idx of trc_idx_v, nothing is copied
+CELLENGINE_LIBRARYSHARED_EXPORT void saveTracesAsString(const std::vector<Trace> &traces, const std::vector<int>& trc_idx_v,
+														  std::string file_dir, FLUOEVENT_FILE_FORMAT format = PALMTRACER_FORMAT,
+														  float dt=-1, QProgressBar* progressBar = 0, float px = -1);
+
+CELLENGINE_LIBRARYSHARED_EXPORT void saveTracesDsAsString(const std::vector<Trace> &traces, const std::vector<int>& trc_idx_v,
+														  std::string file_dir, bool isVertical = true, bool isAppended = false);
+CELLENGINE_LIBRARYSHARED_EXPORT void saveTracesDInstsAsString(const std::vector<Trace> &traces, const std::vector<int>& trc_idx_v,
+															  std::string file_dir);
+CELLENGINE_LIBRARYSHARED_EXPORT void saveTracesMSDsAsString(const std::vector<Trace> &traces, const std::vector<int>& trc_idx_v,
+															std::string file_dir, bool isAppended = false);
+
+CELLENGINE_LIBRARYSHARED_EXPORT void saveTracesLogDsHistogramAsString(const std::vector<Trace> &traces, const std::vector<int>& trc_idx_v,
+																	 std::string file_dir, int nb_intervals,
+																	 float min_value=-1, float max_value=-1);
+CELLENGINE_LIBRARYSHARED_EXPORT void saveTracesLogDInstsHistogramAsString(const std::vector<Trace> &traces, const std::vector<int>& trc_idx_v,
+																	 std::string file_dir, int nb_intervals,
+																	 float min_value=-1, float max_value=-1);
+CELLENGINE_LIBRARYSHARED_EXPORT void saveTracesLengthsHistogramAsString(const std::vector<Trace> &traces, const std::vector<int>& trc_idx_v,
+																	 std::string file_dir,  int nb_intervals,
+																	 float min_value=-1, float max_value=-1);
+
 //get
 CELLENGINE_LIBRARYSHARED_EXPORT std::vector<FluoEvent> getEventsInPlane(int plane_idx, std::vector<Trace> &traces);
 CELLENGINE_LIBRARYSHARED_EXPORT std::vector<glm::vec2> getEventCoordsInPlane(int plane_idx, std::vector<Trace> &traces);
@@ -213,7 +240,7 @@ CELLENGINE_LIBRARYSHARED_EXPORT void saveTracesProperties(std::vector<Trace>& tr
 
 //trace analysis
 CELLENGINE_LIBRARYSHARED_EXPORT void analyseTracesCrossings(std::vector<Trace>& traces, const Region& rgn,
-															  vector<float>& nbEventsBeforeLeaving, vector<float>& nbEventsBeforeEntering);
+															  std::vector<float>& nbEventsBeforeLeaving, std::vector<float>& nbEventsBeforeEntering);
 
 
 
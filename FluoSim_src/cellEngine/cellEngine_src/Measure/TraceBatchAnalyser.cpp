@@ -0,0 +1,237 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+
+
+#include "cmath"
+#include "iostream"
+
+#include "QDir"
+#include "QFileInfo"
+#include "QString"
+
+#include "TraceBatchAnalyser.h"
+    #include "TraceLinker.h"
+
+#include "toolBox_src/toolbox_library_global.h"
+    #include "toolBox_src/developmentTools/myClock.h"
+    #include "toolBox_src/parallelTools/myWorkStealingPool.h"
+
+using namespace std;
+
+
+TraceBatchAnalyser::TraceBatchAnalyser()
+{
+	m_nbWorkers = 0;
+	m_memoryBudget = 0;
+	m_memoryInUse = 0;
+	m_nbFilesInUse = 0;
+}
+
+void TraceBatchAnalyser::setParams(const myTraceAnalysisParams& params)
+{
+	m_params = params;
+}
+
+void TraceBatchAnalyser::setNbWorkers(int nb_workers)
+{
+	m_nbWorkers = nb_workers;
+}
+
+void TraceBatchAnalyser::setMemoryBudget(long long budget_inBytes)
+{
+	m_memoryBudget = budget_inBytes;
+}
+
+void TraceBatchAnalyser::addPath(string path)
+{
+	QFileInfo path_info(path.data());
+
+	if(path_info.isDir() == false)
+	{
+		m_paths_v.push_back(path);
+		return; //->
+	}
+
+	QDir dir(path.data());
+	QStringList files = dir.entryList(QStringList()<<"*.trc"<<"*.btrc", QDir::Files, QDir::Name);
+	for(const QString& file : files)
+	{
+		m_paths_v.push_back(dir.filePath(file).toLocal8Bit().data());
+	}
+}
+
+void TraceBatchAnalyser::clearPaths()
+{
+	m_paths_v.clear();
+}
+
+const vector<string>& TraceBatchAnalyser::getPaths() const
+{
+	return m_paths_v;
+}
+
+const vector<myTraceFileReport>& TraceBatchAnalyser::getReports() const
+{
+	return m_reports_v;
+}
+
+bool TraceBatchAnalyser::run()
+{
+	m_reports_v.assign(m_paths_v.size(), myTraceFileReport());
+	m_memoryInUse = 0;
+	m_nbFilesInUse = 0;
+
+	myWorkStealingPool pool(m_nbWorkers);
+	pool.run(m_paths_v.size(), [this](int file_idx, int)
+	{
+		_processFile(file_idx);
+	});
+
+	bool areAllFilesSucceeded = true;
+	for(const myTraceFileReport& report : m_reports_v)
+	{
+		if(report.isSucceeded == false) areAllFilesSucceeded = false;
+	}
+
+	return areAllFilesSucceeded;
+}
+
+//same pipeline as TracePlayerModel::computeMSDsAndDs and TracePlayerModel::filter
+void TraceBatchAnalyser::analyseTraces(vector<Trace>& traces, const myTraceAnalysisParams& params,
+									   vector<Trace>& filtered_traces)
+{
+	if(params.isGapClosing_enabled)
+	{
+		//the files are already processed in parallel
+		TraceLinker linker(params.gapClosing_minDelay, params.gapClosing_maxDelay, params.gapClosing_maxDistance);
+		traces = linker.stitchTraces(traces, false);
+	}
+
+	computeMSDs(traces, params.MSD_maxDPlane);
+	computeDs(traces, params.pixel_size, params.timestep, 1, params.D_nbPointsMSDFit);
+	if(params.isDInst_computed || params.isDInstHistogram_exported)
+	{
+		computeDInst(traces, params.pixel_size, params.timestep,
+					 params.DInst_nbPointsBeforeMSDFit, params.DInst_nbPointsAfterMSDFit);
+	}
+
+	filtered_traces.clear();
+	for(Trace& trace : traces)
+	{
+		if(trace.getLength() > params.max_length || trace.getLength() < params.min_length) continue; //<-
+
+		float logD = log10(trace.getD());
+		if(trace.isDCalculated() && logD >= params.minLogD && logD <= params.maxLogD)
+		{
+			filtered_traces.push_back(trace);
+		}
+	}
+}
+
+void TraceBatchAnalyser::_processFile(int file_idx)
+{
+	myChrono clock;
+	clock.startTour();
+
+	const string& path = m_paths_v[file_idx];
+	myTraceFileReport& report = m_reports_v[file_idx];
+	report.path = path;
+
+	QFileInfo file_info(path.data());
+	QString suffix = file_info.suffix().toLower();
+	if(file_info.isFile() == false || (suffix != "trc" && suffix != "btrc"))
+	{
+		lock_guard<mutex> lock(m_cout_mutex);
+		cout<<"In TraceBatchAnalyser::_processFile : error (not a trace file : "<<path<<")\n";
+		return; //->
+	}
+
+	//the loaded traces, their MSDs and the filtered copy take a few times the file size
+	long long memory_estimate = 3*file_info.size();
+	_acquireMemory(memory_estimate);
+	{
+		vector<Trace> traces;
+		if(suffix == "trc") traces = loadTracesAsString2(path, 0);
+		else traces = loadTracesAsBinary(path);
+
+		//the loaders return no trace when the file can't be opened
+		if(traces.empty())
+		{
+			_releaseMemory(memory_estimate);
+
+			lock_guard<mutex> lock(m_cout_mutex);
+			cout<<"In TraceBatchAnalyser::_processFile : error (no trace loaded from "<<path<<")\n";
+			return; //->
+		}
+
+		vector<Trace> filtered_traces;
+		analyseTraces(traces, m_params, filtered_traces);
+
+		if(m_params.isDHistogram_exported)
+		{
+			saveTracesLogDsHistogramAsString(filtered_traces, path + "_D.txt", m_params.DsHistogram_nbIntervals,
+											 m_params.DsHistogram_minValue, m_params.DsHistogram_maxValue);
+		}
+		if(m_params.isDInstHistogram_exported)
+		{
+			saveTracesLogDInstsHistogramAsString(filtered_traces, path + "_DInst.txt", m_params.DsHistogram_nbIntervals,
+												 m_params.DsHistogram_minValue, m_params.DsHistogram_maxValue);
+		}
+		if(m_params.isLengthsHistogram_exported)
+		{
+			saveTracesLengthsHistogramAsString(filtered_traces, path + "_lgth.txt", m_params.lengthsHistogram_nbIntervals,
+											   m_params.lengthsHistogram_minValue, m_params.lengthsHistogram_maxValue);
+		}
+		if(m_params.areDs_exported) saveTracesDsAsString(filtered_traces, path + "_DPerTrack.txt");
+
+		report.nb_traces = traces.size();
+		report.nb_filteredTraces = filtered_traces.size();
+		report.isSucceeded = true;
+	}
+	_releaseMemory(memory_estimate);
+
+	report.duration = clock.endTour();
+
+	lock_guard<mutex> lock(m_cout_mutex);
+	cout<<path<<" : "<<report.nb_filteredTraces<<"/"<<report.nb_traces<<" traces ("<<report.duration<<" s)\n";
+}
+
+void TraceBatchAnalyser::_acquireMemory(long long size_inBytes)
+{
+	unique_lock<mutex> lock(m_memory_mutex);
+	m_memory_cv.wait(lock, [this, size_inBytes]()
+	{
+		return m_memoryBudget <= 0 || m_nbFilesInUse == 0 || m_memoryInUse + size_inBytes <= m_memoryBudget;
+	});
+
+	m_memoryInUse += size_inBytes;
+	m_nbFilesInUse++;
+}
+
+void TraceBatchAnalyser::_releaseMemory(long long size_inBytes)
+{
+	{
+		lock_guard<mutex> lock(m_memory_mutex);
+		m_memoryInUse -= size_inBytes;
+		m_nbFilesInUse--;
+	}
+	m_memory_cv.notify_all();
+}
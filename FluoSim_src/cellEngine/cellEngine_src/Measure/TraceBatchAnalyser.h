@@ -0,0 +1,128 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#ifndef TRACEBATCHANALYSER_H
+#define TRACEBATCHANALYSER_H
+
+#include "condition_variable"
+#include "mutex"
+#include "string"
+#include "vector"
+
+#include "cellEngine_library_global.h"
+    #include "Trace.h"
+
+
+//analysis settings of the TracePlayer (same defaults)
+struct myTraceAnalysisParams
+{
+	float pixel_size = 0.160f; //µm
+	float timestep = 0.020f; //s
+
+	int MSD_maxDPlane = 10;
+	int D_nbPointsMSDFit = 4;
+	bool isDInst_computed = false;
+	int DInst_nbPointsBeforeMSDFit = 10;
+	int DInst_nbPointsAfterMSDFit = 10;
+
+//gap closing (see TraceLinker), the traces interrupted by blinking being stitched before the analysis
+	bool isGapClosing_enabled = false;
+	int gapClosing_minDelay = 1; //planes
+	int gapClosing_maxDelay = 1;
+	float gapClosing_maxDistance = 1.0f; //same unit as the events
+
+//filter
+	int min_length = 0;
+	int max_length = 1000;
+	float minLogD = -10;
+	float maxLogD = 10;
+
+//exports, written next to each trace file
+	bool isDHistogram_exported = true; //<file>_D.txt
+	bool isDInstHistogram_exported = false; //<file>_DInst.txt
+	bool isLengthsHistogram_exported = false; //<file>_lgth.txt
+	bool areDs_exported = false; //<file>_DPerTrack.txt
+
+	int DsHistogram_nbIntervals = 35;
+	float DsHistogram_minValue = -6;
+	float DsHistogram_maxValue = 1;
+	int lengthsHistogram_nbIntervals = 35;
+	float lengthsHistogram_minValue = 0;
+	float lengthsHistogram_maxValue = 200;
+};
+
+struct myTraceFileReport
+{
+	std::string path;
+	bool isSucceeded = false;
+	int nb_traces = 0;
+	int nb_filteredTraces = 0;
+	double duration = 0; //s
+};
+
+
+//headless counterpart of the TracePlayer batch mode : each .trc/.btrc file is loaded, fitted, filtered
+//and exported by a worker of a myWorkStealingPool, without GL context nor rendering.
+//The memory is bounded : a file is only loaded once the sizes of the files being processed, plus its own,
+//fit in the memory budget (a file larger than the budget is processed alone).
+
+class CELLENGINE_LIBRARYSHARED_EXPORT TraceBatchAnalyser
+{
+public :
+
+	TraceBatchAnalyser();
+
+	void setParams(const myTraceAnalysisParams& params);
+	void setNbWorkers(int nb_workers); //0 : one per hardware thread
+	void setMemoryBudget(long long budget_inBytes); //<= 0 : unbounded
+
+	void addPath(std::string path); //trace file, or directory whose .trc/.btrc files are added
+	void clearPaths();
+	const std::vector<std::string>& getPaths() const;
+
+	bool run(); //false if a file failed
+	const std::vector<myTraceFileReport>& getReports() const;
+
+	static void analyseTraces(std::vector<Trace>& traces, const myTraceAnalysisParams& params,
+							  std::vector<Trace>& filtered_traces);
+
+private :
+
+	void _processFile(int file_idx);
+	void _acquireMemory(long long size_inBytes);
+	void _releaseMemory(long long size_inBytes);
+
+private :
+
+	myTraceAnalysisParams m_params;
+	int m_nbWorkers;
+	std::vector<std::string> m_paths_v;
+	std::vector<myTraceFileReport> m_reports_v;
+
+	long long m_memoryBudget;
+	long long m_memoryInUse;
+	int m_nbFilesInUse;
+	std::mutex m_memory_mutex;
+	std::condition_variable m_memory_cv;
+	std::mutex m_cout_mutex;
+};
+
+
+#endif // TRACEBATCHANALYSER_H
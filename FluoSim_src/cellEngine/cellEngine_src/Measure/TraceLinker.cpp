@@ -0,0 +1,300 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+
+
+#include "algorithm"
+#include "cmath"
+#include "thread"
+
+#include "TraceLinker.h"
+
+using namespace std;
+
+
+TraceLinker::TraceLinker(int min_delay, int max_delay, float max_distance)
+{
+	setParameters(min_delay, max_delay, max_distance);
+	clear();
+}
+
+void TraceLinker::setParameters(int min_delay, int max_delay, float max_distance)
+{
+	m_min_delay = min_delay;
+	m_max_delay = max_delay;
+	m_max_distance = max_distance;
+
+	//slightly wider than max_distance : two starts within max_distance are always in neighbouring cells
+	if(max_distance > 0.0f) m_cell_size = 1.0001f*max_distance;
+	else m_cell_size = 1.0f;
+}
+
+void TraceLinker::clear()
+{
+	m_minPlane = 0;
+	m_planeOffsets_v.assign(1, 0);
+	m_cellKeys_v.clear();
+	m_xs_v.clear();
+	m_ys_v.clear();
+	m_trcIdx_v.clear();
+}
+
+long long TraceLinker::_getCellKey(int cell_x, int cell_y)
+{
+	//ordered as (cell_x, cell_y), the cells of a column are contiguous
+	return (long long)(cell_x)*(1LL<<32) + ((long long)(cell_y) + (1LL<<31));
+}
+
+int TraceLinker::_getCell(float r) const
+{
+	float cell = std::floor(r/m_cell_size);
+	cell = std::max(-float(1<<30), std::min(float(1<<30), cell));
+
+	return int(cell);
+}
+
+void TraceLinker::build(const vector<Trace>& traces)
+{
+	clear();
+
+	struct traceStart
+	{
+		int plane;
+		long long cell_key;
+		int trc_idx;
+	};
+
+	vector<traceStart> starts_v;
+	starts_v.reserve(traces.size());
+
+	for(int trc_idx = 0; trc_idx < int(traces.size()); trc_idx++)
+	{
+		if(traces[trc_idx].getLength() == 0) continue; //<-
+
+		FluoEvent first_event = traces[trc_idx].getFirstEvent();
+		starts_v.push_back({first_event.plane, _getCellKey(_getCell(first_event.x), _getCell(first_event.y)), trc_idx});
+	}
+	if(starts_v.empty()) return; //->
+
+	std::sort(starts_v.begin(), starts_v.end(), [](const traceStart& s1, const traceStart& s2)
+	{
+		if(s1.plane != s2.plane) return s1.plane < s2.plane;
+		if(s1.cell_key != s2.cell_key) return s1.cell_key < s2.cell_key;
+		return s1.trc_idx < s2.trc_idx;
+	});
+
+	int nb_starts = starts_v.size();
+	m_minPlane = starts_v.front().plane;
+	int nb_planes = starts_v.back().plane - m_minPlane + 1;
+
+	m_planeOffsets_v.assign(nb_planes+1, 0);
+	m_cellKeys_v.resize(nb_starts);
+	m_xs_v.resize(nb_starts);
+	m_ys_v.resize(nb_starts);
+	m_trcIdx_v.resize(nb_starts);
+
+	for(int start_idx = 0; start_idx < nb_starts; start_idx++)
+	{
+		const traceStart& start = starts_v[start_idx];
+		FluoEvent first_event = traces[start.trc_idx].getFirstEvent();
+
+		m_planeOffsets_v[start.plane - m_minPlane + 1]++;
+		m_cellKeys_v[start_idx] = start.cell_key;
+		m_xs_v[start_idx] = first_event.x;
+		m_ys_v[start_idx] = first_event.y;
+		m_trcIdx_v[start_idx] = start.trc_idx;
+	}
+
+	for(int plane_idx = 0; plane_idx < nb_planes; plane_idx++)
+	{
+		m_planeOffsets_v[plane_idx+1] += m_planeOffsets_v[plane_idx];
+	}
+}
+
+template<class Visitor>
+void TraceLinker::_forEachStart(const FluoEvent& last_event, Visitor visitor) const
+{
+	int nb_planes = m_planeOffsets_v.size()-1;
+	long long first_plane = std::max((long long)(m_minPlane), (long long)(last_event.plane) + m_min_delay);
+	long long last_plane = std::min((long long)(m_minPlane) + nb_planes-1, (long long)(last_event.plane) + m_max_delay);
+
+	int cell_x = _getCell(last_event.x);
+	int cell_y = _getCell(last_event.y);
+
+	for(long long plane = first_plane; plane <= last_plane; plane++)
+	{
+		auto plane_begin = m_cellKeys_v.begin() + m_planeOffsets_v[plane - m_minPlane];
+		auto plane_end = m_cellKeys_v.begin() + m_planeOffsets_v[plane - m_minPlane + 1];
+		if(plane_begin == plane_end) continue; //<-
+
+		for(int neighbour_x = cell_x-1; neighbour_x <= cell_x+1; neighbour_x++)
+		{
+			long long last_key = _getCellKey(neighbour_x, cell_y+1);
+			auto key = std::lower_bound(plane_begin, plane_end, _getCellKey(neighbour_x, cell_y-1));
+
+			for(; key != plane_end && *key <= last_key; key++)
+			{
+				int start_idx = key - m_cellKeys_v.begin();
+
+				//same distance as Trace::isConnectable
+				float distance = std::sqrt(std::pow(last_event.x - m_xs_v[start_idx], 2.0)
+										 + std::pow(last_event.y - m_ys_v[start_idx], 2.0));
+				if(!(distance <= m_max_distance)) continue; //<-
+
+				visitor(m_trcIdx_v[start_idx], distance);
+			}
+		}
+	}
+}
+
+int TraceLinker::_findClosestStart(const FluoEvent& last_event, int starting_idx, int trace_to_avoid, float* distance_out) const
+{
+	int closest_trace_idx = -1;
+	float closest_trace_dist = -1.0f;
+
+	_forEachStart(last_event, [&](int trc_idx, float distance)
+	{
+		if(trc_idx < starting_idx || trc_idx == trace_to_avoid) return; //->
+
+		//on equal distances, the last trace is kept as in Trace::findClosestTrace
+		if(closest_trace_dist < 0 || distance < closest_trace_dist ||
+		  (distance == closest_trace_dist && trc_idx > closest_trace_idx))
+		{
+			closest_trace_idx = trc_idx;
+			closest_trace_dist = distance;
+		}
+	});
+
+	if(distance_out != 0) *distance_out = closest_trace_dist;
+	return closest_trace_idx;
+}
+
+int TraceLinker::findClosestTrace(const Trace& trace, int starting_idx, float* distance_out) const
+{
+	if(trace.getLength() == 0) return -1; //->
+
+	return _findClosestStart(trace.getLastEvent(), starting_idx, -1, distance_out);
+}
+
+void TraceLinker::_findCandidates(const TraceLinker* linker, const vector<Trace>* traces,
+								  int first_trc, int last_trc, vector<LinkCandidate>* candidates_v)
+{
+	for(int trc_idx = first_trc; trc_idx <= last_trc; trc_idx++)
+	{
+		if((*traces)[trc_idx].getLength() == 0) continue; //<-
+
+		linker->_forEachStart((*traces)[trc_idx].getLastEvent(), [&](int start_trc, float distance)
+		{
+			if(start_trc != trc_idx) candidates_v->push_back({distance, trc_idx, start_trc});
+		});
+	}
+}
+
+vector<int> TraceLinker::linkTraces(const vector<Trace>& traces, bool isMultiThreaded)
+{
+	build(traces);
+
+	int nb_traces = traces.size();
+
+	//every end is queried independently
+	int nb_threads = 1;
+	if(isMultiThreaded && nb_traces >= 10000) nb_threads = std::max(1u, std::thread::hardware_concurrency());
+
+	vector<vector<LinkCandidate> > candidates_vv(nb_threads);
+	if(nb_threads == 1) _findCandidates(this, &traces, 0, nb_traces-1, &candidates_vv[0]);
+	else
+	{
+		vector<thread> threads_v;
+		int nb_traces_perThread = nb_traces/nb_threads;
+
+		for(int thread_idx = 0; thread_idx < nb_threads; thread_idx++)
+		{
+			int first_trc = thread_idx*nb_traces_perThread;
+			int last_trc = (thread_idx == nb_threads-1) ? nb_traces-1 : first_trc + nb_traces_perThread-1;
+
+			threads_v.push_back(thread(_findCandidates, this, &traces, first_trc, last_trc, &candidates_vv[thread_idx]));
+		}
+		for(thread& th : threads_v) th.join();
+	}
+
+	vector<LinkCandidate> candidates_v;
+	for(vector<LinkCandidate>& thread_candidates_v : candidates_vv)
+	{
+		candidates_v.insert(candidates_v.end(), thread_candidates_v.begin(), thread_candidates_v.end());
+	}
+
+	//greedy assignment by increasing distance : an end losing its closest start to a closer end
+	//is linked to its next closest start still free
+	std::sort(candidates_v.begin(), candidates_v.end(), [](const LinkCandidate& c1, const LinkCandidate& c2)
+	{
+		if(c1.distance != c2.distance) return c1.distance < c2.distance;
+		if(c1.end_trc != c2.end_trc) return c1.end_trc < c2.end_trc;
+		return c1.start_trc > c2.start_trc;
+	});
+
+	vector<int> next_v(nb_traces, -1);
+	vector<bool> isStartTaken_v(nb_traces, false);
+	for(const LinkCandidate& candidate : candidates_v)
+	{
+		if(next_v[candidate.end_trc] != -1 || isStartTaken_v[candidate.start_trc]) continue; //<-
+
+		next_v[candidate.end_trc] = candidate.start_trc;
+		isStartTaken_v[candidate.start_trc] = true;
+	}
+
+	return next_v;
+}
+
+vector<Trace> TraceLinker::stitchTraces(const vector<Trace>& traces, bool isMultiThreaded)
+{
+	vector<int> next_v = linkTraces(traces, isMultiThreaded);
+	int nb_traces = traces.size();
+
+	vector<bool> hasPrevious_v(nb_traces, false);
+	for(int trc_idx = 0; trc_idx < nb_traces; trc_idx++)
+	{
+		if(next_v[trc_idx] != -1) hasPrevious_v[next_v[trc_idx]] = true;
+	}
+
+	vector<Trace> stitched_v;
+	vector<bool> isVisited_v(nb_traces, false);
+
+	//chains are followed from their heads, then the cycles left (min_delay <= 0) are cut where they are entered
+	for(int pass = 0; pass < 2; pass++)
+	{
+		for(int head_idx = 0; head_idx < nb_traces; head_idx++)
+		{
+			if(isVisited_v[head_idx] || (pass == 0 && hasPrevious_v[head_idx])) continue; //<-
+
+			stitched_v.push_back(traces[head_idx]);
+			isVisited_v[head_idx] = true;
+
+			int trc_idx = next_v[head_idx];
+			while(trc_idx != -1 && isVisited_v[trc_idx] == false)
+			{
+				stitched_v.back().elongateTrc(traces[trc_idx]);
+				isVisited_v[trc_idx] = true;
+				trc_idx = next_v[trc_idx];
+			}
+		}
+	}
+
+	return stitched_v;
+}
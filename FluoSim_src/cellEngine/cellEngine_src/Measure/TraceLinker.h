@@ -0,0 +1,91 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#ifndef TRACELINKER_H
+#define TRACELINKER_H
+
+#include "vector"
+
+#include "cellEngine_library_global.h"
+    #include "FluoEvent.h"
+    #include "Trace.h"
+
+
+//gap-closing of trajectories interrupted by blinking : the end of a trace is linked to the closest trace start
+//appearing between min_delay and max_delay planes later, within max_distance.
+//The starts are indexed by plane, then by cells of max_distance, so that a query only reads, for each plane
+//of the delay window, the 3x3 cells around the end, instead of the whole trace list (Trace::findClosestTrace).
+
+class CELLENGINE_LIBRARYSHARED_EXPORT TraceLinker
+{
+public :
+
+	TraceLinker(int min_delay = 1, int max_delay = 1, float max_distance = 1.0f);
+
+	void setParameters(int min_delay, int max_delay, float max_distance); //the index has then to be rebuilt
+	void build(const std::vector<Trace>& traces);
+	void clear();
+
+	//same result as trace.findClosestTrace(traces, starting_idx, ...) on the indexed traces, -1 if none
+	int findClosestTrace(const Trace& trace, int starting_idx = 0, float* distance_out = 0) const;
+
+	//successor of each trace (-1 if none) : the (end, start) pairs within reach are assigned by increasing distance,
+	//an end whose closest start is taken by a closer end gets its next closest free start
+	//(ties : lowest end index, then last start as in Trace::findClosestTrace)
+	std::vector<int> linkTraces(const std::vector<Trace>& traces, bool isMultiThreaded = true);
+
+	//the linked traces are concatenated, the others kept as they are
+	std::vector<Trace> stitchTraces(const std::vector<Trace>& traces, bool isMultiThreaded = true);
+
+private :
+
+	struct LinkCandidate
+	{
+		float distance;
+		int end_trc;
+		int start_trc;
+	};
+
+	//visitor(trc_idx, distance) is called for each start within reach of last_event
+	template<class Visitor> void _forEachStart(const FluoEvent& last_event, Visitor visitor) const;
+	int _findClosestStart(const FluoEvent& last_event, int starting_idx, int trace_to_avoid, float* distance_out) const;
+	static void _findCandidates(const TraceLinker* linker, const std::vector<Trace>* traces,
+								int first_trc, int last_trc, std::vector<LinkCandidate>* candidates_v);
+	static long long _getCellKey(int cell_x, int cell_y);
+	int _getCell(float r) const;
+
+private :
+
+	int m_min_delay;
+	int m_max_delay;
+	float m_max_distance;
+	float m_cell_size;
+
+//starts sorted by plane, then by cell, then by trace index
+	int m_minPlane;
+	std::vector<int> m_planeOffsets_v; //starts of plane m_minPlane+i : [m_planeOffsets_v[i], m_planeOffsets_v[i+1])
+	std::vector<long long> m_cellKeys_v;
+	std::vector<float> m_xs_v;
+	std::vector<float> m_ys_v;
+	std::vector<int> m_trcIdx_v;
+};
+
+
+#endif // TRACELINKER_H
@@ -0,0 +1,469 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#include "unordered_map"
+
+#include "TraceTracker.h"
+
+
+using namespace std;
+using namespace glm;
+
+
+TraceTracker::TraceTracker()
+{
+	m_nbRunningTraces = 0;
+	m_nbDeadEvents = 0;
+
+	m_stream_format = PALMTRACER_FORMAT;
+	m_stream_dt = -1;
+	m_stream_px = -1;
+	m_nbStreamedTraces = 0;
+}
+
+TraceTracker::~TraceTracker()
+{
+	if(isStreaming()) stopStreaming();
+}
+
+void TraceTracker::beginPlane(int nb_particles)
+{
+	if(nb_particles > int(m_runningTraceIdx_v.size()))
+	{
+		m_runningTraceIdx_v.resize(nb_particles, -1);
+		m_slotOwners_v.resize(nb_particles, 0);
+	}
+}
+
+void TraceTracker::addEvent(int particle_idx, const void* particle_adr, int plane, float x, float y)
+{
+	if(particle_idx >= int(m_runningTraceIdx_v.size())) beginPlane(particle_idx+1);
+
+	//the slot is now used by another particle : its trace is over
+	if(m_slotOwners_v[particle_idx] != particle_adr)
+	{
+		if(m_runningTraceIdx_v[particle_idx] != -1) _closeTrace(particle_idx);
+		m_slotOwners_v[particle_idx] = particle_adr;
+	}
+
+	int event_idx = m_eventPlanes_v.size();
+	m_eventPlanes_v.push_back(plane);
+	m_eventXs_v.push_back(x);
+	m_eventYs_v.push_back(y);
+	m_eventNexts_v.push_back(-1);
+
+	int running_idx = m_runningTraceIdx_v[particle_idx];
+	if(running_idx == -1)
+	{
+		running_idx = _startTrace(particle_idx);
+		m_runningTraces_v[running_idx].first_event = event_idx;
+	}
+	else
+	{
+		m_eventNexts_v[m_runningTraces_v[running_idx].last_event] = event_idx;
+	}
+
+	m_runningTraces_v[running_idx].last_event = event_idx;
+	m_runningTraces_v[running_idx].length++;
+}
+
+void TraceTracker::endTrace(int particle_idx, const void* particle_adr)
+{
+	if(particle_idx >= int(m_runningTraceIdx_v.size())) return; //->
+	if(m_runningTraceIdx_v[particle_idx] == -1) return; //->
+
+	_closeTrace(particle_idx);
+	m_slotOwners_v[particle_idx] = particle_adr;
+}
+
+void TraceTracker::rekeySlots(const vector<const void*>& slotParticles_v)
+{
+	int nb_slots = m_runningTraceIdx_v.size();
+	int nb_particles = slotParticles_v.size();
+
+	//nothing moved : every owner is still the particle of its rank
+	bool isRekey_needed = false;
+	for(int particle_idx = 0; particle_idx <= nb_slots-1 && isRekey_needed == false; particle_idx++)
+	{
+		const void* owner = m_slotOwners_v[particle_idx];
+		if(owner == 0) continue; //<-
+		isRekey_needed = (particle_idx >= nb_particles || owner != slotParticles_v[particle_idx]);
+	}
+	if(isRekey_needed == false) return; //->
+
+	unordered_map<const void*, int> particleRanks_map;
+	particleRanks_map.reserve(nb_particles);
+	for(int particle_idx = 0; particle_idx <= nb_particles-1; particle_idx++) particleRanks_map[slotParticles_v[particle_idx]] = particle_idx;
+
+	vector<int> runningTraceIdx_v(std::max(nb_slots, nb_particles), -1);
+	vector<const void*> slotOwners_v(runningTraceIdx_v.size(), 0);
+	for(int particle_idx = 0; particle_idx <= nb_slots-1; particle_idx++)
+	{
+		const void* owner = m_slotOwners_v[particle_idx];
+		if(owner == 0) continue; //<-
+
+		auto particleRank_it = particleRanks_map.find(owner);
+		if(particleRank_it == particleRanks_map.end())
+		{
+			//the particle was deleted : its trace is over
+			if(m_runningTraceIdx_v[particle_idx] != -1) _closeTrace(particle_idx);
+			continue; //<-
+		}
+
+		runningTraceIdx_v[particleRank_it->second] = m_runningTraceIdx_v[particle_idx];
+		slotOwners_v[particleRank_it->second] = owner;
+	}
+
+	m_runningTraceIdx_v.swap(runningTraceIdx_v);
+	m_slotOwners_v.swap(slotOwners_v);
+}
+
+int TraceTracker::_startTrace(int particle_idx)
+{
+	int running_idx;
+	if(m_freeRunningTraces_v.empty() == false)
+	{
+		running_idx = m_freeRunningTraces_v.back();
+		m_freeRunningTraces_v.pop_back();
+	}
+	else
+	{
+		running_idx = m_runningTraces_v.size();
+		m_runningTraces_v.push_back(runningTrace());
+	}
+
+	m_runningTraces_v[running_idx] = runningTrace{-1, -1, 0};
+	m_runningTraceIdx_v[particle_idx] = running_idx;
+	m_nbRunningTraces++;
+
+	return running_idx;
+}
+
+void TraceTracker::_closeTrace(int particle_idx)
+{
+	int running_idx = m_runningTraceIdx_v[particle_idx];
+	runningTrace& running_trc = m_runningTraces_v[running_idx];
+
+	Trace trace = _materialiseTrace(running_trc);
+	_storeFinishedTrace(trace);
+
+	m_lengths_stats.addValue(running_trc.length);
+	m_nbDeadEvents += running_trc.length;
+	m_runningTraceIdx_v[particle_idx] = -1;
+	m_freeRunningTraces_v.push_back(running_idx);
+	m_nbRunningTraces--;
+
+	//the arena is compacted once it is mostly made of closed traces
+	if(m_nbDeadEvents > 65536 && 2*m_nbDeadEvents > int(m_eventPlanes_v.size())) _compactArena();
+}
+
+Trace TraceTracker::_materialiseTrace(const runningTrace& running_trc) const
+{
+	vector<FluoEvent> events_v;
+	events_v.reserve(running_trc.length);
+
+	int event_idx = running_trc.first_event;
+	while(event_idx != -1)
+	{
+		events_v.push_back(FluoEvent{0, m_eventPlanes_v[event_idx], m_eventXs_v[event_idx], m_eventYs_v[event_idx], 1, -1, 1});
+		event_idx = m_eventNexts_v[event_idx];
+	}
+
+	Trace trace;
+	trace.setFluoEventVector(std::move(events_v));
+	return trace;
+}
+
+void TraceTracker::_storeFinishedTrace(Trace& trace)
+{
+	if(isStreaming() == false)
+	{
+		m_finishedTraces_v.push_back(std::move(trace));
+		return; //->
+	}
+
+	m_nbStreamedTraces++;
+	int nb_events = trace.getLength();
+	for(int event_idx = 0; event_idx <= nb_events-1; event_idx++)
+	{
+		getDataStr(trace.getFluoEventByRef(event_idx), m_stream_buffer, m_nbStreamedTraces, false,
+				   m_stream_format, m_stream_dt, m_stream_px);
+	}
+
+	if(m_stream_buffer.size() > 8*1024*1024)
+	{
+		m_stream_file.write(m_stream_buffer.data(), m_stream_buffer.size());
+		m_stream_buffer.clear();
+	}
+}
+
+void TraceTracker::_compactArena()
+{
+	vector<int> planes_v, nexts_v;
+	vector<float> xs_v, ys_v;
+
+	int nb_liveEvents = m_eventPlanes_v.size() - m_nbDeadEvents;
+	planes_v.reserve(nb_liveEvents);
+	xs_v.reserve(nb_liveEvents);
+	ys_v.reserve(nb_liveEvents);
+	nexts_v.reserve(nb_liveEvents);
+
+	for(int particle_idx = 0; particle_idx <= int(m_runningTraceIdx_v.size())-1; particle_idx++)
+	{
+		int running_idx = m_runningTraceIdx_v[particle_idx];
+		if(running_idx == -1) continue; //<-
+
+		//the events of a trace become contiguous
+		runningTrace& running_trc = m_runningTraces_v[running_idx];
+		int event_idx = running_trc.first_event;
+		running_trc.first_event = planes_v.size();
+		while(event_idx != -1)
+		{
+			planes_v.push_back(m_eventPlanes_v[event_idx]);
+			xs_v.push_back(m_eventXs_v[event_idx]);
+			ys_v.push_back(m_eventYs_v[event_idx]);
+			nexts_v.push_back(planes_v.size());
+			event_idx = m_eventNexts_v[event_idx];
+		}
+		nexts_v.back() = -1;
+		running_trc.last_event = planes_v.size()-1;
+	}
+
+	m_eventPlanes_v.swap(planes_v);
+	m_eventXs_v.swap(xs_v);
+	m_eventYs_v.swap(ys_v);
+	m_eventNexts_v.swap(nexts_v);
+	m_nbDeadEvents = 0;
+}
+
+bool TraceTracker::startStreaming(string file_path, FLUOEVENT_FILE_FORMAT format, float dt, float px)
+{
+	if(isStreaming()) stopStreaming();
+
+	m_stream_file.open(file_path.data());
+	if(!m_stream_file.is_open())
+	{
+		cout<<"In TraceTracker::startStreaming : error (cannot open "<<file_path<<")\n";
+		return false; //->
+	}
+
+	m_stream_format = format;
+	m_stream_dt = dt;
+	m_stream_px = px;
+	m_nbStreamedTraces = 0;
+	m_stream_buffer.clear();
+
+	//the traces finished before the streaming are written first
+	for(Trace& trace : m_finishedTraces_v) _storeFinishedTrace(trace);
+	m_finishedTraces_v.clear();
+
+	return true;
+}
+
+void TraceTracker::stopStreaming()
+{
+	if(isStreaming() == false) return; //->
+
+	for(int particle_idx = 0; particle_idx <= int(m_runningTraceIdx_v.size())-1; particle_idx++)
+	{
+		if(m_runningTraceIdx_v[particle_idx] != -1) _closeTrace(particle_idx);
+	}
+
+	if(m_stream_buffer.size() != 0) m_stream_file.write(m_stream_buffer.data(), m_stream_buffer.size());
+	m_stream_buffer.clear();
+	m_stream_file.close();
+}
+
+bool TraceTracker::isStreaming() const
+{
+	return m_stream_file.is_open();
+}
+
+vector<Trace> TraceTracker::getAllTraces() const
+{
+	vector<Trace> traces = m_finishedTraces_v;
+	traces.reserve(traces.size() + m_nbRunningTraces);
+
+	for(int running_idx : m_runningTraceIdx_v)
+	{
+		if(running_idx != -1) traces.push_back(_materialiseTrace(m_runningTraces_v[running_idx]));
+	}
+
+	return traces;
+}
+
+vector<Trace> TraceTracker::takeAllTraces()
+{
+	vector<Trace> traces;
+	traces.swap(m_finishedTraces_v);
+	traces.reserve(traces.size() + m_nbRunningTraces);
+
+	for(int running_idx : m_runningTraceIdx_v)
+	{
+		if(running_idx != -1) traces.push_back(_materialiseTrace(m_runningTraces_v[running_idx]));
+	}
+
+	clear();
+	return traces;
+}
+
+int TraceTracker::getNbRunningTraces() const
+{
+	return m_nbRunningTraces;
+}
+
+int TraceTracker::getNbFinishedTraces() const
+{
+	return m_finishedTraces_v.size();
+}
+
+StatsAccumulator& TraceTracker::getLengthsStatsRef()
+{
+	return m_lengths_stats;
+}
+
+void TraceTracker::clear()
+{
+	m_runningTraceIdx_v.clear();
+	m_slotOwners_v.clear();
+
+	m_runningTraces_v.clear();
+	m_freeRunningTraces_v.clear();
+	m_nbRunningTraces = 0;
+
+	m_eventPlanes_v.clear();
+	m_eventXs_v.clear();
+	m_eventYs_v.clear();
+	m_eventNexts_v.clear();
+	m_nbDeadEvents = 0;
+
+	m_finishedTraces_v.clear();
+	m_lengths_stats.clear();
+}
+
+void TraceTracker::saveState(myBinaryWriter& writer, const vector<const void*>& slotParticles_v)
+{
+	enum SLOT_OWNER {NO_OWNER, SLOT_PARTICLE_OWNER, OTHER_OWNER};
+
+	int nb_slots = m_runningTraceIdx_v.size();
+	writer.write<int>(nb_slots);
+
+	vector<int> planes_v;
+	vector<float> xs_v, ys_v;
+	for(int particle_idx = 0; particle_idx <= nb_slots-1; particle_idx++)
+	{
+		const void* owner = m_slotOwners_v[particle_idx];
+		int slot_owner = OTHER_OWNER;
+		if(owner == 0) slot_owner = NO_OWNER;
+		else if(particle_idx < int(slotParticles_v.size()) && owner == slotParticles_v[particle_idx]) slot_owner = SLOT_PARTICLE_OWNER;
+		writer.write<int>(slot_owner);
+
+		//running trace, as contiguous columns
+		planes_v.clear();
+		xs_v.clear();
+		ys_v.clear();
+		int running_idx = m_runningTraceIdx_v[particle_idx];
+		int event_idx = (running_idx != -1 ? m_runningTraces_v[running_idx].first_event : -1);
+		while(event_idx != -1)
+		{
+			planes_v.push_back(m_eventPlanes_v[event_idx]);
+			xs_v.push_back(m_eventXs_v[event_idx]);
+			ys_v.push_back(m_eventYs_v[event_idx]);
+			event_idx = m_eventNexts_v[event_idx];
+		}
+
+		writer.write<bool>(running_idx != -1);
+		writer.writeVector(planes_v);
+		writer.writeVector(xs_v);
+		writer.writeVector(ys_v);
+	}
+
+	writer.write<int>(m_finishedTraces_v.size());
+	for(Trace& trace : m_finishedTraces_v) writer.writeVector(trace.getFluoEventVector());
+}
+
+bool TraceTracker::loadState(myBinaryReader& reader, const vector<const void*>& slotParticles_v)
+{
+	enum SLOT_OWNER {NO_OWNER, SLOT_PARTICLE_OWNER, OTHER_OWNER};
+
+	clear();
+
+	int nb_slots;
+	reader.read(nb_slots);
+	if(reader.isGood() == false || nb_slots < 0) return false; //->
+
+	beginPlane(nb_slots);
+
+	vector<int> planes_v;
+	vector<float> xs_v, ys_v;
+	for(int particle_idx = 0; particle_idx <= nb_slots-1 && reader.isGood(); particle_idx++)
+	{
+		int slot_owner;
+		bool isRunning;
+		reader.read(slot_owner);
+		reader.read(isRunning);
+		reader.readVector(planes_v);
+		reader.readVector(xs_v);
+		reader.readVector(ys_v);
+
+		//another owner only has to differ from every particle : the tracker itself is used
+		if(slot_owner == SLOT_PARTICLE_OWNER && particle_idx < int(slotParticles_v.size())) m_slotOwners_v[particle_idx] = slotParticles_v[particle_idx];
+		else if(slot_owner == NO_OWNER) m_slotOwners_v[particle_idx] = 0;
+		else m_slotOwners_v[particle_idx] = this;
+
+		if(isRunning == false || planes_v.empty()) continue; //<-
+		if(xs_v.size() != planes_v.size() || ys_v.size() != planes_v.size()) return false; //->
+
+		int running_idx = _startTrace(particle_idx);
+		runningTrace& running_trc = m_runningTraces_v[running_idx];
+		running_trc.first_event = m_eventPlanes_v.size();
+		for(uint event_idx = 0; event_idx < planes_v.size(); event_idx++)
+		{
+			m_eventPlanes_v.push_back(planes_v[event_idx]);
+			m_eventXs_v.push_back(xs_v[event_idx]);
+			m_eventYs_v.push_back(ys_v[event_idx]);
+			m_eventNexts_v.push_back(m_eventPlanes_v.size());
+		}
+		m_eventNexts_v.back() = -1;
+		running_trc.last_event = m_eventPlanes_v.size()-1;
+		running_trc.length = planes_v.size();
+	}
+
+	int nb_finishedTraces;
+	reader.read(nb_finishedTraces);
+	for(int trace_idx = 0; trace_idx <= nb_finishedTraces-1 && reader.isGood(); trace_idx++)
+	{
+		vector<FluoEvent> events_v;
+		reader.readVector(events_v);
+
+		Trace trace;
+		trace.setFluoEventVector(std::move(events_v));
+		m_finishedTraces_v.push_back(std::move(trace));
+	}
+
+	if(reader.isGood() == false)
+	{
+		cout<<"In TraceTracker::loadState : error (truncated or corrupted traces)\n";
+		clear();
+		return false; //->
+	}
+
+	return true;
+}
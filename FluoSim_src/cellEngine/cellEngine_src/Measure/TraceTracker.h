@@ -0,0 +1,119 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#ifndef TRACETRACKER_H
+#define TRACETRACKER_H
+
+#include "fstream"
+#include "string"
+#include "vector"
+
+#include "cellEngine_library_global.h"
+    #include "FluoEvent.h"
+    #include "Trace.h"
+    #include "StatsAccumulator.h"
+
+#include "toolBox_src/fileAndstring_manipulation/myBinaryFile.h"
+
+
+//incremental builder of trajectories :
+//	- the particles are addressed by a dense index (their rank in the particle list) instead of a map,
+//	- the events of the running traces are appended to shared columns (arena), chained per trace,
+//	- closed traces are materialised once and moved (or streamed to a file) rather than copied.
+//The owner pointer given with each index is only used to detect that a slot changed of particle :
+//when particles are added or deleted, rekeySlots moves the running traces to the new rank of their particle.
+
+class CELLENGINE_LIBRARYSHARED_EXPORT TraceTracker
+{
+public :
+
+	TraceTracker();
+	~TraceTracker();
+
+	void beginPlane(int nb_particles);
+	void addEvent(int particle_idx, const void* particle_adr, int plane, float x, float y);
+	void endTrace(int particle_idx, const void* particle_adr);
+	void rekeySlots(const std::vector<const void*>& slotParticles_v); //slotParticles_v[i] : current particle of rank i
+
+	bool startStreaming(std::string file_path, FLUOEVENT_FILE_FORMAT format = PALMTRACER_FORMAT, float dt = -1, float px = -1);
+	void stopStreaming(); //the running traces are closed and written too
+	bool isStreaming() const;
+
+	std::vector<Trace> getAllTraces() const; //copy of the finished and running traces
+	std::vector<Trace> takeAllTraces(); //the traces are moved out and the tracker is cleared
+	int getNbRunningTraces() const;
+	int getNbFinishedTraces() const;
+	StatsAccumulator& getLengthsStatsRef(); //lengths of the traces closed since the last clear, set its bins to get a histogram
+
+	void clear();
+
+	//checkpoint : slotParticles_v[i] is the current particle of rank i, the owners are saved relatively to it.
+	//The streaming is not part of the state (the traces already streamed stay in their file).
+	void saveState(myBinaryWriter& writer, const std::vector<const void*>& slotParticles_v);
+	bool loadState(myBinaryReader& reader, const std::vector<const void*>& slotParticles_v);
+
+private :
+
+	struct runningTrace
+	{
+		int first_event;
+		int last_event;
+		int length;
+	};
+
+	int _startTrace(int particle_idx);
+	void _closeTrace(int particle_idx);
+	Trace _materialiseTrace(const runningTrace& running_trc) const;
+	void _storeFinishedTrace(Trace& trace);
+	void _compactArena();
+
+private :
+
+//per particle slot
+	std::vector<int> m_runningTraceIdx_v; //-1 : no running trace
+	std::vector<const void*> m_slotOwners_v;
+
+//running traces
+	std::vector<runningTrace> m_runningTraces_v;
+	std::vector<int> m_freeRunningTraces_v;
+	int m_nbRunningTraces;
+
+//events arena (columns)
+	std::vector<int> m_eventPlanes_v;
+	std::vector<float> m_eventXs_v;
+	std::vector<float> m_eventYs_v;
+	std::vector<int> m_eventNexts_v; //next event of the same trace, -1 : last one
+	int m_nbDeadEvents;
+
+//finished traces
+	std::vector<Trace> m_finishedTraces_v;
+	StatsAccumulator m_lengths_stats;
+
+//streaming
+	std::ofstream m_stream_file;
+	FLUOEVENT_FILE_FORMAT m_stream_format;
+	float m_stream_dt;
+	float m_stream_px;
+	int m_nbStreamedTraces;
+	std::string m_stream_buffer;
+};
+
+
+#endif // TRACETRACKER_H
@@ -22,6 +22,12 @@
 
 #include "BiologicalWorld.h"
 
+#include "algorithm"
+#include "cstdint"
+#include "limits"
+#include "new"
+#include "thread"
+
 using namespace std;
 using namespace glm;
 
@@ -30,6 +36,11 @@ BiologicalWorld::BiologicalWorld()
 {
 	m_nextRgn_uId = 0;
 	m_isFixed = false;
+	m_kineticTable = 0;
+	m_kineticTable_dt = 0.0f;
+	m_isKineticTable_dirty = true;
+	m_isRegionLookup_dirty = true;
+	m_fluoStates_revision = 0;
 //	m_randomNumberFactory.generatePreCalcRandomNumbers();
 }
 
@@ -41,39 +52,82 @@ BiologicalWorld::~BiologicalWorld()
 void BiologicalWorld::addChemicalSpecie(ChemicalSpecies specie)
 {
 	m_species.push_back(specie);
-
+	m_isKineticTable_dirty = true;
 }
 
 void BiologicalWorld::addChemicalSpecie(string spc_name, vec4 color)
 {
 
     m_species.push_back(ChemicalSpecies(spc_name, color));
-
+	m_isKineticTable_dirty = true;
 }
 
 void BiologicalWorld::addFluorophoreSpecie(float k_on, float k_off)
 {
     m_fluo_species.push_back(FluorophoreSpecies(k_on, k_off));
+	m_fluoStates_revision++;
 }
 
 
 void BiologicalWorld::addRegion(vector<vec2> r)
 {
-	m_regions.emplace_back(m_region_r_mv, m_region_r_gmv, r);
-	for(auto &spc : m_species)
+	vector<vector<vec2> > rgns_v(1, r);
+	addRegions(rgns_v);
+}
+
+void BiologicalWorld::addRegions(vector<vector<vec2> >& rgns_v)
+{
+	if(rgns_v.empty()) return; //->
+
+	vector<Region*> added_rgns_v;
+	for(vector<vec2>& r : rgns_v)
 	{
-		m_regions.back().addDynamicParam(&spc);
+		m_regions.emplace_back(m_region_r_mv, r);
+		Region& rgn = m_regions.back();
+		for(auto &spc : m_species)
+		{
+			rgn.addDynamicParam(&spc);
+		}
+		rgn.setName("region_"+to_string(m_nextRgn_uId));
+
+		added_rgns_v.push_back(&rgn);
+		m_nextRgn_uId++;
 	}
 
-	for(Particle& ptcl : m_particles)
+	//one tower per particle and per added region : o(vertices) each, the particles are split among the threads
+	int nb_particles = m_particles.size();
+	int nb_threads = std::thread::hardware_concurrency();
+	if(nb_threads < 1 || (long long) nb_particles*added_rgns_v.size() < 10000) nb_threads = 1;
+
+	if(nb_threads == 1) _addTowers(m_particles.begin(), m_particles.end(), &added_rgns_v);
+	else
 	{
-		ptcl.addTower(&m_regions.back());
+		vector<thread> threads_v;
+		int nb_particle_per_thread = nb_particles/nb_threads;
+		auto particle_beg = m_particles.begin();
+		for(int thread_idx = 0; thread_idx <= nb_threads-1; thread_idx++)
+		{
+			auto particle_end = particle_beg;
+			if(thread_idx == nb_threads-1) particle_end = m_particles.end();
+			else advance(particle_end, nb_particle_per_thread);
+
+			threads_v.push_back(thread(&BiologicalWorld::_addTowers, particle_beg, particle_end, &added_rgns_v));
+			particle_beg = particle_end;
+		}
+		for(thread& t : threads_v) t.join();
 	}
 
-	Region& rgn = m_regions.back();
-	rgn.setName("region_"+to_string(m_nextRgn_uId));
+	m_isKineticTable_dirty = true;
+	m_isRegionLookup_dirty = true;
+}
 
-	m_nextRgn_uId++;
+void BiologicalWorld::_addTowers(list<Particle>::iterator particle_beg, list<Particle>::iterator particle_end,
+								 vector<Region*>* rgns_v)
+{
+	for(auto particle = particle_beg; particle != particle_end; particle++)
+	{
+		for(Region* rgn : *rgns_v) particle->addTower(rgn);
+	}
 }
 
 void BiologicalWorld::setIsACompartment(int rgn_idx, int spc_idx, bool new_state)
@@ -110,6 +164,8 @@ bool BiologicalWorld::deleteRegion(Region* rgn_adr)
 	advance(rgn_it, rgn_idx);
 
 	m_regions.erase(rgn_it);
+	m_isKineticTable_dirty = true;
+	m_isRegionLookup_dirty = true;
 
 	if(m_regions.size() == 0) m_nextRgn_uId = 0;
 	return true;
@@ -156,6 +212,7 @@ void BiologicalWorld::addParticles(int n, int rgn_idx, int spc_idx, int fluoSpec
 			m_particles.back().addTower(&rgn);
 		}
 	}
+	m_fluoStates_revision++;
 }
 
 void BiologicalWorld::addParticles(int n, int associatedRgn_idx, int creationRgn_idx,
@@ -201,6 +258,7 @@ void BiologicalWorld::addParticles(int n, int associatedRgn_idx, int creationRgn
 			m_particles.back().addTower(&rgn);
 		}
 	}
+	m_fluoStates_revision++;
 }
 
 
@@ -249,6 +307,7 @@ void BiologicalWorld::addParticles(int n, int associatedRgn_idx, int creationRgn
 			m_particles.back().addTower(&rgn);
 		}
 	}
+	m_fluoStates_revision++;
 }
 
 void BiologicalWorld::addParticles(int n, int associatedRgn_idx, int creationRgn_idx,
@@ -302,6 +361,7 @@ void BiologicalWorld::addParticles(int n, int associatedRgn_idx, int creationRgn
 			m_particles.back().addTower(&rgn);
 		}
 	}
+	m_fluoStates_revision++;
 }
 
 
@@ -329,6 +389,7 @@ void BiologicalWorld::deleteParticlesWithMotherRgn(int n, int rgn_idx, int spc_i
 			part++;
 			m_particles.erase(current_part);
 			nb_deleted_prtl++;
+			m_fluoStates_revision++;
 		}
 		else
 		{
@@ -359,6 +420,7 @@ void BiologicalWorld::deleteParticlesInRelationWith(int rgn_idx, int spc_idx)
 			auto current_part = part;
 			part++;
 			m_particles.erase(current_part);
+			m_fluoStates_revision++;
 		}
 		else part++;
 	}
@@ -398,20 +460,7 @@ void BiologicalWorld::renderBiologicalWorld(ScreenHandler &screen_handler, int r
 		screen_handler.addParticles(m_particles, pointingAccuracy_px);
 
 	if(renderedTypes & (int) REGION_BIT)
-	{
-        list<Region*> rgns;
-        for(Region& rgn : m_regions) //so that highlighted regions are displayed last
-        {
-            if(rgn.isHighlighted() == true)
-                rgns.push_back(&rgn);
-            else
-                rgns.push_front(&rgn);
-        }
-        for(Region* rgn : rgns)
-		{
-            rgn->render((myGLObject*) screen_handler.getRenderWindow());
-		}
-	}
+		m_region_renderer.render(m_regions, (myGLObject*) screen_handler.getRenderWindow());
 
 //		screen_handler.addRegions(m_regions, 1);
 
@@ -434,6 +483,11 @@ void BiologicalWorld::renderBiologicalWorld(ScreenHandler &screen_handler, int r
 
 }
 
+void BiologicalWorld::accumulateLocalisations(SRIAccumulator& accumulator, int plane)
+{
+	accumulator.accumulate(m_particles, plane);
+}
+
 void BiologicalWorld::fitBiologicalWorld(ScreenHandler &screen_handler)
 {
 	bool isBottomLeft_set = false;
@@ -517,6 +571,7 @@ void BiologicalWorld::setD(int rgn_idx, int specie_idx, float D)
 
     ChemicalSpecies* specie = getSpecieAdr(specie_idx);
 	Region* child_rgn = &getRegionRef(rgn_idx);
+	_updateKineticParam(*child_rgn, *specie);
 
 	for(auto& ptcl : m_particles)
 	{
@@ -542,6 +597,7 @@ void BiologicalWorld::setTrappingAbundant(int rgn_idx, int specie_idx,
 
     ChemicalSpecies* specie = getSpecieAdr(specie_idx);
 	Region* child_rgn = &getRegionRef(rgn_idx);
+	_updateKineticParam(*child_rgn, *specie);
 
 	for(auto& ptcl : m_particles)
 	{
@@ -568,6 +624,7 @@ void BiologicalWorld::setTrappingNAbundant(int rgn_idx, int specie_idx,
 
     ChemicalSpecies* specie = getSpecieAdr(specie_idx);
 	Region* child_rgn = &getRegionRef(rgn_idx);
+	_updateKineticParam(*child_rgn, *specie);
 
 	for(auto& ptcl : m_particles)
 	{
@@ -585,6 +642,7 @@ void BiologicalWorld::setCrossing(int rgn_idx, int spc_idx, float p_crossing_ins
     ChemicalSpecies* spc = getSpecieAdr(spc_idx);
 
 	rgn.setCrossing(spc, p_crossing_insideOut, p_crossing_outsideIn);
+	_updateKineticParam(rgn, *spc);
 }
 
 void BiologicalWorld::setImmobileFraction(int spc_idx, float immobile_fraction, bool withChecking)
@@ -610,6 +668,11 @@ void BiologicalWorld::setFixation(bool isFixed)
 	m_isFixed = isFixed;
 }
 
+void BiologicalWorld::setRandomSeed(unsigned int seed)
+{
+	m_randomNumberFactory.setSeed(seed);
+}
+
 bool BiologicalWorld::isFixed()
 {
 	return m_isFixed;
@@ -685,11 +748,12 @@ float BiologicalWorld::getParticleDensity(int rgn_idx, int spc_idx, bool wVisibi
 
     Region* rgn = &getRegionRef(rgn_idx);
     ChemicalSpecies* spc = getSpecieAdr(spc_idx);
+    updateRegionLookup(); //lookup index = rgn_idx
 
     for(Particle& particle : m_particles)
     {
         if(particle.getSpecie() == spc &&
-           particle.isInside(rgn) == true &&
+           (particle.m_mother_rgn == rgn || particle.isInsideRgnIdx(rgn_idx) == true) &&
            (!wVisibility || wVisibility && particle.getFluorophore()->getIntensity()))
         {
             nb_particles++;
@@ -720,79 +784,390 @@ FluorophoreSpecies* BiologicalWorld::getFluoSpecieAdr(int fluoSpecie_idx)
 
 }
 
-void BiologicalWorld::updatePosition( float d_t, bool isPre_calc)
+static void fillKineticParam(myKineticParam& kinetic_param, const myDynamicParam& dyn_param, float d_t)
 {
-	for(auto it = m_particles.begin(); it!=m_particles.end(); ++it)
+	kinetic_param.isACompartment = dyn_param.isACompartment;
+	kinetic_param.isTrapping_enable = dyn_param.isTrapping_enable;
+	kinetic_param.areSites_abundant = dyn_param.areSites_abundant;
+	kinetic_param.isDDistributed = dyn_param.isDDistributed;
+	kinetic_param.D = dyn_param.D;
+	kinetic_param.Dt = dyn_param.Dt;
+	kinetic_param.poisson_mean = dyn_param.poisson_mean;
+	if(dyn_param.areSites_abundant == true) kinetic_param.p_on = dyn_param.kt_on_abundant*d_t;
+	else kinetic_param.p_on = dyn_param.kt_on_Nabundant*d_t;
+	kinetic_param.p_off = dyn_param.kt_off*d_t;
+	kinetic_param.p_crossing_insideOut = dyn_param.p_crossing_insideOut;
+	kinetic_param.p_crossing_outsideIn = dyn_param.p_crossing_outsideIn;
+}
+
+void BiologicalWorld::updateKineticTable(float d_t)
+{
+	bool isRebuildNeeded = m_isKineticTable_dirty || d_t != m_kineticTable_dt;
+	for(Region& rgn : m_regions)
 	{
-		(*it).updatePosition(d_t, isPre_calc, m_randomNumberFactory);
+		if(isRebuildNeeded == true) break; //->
+		isRebuildNeeded = rgn.m_areDynamicParams_modified;
 	}
+
+	if(isRebuildNeeded == false) return; //->
+	_buildKineticTable(d_t);
 }
 
-void BiologicalWorld::updateTrappingState(float d_t)
+void BiologicalWorld::_buildKineticTable(float d_t)
 {
-	for(Particle& ptcl : m_particles)
+	const uintptr_t cache_line_size = 64;
+
+	int nb_species = m_species.size();
+	int nb_entries = m_regions.size()*nb_species;
+	m_kineticTable_buffer.assign(nb_entries*sizeof(myKineticParam) + cache_line_size-1, 0);
+
+	uintptr_t table_address = (uintptr_t) m_kineticTable_buffer.data();
+	table_address = (table_address + cache_line_size-1) & ~(cache_line_size-1);
+	m_kineticTable = (myKineticParam*) table_address;
+	for(int entry_idx = 0; entry_idx < nb_entries; entry_idx++) new (m_kineticTable + entry_idx) myKineticParam();
+
+	int spc_idx = 0;
+	for(ChemicalSpecies& spc : m_species)
+	{
+		spc.m_kineticIdx = spc_idx;
+		spc_idx++;
+	}
+
+	int rgn_idx = 0;
+	for(Region& rgn : m_regions)
+	{
+		rgn.m_kineticParams = m_kineticTable + rgn_idx*nb_species;
+		rgn.m_nbKineticParams = nb_species;
+		rgn.m_areDynamicParams_modified = false;
+
+		for(ChemicalSpecies& spc : m_species)
+		{
+			auto dyn_param = rgn.m_dynamicParams_map.find(&spc);
+			if(dyn_param == rgn.m_dynamicParams_map.end()) continue; //<-
+
+			fillKineticParam(rgn.m_kineticParams[spc.m_kineticIdx], dyn_param->second, d_t);
+		}
+		rgn_idx++;
+	}
+
+	m_kineticTable_dt = d_t;
+	m_isKineticTable_dirty = false;
+}
+
+void BiologicalWorld::_updateKineticParam(Region& rgn, ChemicalSpecies& spc)
+{
+	//the particles D are updated right after a setter : the entry has to be up to date
+	if(m_isKineticTable_dirty == true || rgn.m_kineticParams == 0 || spc.m_kineticIdx < 0)
+	{
+		_buildKineticTable(m_kineticTable_dt);
+		return; //->
+	}
+
+	fillKineticParam(rgn.m_kineticParams[spc.m_kineticIdx], rgn.m_dynamicParams_map.at(&spc), m_kineticTable_dt);
+}
+
+static bool areSegmentsIntersecting(vec2 a1, vec2 a2, vec2 b1, vec2 b2)
+{
+	vec2 u = a2 - a1;
+	vec2 v = b2 - b1;
+	vec2 w = b1 - a1;
+
+	float D = u.x*v.y - u.y*v.x;
+	if(D == 0.0f) return false; //->
+
+	float t = (w.x*v.y - w.y*v.x)/D;
+	float s = (w.x*u.y - w.y*u.x)/D;
+
+	return (t >= 0.0f && t <= 1.0f && s >= 0.0f && s <= 1.0f);
+}
+
+void BiologicalWorld::updateRegionLookup()
+{
+	if(m_isRegionLookup_dirty == false) return; //->
+	_buildRegionLookup();
+}
+
+int BiologicalWorld::getParentRegionIdx(int rgn_idx)
+{
+	updateRegionLookup();
+	if(rgn_idx < 0 || rgn_idx >= int(m_regionParent_v.size())) return -1; //->
+
+	return m_regionParent_v[rgn_idx];
+}
+
+void BiologicalWorld::_buildRegionLookup()
+{
+	m_isRegionLookup_dirty = false;
+
+	m_regions_v.clear();
+	for(Region& rgn : m_regions)
 	{
-		if(ptcl.isImmobile() == true) continue;
+		rgn.m_regionIdx = m_regions_v.size();
+		m_regions_v.push_back(&rgn);
+	}
 
-		if(ptcl.isTrapped() == true)
+	//the indices have changed : membership masks are re-keyed from the towers
+	for(Particle& ptcl : m_particles) ptcl._rebuildMembership();
+
+	int nb_regions = m_regions_v.size();
+	m_regionParent_v.assign(nb_regions, -1);
+	m_gridCellStart_v.clear();
+	m_gridEntries_v.clear();
+	m_grid_size = ivec2(0,0);
+
+	if(nb_regions <= 1) return; //->
+
+	//bounding boxes
+	vector<vec2> bottomLeft_v(nb_regions, vec2(0,0));
+	vector<vec2> topRight_v(nb_regions, vec2(-1,-1)); //empty regions : top right < bottom left
+	vector<float> rgn_sizes;
+	vec2 world_bottomLeft, world_topRight;
+	bool isWorld_set = false;
+
+	for(int rgn_idx = 1; rgn_idx <= nb_regions-1; rgn_idx++)
+	{
+		Region& rgn = *m_regions_v[rgn_idx];
+		if(rgn.getBottomLeft(bottomLeft_v[rgn_idx]) == false) continue; //<-
+		rgn.getTopRight(topRight_v[rgn_idx]);
+
+		vec2 rgn_size = topRight_v[rgn_idx] - bottomLeft_v[rgn_idx];
+		rgn_sizes.push_back(std::max(rgn_size.x, rgn_size.y));
+
+		if(isWorld_set == false)
 		{
-			if(m_randomNumberFactory.uniformRandomNumber() <= ptcl.m_child_rgn->getKoff(ptcl.m_specie)* d_t)
+			world_bottomLeft = bottomLeft_v[rgn_idx];
+			world_topRight = topRight_v[rgn_idx];
+			isWorld_set = true;
+		}
+		world_bottomLeft = glm::min(world_bottomLeft, bottomLeft_v[rgn_idx]);
+		world_topRight = glm::max(world_topRight, topRight_v[rgn_idx]);
+	}
+
+	_buildRegionNestingTree(bottomLeft_v, topRight_v);
+
+	if(isWorld_set == false) return; //->
+
+	//about one typical region per cell, at most 512 cells per side
+	nth_element(rgn_sizes.begin(), rgn_sizes.begin() + rgn_sizes.size()/2, rgn_sizes.end());
+	vec2 world_size = world_topRight - world_bottomLeft;
+	float cell_size = rgn_sizes[rgn_sizes.size()/2];
+	cell_size = std::max(cell_size, std::max(world_size.x, world_size.y)/512.0f);
+	if(cell_size <= 0.0f) cell_size = 1.0f;
+
+	m_grid_origin = world_bottomLeft;
+	m_grid_invCellSize = 1.0f/cell_size;
+	m_grid_size = ivec2(int(world_size.x*m_grid_invCellSize) + 1, int(world_size.y*m_grid_invCellSize) + 1);
+
+	//(cell, entry) pairs, regions by decreasing index so that a stable sort keeps that order in each cell
+	vector<pair<int, myRegionGridEntry> > cellEntries_v;
+	vector<char> isBoundary_v;
+	vector<float> crossings_v;
+
+	for(int rgn_idx = nb_regions-1; rgn_idx >= 1; rgn_idx--)
+	{
+		Region& rgn = *m_regions_v[rgn_idx];
+		int nb_points = rgn.m_r.size();
+		if(nb_points == 0) continue; //<-
+
+		ivec2 cell_min = ivec2((bottomLeft_v[rgn_idx] - m_grid_origin)*m_grid_invCellSize);
+		ivec2 cell_max = ivec2((topRight_v[rgn_idx] - m_grid_origin)*m_grid_invCellSize);
+		cell_max = glm::min(cell_max, m_grid_size - 1);
+		ivec2 sub_size = cell_max - cell_min + 1;
+
+		//cells crossed by the boundary : edges sampled every half cell, then dilated to the 4 neighbours
+		//to catch the cells whose corner only is clipped
+		isBoundary_v.assign(sub_size.x*sub_size.y, 0);
+		for(int pt_idx = 0; pt_idx <= nb_points-1; pt_idx++)
+		{
+			vec2 r1 = rgn.m_r[pt_idx];
+			vec2 r2 = rgn.m_r[(pt_idx+1)%nb_points];
+			int nb_samples = int(2.0f*length(r2-r1)*m_grid_invCellSize) + 1;
+
+			for(int sample_idx = 0; sample_idx <= nb_samples; sample_idx++)
 			{
-				ptcl.m_trapped = false;
-				ptcl.m_child_rgn->deleteATrappedPrtlToNb(ptcl.m_specie);
-				ptcl.m_trappingStateChanged_flag = true;
+				vec2 r = r1 + (float(sample_idx)/nb_samples)*(r2-r1);
+				ivec2 cell = ivec2((r - m_grid_origin)*m_grid_invCellSize) - cell_min;
+
+				const ivec2 neighbours[5] = {{0,0}, {1,0}, {-1,0}, {0,1}, {0,-1}};
+				for(const ivec2& neighbour : neighbours)
+				{
+					ivec2 n_cell = cell + neighbour;
+					if(n_cell.x < 0 || n_cell.y < 0 || n_cell.x >= sub_size.x || n_cell.y >= sub_size.y) continue; //<-
+					isBoundary_v[n_cell.y*sub_size.x + n_cell.x] = 1;
+				}
 			}
-			return; //->
 		}
-		else
+
+		//the other cells are entirely inside or outside : even-odd scanline at the cell centers
+		for(int row = 0; row <= sub_size.y-1; row++)
 		{
-			Region* old_rgn = ptcl.m_child_rgn;
-			auto rgn = m_regions.rbegin();
-			auto mother_rgn = m_regions.rbegin();
-			advance(mother_rgn, getNbRegions() - 1 - getRegionIdx(ptcl.m_mother_rgn));
+			float y = m_grid_origin.y + (cell_min.y + row + 0.5f)*cell_size;
+
+			crossings_v.clear();
+			for(int pt_idx = 0; pt_idx <= nb_points-1; pt_idx++)
+			{
+				vec2 r1 = rgn.m_r[pt_idx];
+				vec2 r2 = rgn.m_r[(pt_idx+1)%nb_points];
+				if((r1.y <= y) == (r2.y <= y)) continue; //<-
+
+				crossings_v.push_back(r1.x + (y - r1.y)*(r2.x - r1.x)/(r2.y - r1.y));
+			}
+			sort(crossings_v.begin(), crossings_v.end());
 
-			while(rgn != mother_rgn)
+			int crossing_idx = 0;
+			for(int col = 0; col <= sub_size.x-1; col++)
 			{
-				if(rgn->isACompartment(ptcl.getSpecie()) && ptcl.isInside(&*rgn)) break;
-//				if(rgn->isACompartment(ptcl.getSpecie() && rgn->isInside(ptcl.m_r))) break;
-				rgn++;
+				float x = m_grid_origin.x + (cell_min.x + col + 0.5f)*cell_size;
+				while(crossing_idx < int(crossings_v.size()) && crossings_v[crossing_idx] <= x) crossing_idx++;
+
+				myRegionGridEntry entry = {rgn_idx, true};
+				if(isBoundary_v[row*sub_size.x + col] == 1) entry.isCovering = false;
+				else if(crossing_idx%2 == 0) continue; //<- outside
+
+				int cell_idx = (cell_min.y + row)*m_grid_size.x + cell_min.x + col;
+				cellEntries_v.push_back({cell_idx, entry});
 			}
+		}
+	}
+
+	//compressed rows
+	int nb_cells = m_grid_size.x*m_grid_size.y;
+	m_gridCellStart_v.assign(nb_cells + 1, 0);
+	for(auto& cell_entry : cellEntries_v) m_gridCellStart_v[cell_entry.first + 1]++;
+	for(int cell_idx = 0; cell_idx <= nb_cells-1; cell_idx++) m_gridCellStart_v[cell_idx+1] += m_gridCellStart_v[cell_idx];
+
+	vector<int> cellFill_v(m_gridCellStart_v.begin(), m_gridCellStart_v.end() - 1);
+	m_gridEntries_v.resize(cellEntries_v.size());
+	for(auto& cell_entry : cellEntries_v)
+	{
+		m_gridEntries_v[cellFill_v[cell_entry.first]] = cell_entry.second;
+		cellFill_v[cell_entry.first]++;
+	}
+}
+
+void BiologicalWorld::_buildRegionNestingTree(vector<vec2>& bottomLeft_v, vector<vec2>& topRight_v)
+{
+	//a region is nested in another one when its bounding box, its vertices are inside it and their edges don't cross
+	int nb_regions = m_regions_v.size();
+	vector<float> parent_area_v(nb_regions, std::numeric_limits<float>::max());
+
+	for(int inner_idx = 1; inner_idx <= nb_regions-1; inner_idx++)
+	{
+		Region& inner = *m_regions_v[inner_idx];
+		int nb_inner_points = inner.m_r.size();
+		if(nb_inner_points == 0) continue; //<-
 
-			ptcl.m_child_rgn = &(*rgn);
-			if(&(*rgn) == ptcl.m_mother_rgn) ptcl.m_child_rgn = ptcl.m_mother_rgn;
-			if(old_rgn != ptcl.m_child_rgn) ptcl.m_trappingStateChanged_flag = true;
+		for(int outer_idx = 1; outer_idx <= nb_regions-1; outer_idx++)
+		{
+			if(outer_idx == inner_idx) continue; //<-
+			if(glm::any(glm::lessThan(bottomLeft_v[inner_idx], bottomLeft_v[outer_idx])) ||
+			   glm::any(glm::greaterThan(topRight_v[inner_idx], topRight_v[outer_idx]))) continue; //<-
+
+			vec2 outer_size = topRight_v[outer_idx] - bottomLeft_v[outer_idx];
+			float outer_area = outer_size.x*outer_size.y;
+			if(outer_area >= parent_area_v[inner_idx]) continue; //<- a smaller parent has been found
 
+			Region& outer = *m_regions_v[outer_idx];
+			int nb_outer_points = outer.m_r.size();
 
-			if(ptcl.m_child_rgn->isTrappingActivated(ptcl.m_specie))
+			bool isNested = true;
+			for(int pt_idx = 0; pt_idx <= nb_inner_points-1 && isNested; pt_idx++)
 			{
-				float k_on;
-				if(ptcl.m_child_rgn->areSitesAbundant(ptcl.m_specie))
-				{
-					k_on = ptcl.m_child_rgn->getKonAbundant(ptcl.m_specie);
-				}
-				else
-				{
-					k_on = ptcl.m_child_rgn->getKonNAbundant(ptcl.m_specie) * ptcl.m_child_rgn->getCurrentSiteDensity(ptcl.m_specie);
-				}
+				isNested = outer.isInside(inner.m_r[pt_idx]);
+			}
 
-				if(m_randomNumberFactory.uniformRandomNumber() <= k_on* d_t)
+			for(int i = 0; i <= nb_inner_points-1 && isNested; i++)
+			{
+				for(int j = 0; j <= nb_outer_points-1 && isNested; j++)
 				{
-					ptcl.m_trapped = true;
-					ptcl.m_trappingStateChanged_flag = true;
-					ptcl.m_child_rgn->addTrappedPrtlToNb(ptcl.m_specie);
+					isNested = !areSegmentsIntersecting(inner.m_r[i], inner.m_r[(i+1)%nb_inner_points],
+														outer.m_r[j], outer.m_r[(j+1)%nb_outer_points]);
 				}
 			}
+
+			if(isNested == false) continue; //<-
+			m_regionParent_v[inner_idx] = outer_idx;
+			parent_area_v[inner_idx] = outer_area;
 		}
 	}
 }
 
+Region* BiologicalWorld::_findChildRegion(Particle& ptcl)
+{
+	Region* mother_rgn = ptcl.m_mother_rgn;
+	if(m_gridEntries_v.empty() == true) return mother_rgn; //->
+
+	ivec2 cell = ivec2(glm::floor((ptcl.m_r - m_grid_origin)*m_grid_invCellSize));
+	if(cell.x < 0 || cell.y < 0 || cell.x >= m_grid_size.x || cell.y >= m_grid_size.y) return mother_rgn; //->
+
+	int cell_idx = cell.y*m_grid_size.x + cell.x;
+	int mother_idx = mother_rgn->m_regionIdx;
+
+	//regions the particle is known to be outside of : their nested regions can be skipped
+	const int max_nb_missed = 8;
+	int missed_rgns[max_nb_missed];
+	int nb_missed = 0;
+
+	for(int entry_idx = m_gridCellStart_v[cell_idx]; entry_idx < m_gridCellStart_v[cell_idx+1]; entry_idx++)
+	{
+		const myRegionGridEntry& entry = m_gridEntries_v[entry_idx];
+		if(entry.rgn_idx <= mother_idx) break; //-> only the regions above the mother one are looked up
+
+		Region* rgn = m_regions_v[entry.rgn_idx];
+		if(rgn->getKineticParam(ptcl.m_specie).isACompartment == false) continue; //<-
+		if(entry.isCovering == true) return rgn; //->
+
+		bool isInsideMissedRgn = false;
+		for(int parent_idx = m_regionParent_v[entry.rgn_idx];
+			parent_idx != -1 && isInsideMissedRgn == false;
+			parent_idx = m_regionParent_v[parent_idx])
+		{
+			for(int missed_idx = 0; missed_idx <= nb_missed-1; missed_idx++)
+			{
+				if(missed_rgns[missed_idx] == parent_idx) isInsideMissedRgn = true;
+			}
+		}
+		if(isInsideMissedRgn == true) continue; //<-
+
+		if(ptcl.isInsideRgnIdx(entry.rgn_idx) == true) return rgn; //->
+		if(nb_missed < max_nb_missed)
+		{
+			missed_rgns[nb_missed] = entry.rgn_idx;
+			nb_missed++;
+		}
+	}
+
+	return mother_rgn;
+}
+
+void BiologicalWorld::updatePosition( float d_t, bool isPre_calc)
+{
+	updateKineticTable(d_t);
+
+	for(auto it = m_particles.begin(); it!=m_particles.end(); ++it)
+	{
+		(*it).updatePosition(d_t, isPre_calc, m_randomNumberFactory);
+	}
+}
+
+void BiologicalWorld::updateTrappingState(float d_t)
+{
+	updateKineticTable(d_t);
+	updateRegionLookup();
+
+	for(Particle& ptcl : m_particles)
+	{
+		updateTrappingState(d_t, ptcl, m_randomNumberFactory);
+	}
+}
+
 void BiologicalWorld::updateTrappingState(float d_t, Particle& ptcl, RandomNumberGenerator& randomNumberFactory)
 {
 	if(ptcl.isImmobile() == true) return;
 
 	if(ptcl.isTrapped() == true)
 	{
-		if(randomNumberFactory.uniformRandomNumber() <= ptcl.m_child_rgn->getKoff(ptcl.m_specie)* d_t)
+		if(randomNumberFactory.uniformRandomNumber() <= ptcl.m_child_rgn->getKineticParam(ptcl.m_specie).p_off)
 		{
 			ptcl.m_trapped = false;
 			ptcl.m_child_rgn->deleteATrappedPrtlToNb(ptcl.m_specie);
@@ -803,34 +1178,19 @@ void BiologicalWorld::updateTrappingState(float d_t, Particle& ptcl, RandomNumbe
 	else
 	{
 		Region* old_rgn = ptcl.m_child_rgn;
-		auto rgn = m_regions.rbegin();
-		auto mother_rgn = m_regions.rbegin();
-		advance(mother_rgn, getNbRegions() - 1 - getRegionIdx(ptcl.m_mother_rgn));
-
-		while(rgn != mother_rgn)
-		{
-			if(rgn->isACompartment(ptcl.getSpecie()) && ptcl.isInside(&*rgn)) break;
-			rgn++;
-		}
-
-		ptcl.m_child_rgn = &(*rgn);
-		if(&(*rgn) == ptcl.m_mother_rgn) ptcl.m_child_rgn = ptcl.m_mother_rgn;
+		ptcl.m_child_rgn = _findChildRegion(ptcl);
 		if(old_rgn != ptcl.m_child_rgn) ptcl.m_trappingStateChanged_flag = true;
 
-
-		if(ptcl.m_child_rgn->isTrappingActivated(ptcl.m_specie))
+		const myKineticParam& kinetic_param = ptcl.m_child_rgn->getKineticParam(ptcl.m_specie);
+		if(kinetic_param.isTrapping_enable)
 		{
-			float k_on;
-			if(ptcl.m_child_rgn->areSitesAbundant(ptcl.m_specie))
+			float p_on = kinetic_param.p_on;
+			if(kinetic_param.areSites_abundant == false)
 			{
-				k_on = ptcl.m_child_rgn->getKonAbundant(ptcl.m_specie);
-			}
-			else
-			{
-				k_on = ptcl.m_child_rgn->getKonNAbundant(ptcl.m_specie) * ptcl.m_child_rgn->getCurrentSiteDensity(ptcl.m_specie);
+				p_on *= ptcl.m_child_rgn->getCurrentSiteDensity(ptcl.m_specie);
 			}
 
-			if(randomNumberFactory.uniformRandomNumber() <= k_on* d_t)
+			if(randomNumberFactory.uniformRandomNumber() <= p_on)
 			{
 				ptcl.m_trapped = true;
 				ptcl.m_trappingStateChanged_flag = true;
@@ -842,6 +1202,8 @@ void BiologicalWorld::updateTrappingState(float d_t, Particle& ptcl, RandomNumbe
 
 void BiologicalWorld::updateD()
 {
+	updateKineticTable(m_kineticTable_dt);
+
 	for(auto& ptcl : m_particles)
 	{
 		ptcl.updateD(m_randomNumberFactory);
@@ -861,6 +1223,7 @@ int BiologicalWorld::getNbRegions()
 void BiologicalWorld::deleteAllParticles()
 {
 	m_particles.clear();
+	m_fluoStates_revision++;
 
 	list<Region>::iterator it_rgn = m_regions.begin();
     list<ChemicalSpecies>::iterator it_spc = m_species.begin();
@@ -908,5 +1271,189 @@ vector<vec2> BiologicalWorld::getParticlePositions()
 	return r_v;
 }
 
+template<typename T> static T* getStateAdr(const vector<T*>& adrs_v, int idx)
+{
+	return (idx >= 0 && idx < int(adrs_v.size()) ? adrs_v[idx] : 0);
+}
+
+void BiologicalWorld::saveState(myBinaryWriter& writer)
+{
+	//the pointers are saved as indices in the world lists, -1 : none
+	map<const Region*, int> rgnIdxs_map = {{0, -1}};
+	map<const ChemicalSpecies*, int> spcIdxs_map = {{0, -1}};
+	map<const FluorophoreSpecies*, int> fluoSpcIdxs_map = {{0, -1}};
+	int idx = 0;
+	for(Region& rgn : m_regions) rgnIdxs_map[&rgn] = idx++;
+	idx = 0;
+	for(ChemicalSpecies& spc : m_species) spcIdxs_map[&spc] = idx++;
+	idx = 0;
+	for(FluorophoreSpecies& fluo_spc : m_fluo_species) fluoSpcIdxs_map[&fluo_spc] = idx++;
+
+//world layout, checked at loading
+	writer.write<int>(m_regions.size());
+	writer.write<int>(m_species.size());
+	writer.write<int>(m_fluo_species.size());
+	for(Region& rgn : m_regions) writer.write<int>(rgn.getSize());
+
+//trap counts
+	for(Region& rgn : m_regions)
+	{
+		for(ChemicalSpecies& spc : m_species)
+		{
+			auto dynamicParam_it = rgn.m_dynamicParams_map.find(&spc);
+			writer.write<int>(dynamicParam_it != rgn.m_dynamicParams_map.end() ? dynamicParam_it->second.nb_trappedPtcl : -1);
+		}
+	}
+
+	m_randomNumberFactory.saveState(writer);
 
+//particles
+	writer.write<long long>(m_particles.size());
+	for(Particle& ptcl : m_particles)
+	{
+		writer.write(ptcl.m_r);
+		writer.write(ptcl.m_color);
+		writer.write<int>(ptcl.m_color_mode);
+		writer.write<int>(ptcl.m_cross_dir);
+		writer.write(ptcl.m_D);
+		writer.write(ptcl.m_trapped);
+		writer.write(ptcl.m_isImmobile);
+		writer.write(ptcl.m_trappingStateChanged_flag);
+		writer.write(ptcl.m_not_inside);
+		writer.write<int>(rgnIdxs_map[ptcl.m_mother_rgn]);
+		writer.write<int>(rgnIdxs_map[ptcl.m_child_rgn]);
+		writer.write<int>(spcIdxs_map[ptcl.m_specie]);
+		writer.write<int>(fluoSpcIdxs_map[ptcl.m_fluorophore.getFluoSpecie()]);
+		writer.write(ptcl.m_fluorophore.isBleached());
+		writer.write(ptcl.m_fluorophore.isBlinked());
+
+		writer.write<int>(ptcl.m_towers.size());
+		for(auto& rgn_tower : ptcl.m_towers)
+		{
+			const Tower& tower = rgn_tower.second;
+			writer.write<int>(rgnIdxs_map[rgn_tower.first]);
+			writer.write(tower.r);
+			writer.write(tower.radius_squared);
+			writer.write(tower.isSet);
+			writer.write(tower.isInsideRgn);
+			writer.write(tower.isToBe_recalculated);
+		}
+	}
+}
 
+bool BiologicalWorld::loadState(myBinaryReader& reader)
+{
+	vector<Region*> rgns_v;
+	vector<ChemicalSpecies*> spcs_v;
+	vector<FluorophoreSpecies*> fluoSpcs_v;
+	for(Region& rgn : m_regions) rgns_v.push_back(&rgn);
+	for(ChemicalSpecies& spc : m_species) spcs_v.push_back(&spc);
+	for(FluorophoreSpecies& fluo_spc : m_fluo_species) fluoSpcs_v.push_back(&fluo_spc);
+
+//world layout
+	int nb_rgns, nb_spcs, nb_fluoSpcs;
+	reader.read(nb_rgns);
+	reader.read(nb_spcs);
+	reader.read(nb_fluoSpcs);
+	bool isLayout_matching = (nb_rgns == int(rgns_v.size()) && nb_spcs == int(spcs_v.size()) && nb_fluoSpcs == int(fluoSpcs_v.size()));
+	for(int rgn_idx = 0; rgn_idx <= nb_rgns-1 && isLayout_matching; rgn_idx++)
+	{
+		int rgn_size;
+		reader.read(rgn_size);
+		if(rgn_size != rgns_v[rgn_idx]->getSize()) isLayout_matching = false;
+	}
+
+	if(reader.isGood() == false || isLayout_matching == false)
+	{
+		cout<<"In BiologicalWorld::loadState : error (the state was saved with another geometry or other species)\n";
+		return false; //->
+	}
+
+//trap counts
+	for(Region* rgn : rgns_v)
+	{
+		for(ChemicalSpecies* spc : spcs_v)
+		{
+			int nb_trappedPtcl;
+			reader.read(nb_trappedPtcl);
+
+			auto dynamicParam_it = rgn->m_dynamicParams_map.find(spc);
+			if(dynamicParam_it != rgn->m_dynamicParams_map.end()) dynamicParam_it->second.nb_trappedPtcl = nb_trappedPtcl;
+		}
+	}
+
+	if(m_randomNumberFactory.loadState(reader) == false) return false; //->
+
+//particles
+	long long nb_particles;
+	reader.read(nb_particles);
+	m_particles.clear();
+	m_fluoStates_revision++;
+	if(nb_particles > 0 && (rgns_v.empty() || spcs_v.empty() || fluoSpcs_v.empty())) nb_particles = -1;
+
+	bool areIdxs_valid = (nb_particles >= 0);
+	for(long long ptcl_idx = 0; ptcl_idx <= nb_particles-1 && reader.isGood() && areIdxs_valid; ptcl_idx++)
+	{
+		vec2 r;
+		reader.read(r);
+		m_particles.emplace_back(r, rgns_v[0], spcs_v[0], fluoSpcs_v[0]);
+		Particle& ptcl = m_particles.back();
+
+		int color_mode, cross_dir;
+		int motherRgn_idx, childRgn_idx, spc_idx, fluoSpc_idx;
+		bool isBleached, isBlinked;
+
+		reader.read(ptcl.m_color);
+		reader.read(color_mode);
+		reader.read(cross_dir);
+		reader.read(ptcl.m_D);
+		reader.read(ptcl.m_trapped);
+		reader.read(ptcl.m_isImmobile);
+		reader.read(ptcl.m_trappingStateChanged_flag);
+		reader.read(ptcl.m_not_inside);
+		reader.read(motherRgn_idx);
+		reader.read(childRgn_idx);
+		reader.read(spc_idx);
+		reader.read(fluoSpc_idx);
+		reader.read(isBleached);
+		reader.read(isBlinked);
+
+		ptcl.m_color_mode = Particle::COLOR_MODE(color_mode);
+		ptcl.m_cross_dir = CROSSING_DIRECTION(cross_dir);
+		ptcl.m_mother_rgn = getStateAdr(rgns_v, motherRgn_idx);
+		ptcl.m_child_rgn = getStateAdr(rgns_v, childRgn_idx);
+		ptcl.m_specie = getStateAdr(spcs_v, spc_idx);
+		ptcl.m_fluorophore.setFluoSpecie(getStateAdr(fluoSpcs_v, fluoSpc_idx));
+		ptcl.m_fluorophore.setBleached(isBleached);
+		ptcl.m_fluorophore.setBlinked(isBlinked);
+
+		int nb_towers;
+		reader.read(nb_towers);
+		for(int tower_idx = 0; tower_idx <= nb_towers-1; tower_idx++)
+		{
+			int rgn_idx;
+			Tower tower;
+			reader.read(rgn_idx);
+			reader.read(tower.r);
+			reader.read(tower.radius_squared);
+			reader.read(tower.isSet);
+			reader.read(tower.isInsideRgn);
+			reader.read(tower.isToBe_recalculated);
+
+			Region* rgn = getStateAdr(rgns_v, rgn_idx);
+			if(rgn != 0) ptcl.m_towers[rgn] = tower;
+		}
+		ptcl._rebuildMembership();
+
+		if(ptcl.m_mother_rgn == 0 || ptcl.m_child_rgn == 0 || ptcl.m_specie == 0) areIdxs_valid = false;
+	}
+
+	if(reader.isGood() == false || areIdxs_valid == false)
+	{
+		cout<<"In BiologicalWorld::loadState : error (truncated or corrupted particle data)\n";
+		m_particles.clear();
+		return false; //->
+	}
+
+	return true;
+}
@@ -30,15 +30,26 @@
 #include "toolBox_src/otherFunctions/otherFunctions.h"
 #include "Particle.h" //include Region_gpu
 #include "displayAndcontrol/ScreenHandler.h"
+#include "displayAndcontrol/RegionRenderer.h"
 #include "physicsEngine/RandomNumberGenerator.h"
+#include "Measure/SRIAccumulator.h"
 
 
+//cell of the region lookup grid : region whose boundary crosses the cell or which covers it entirely
+struct myRegionGridEntry
+{
+	int rgn_idx;
+	bool isCovering; //no polygon test needed
+};
+
 class CELLENGINE_LIBRARYSHARED_EXPORT BiologicalWorld
 {
     friend class DiffusionSubEngine;
     friend class Probe;
     friend class FrapHead;
     friend class myGPURessourceManager;
+    friend class SteadyStateCache;
+    friend class PhotophysicsSubEngine;
 
 public:
 
@@ -48,6 +59,7 @@ public:
     ~BiologicalWorld();
     void renderBiologicalWorld(ScreenHandler &screen_handler, int renderedTypes = ~0, float pointingAccuracy_pdx = -1);
     void fitBiologicalWorld(ScreenHandler &screen_handler);
+	void accumulateLocalisations(SRIAccumulator& accumulator, int plane); //CPU counterpart of the gaussian accumulation rendering
 
 	void saveRegions(string region_filePath, GEOMETRY_FILE_FORMAT format = METAMORPH_GEOMETRY_FILE_FORMAT);
 
@@ -69,6 +81,8 @@ public:
 	void addChemicalSpecie(std::string spc_name, glm::vec4 color);
 
 	void addRegion(std::vector<glm::vec2> r);
+	//all the regions are inserted first, the towers of the existing particles are then set in one parallel pass
+	void addRegions(std::vector<std::vector<glm::vec2> >& rgns_v);
 	void setIsACompartment(int rgn_idx, int spc_idx, bool new_state);
 
 	bool deleteRegion(Region* rgn);
@@ -82,6 +96,7 @@ public:
 	void setCrossing(int rgn_idx, int specie_idx, float p_crossing_insideOut, float p_crossing_outsideIn);
 	void setImmobileFraction(int spc_idx, float immobile_fraction, bool withChecking = true);
 	void setFixation(bool isFixed);
+	void setRandomSeed(unsigned int seed);
 	bool isFixed();
 
 	Region& getRegionRef(int rgn_idx);
@@ -89,16 +104,21 @@ public:
 	int getNextRegionUniqueId();
 	int getRegionIdx(Region* rgn);
 	int getRegionIdx(string rgn_name);
+	int getParentRegionIdx(int rgn_idx);
     int getNbRegions();
     float getParticleDensity(int rgn_idx, int spc_idx, bool wVisibility = false);
 
     FluorophoreSpecies* getFluoSpecieAdr(int fluoSpecie_idx);
     ChemicalSpecies* getSpecieAdr(int spc_idx);
 
+	void updateKineticTable(float d_t);
+	void updateRegionLookup();
+
 	void updatePosition(float d_t, bool isPre_calc);
 	void updateTrappingState(float d_t);
 	void updateD();
 
+    //per particle versions : updateKineticTable(d_t) and updateRegionLookup() have to be called before
     void updateTrappingState(float d_t, Particle& ptcl, RandomNumberGenerator& );
 	void updateD(Particle& ptcl);
 
@@ -106,8 +126,21 @@ public:
 	void setParticleColorMode(Particle::COLOR_MODE mode);
 	std::vector<glm::vec2> getParticlePositions();
 
+	//checkpoint of the particles (positions, trapping, fluorophores, towers), of the trap counts and of the random stream,
+	//the regions and species are not saved : the state is loaded in a world built from the same project
+	void saveState(myBinaryWriter& writer);
+	bool loadState(myBinaryReader& reader);
+
 private:
 
+	void _buildKineticTable(float d_t);
+	void _updateKineticParam(Region& rgn, ChemicalSpecies& spc);
+	void _buildRegionLookup();
+	static void _addTowers(std::list<Particle>::iterator particle_beg, std::list<Particle>::iterator particle_end,
+						   std::vector<Region*>* rgns_v);
+	void _buildRegionNestingTree(std::vector<glm::vec2>& bottomLeft_v, std::vector<glm::vec2>& topRight_v);
+	Region* _findChildRegion(Particle& ptcl);
+
 	int m_nextRgn_uId;
 
 	bool m_isFixed;
@@ -117,9 +150,29 @@ private:
     std::list<FluorophoreSpecies> m_fluo_species;
 
 	myMultiVector<glm::vec2> m_region_r_mv;
-	gstd::gMultiVector<glm::vec2> m_region_r_gmv;
+	RegionRenderer m_region_renderer;
 
     RandomNumberGenerator m_randomNumberFactory;
+
+	//dense (region, species) table of the dynamic parameters, row-major by region,
+	//stored in an over-allocated buffer so that the table starts on a cache line
+	std::vector<char> m_kineticTable_buffer;
+	myKineticParam* m_kineticTable;
+	float m_kineticTable_dt;
+	bool m_isKineticTable_dirty;
+
+	//child region lookup, the first region (the cell) is never looked up since it can't be above a mother region
+	std::vector<Region*> m_regions_v;
+	std::vector<int> m_regionParent_v; //nesting tree : smallest region containing each region, -1 if none
+	glm::vec2 m_grid_origin;
+	float m_grid_invCellSize;
+	glm::ivec2 m_grid_size;
+	std::vector<int> m_gridCellStart_v; //entries of cell i : [start_i, start_i+1[, by decreasing region idx
+	std::vector<myRegionGridEntry> m_gridEntries_v;
+	bool m_isRegionLookup_dirty;
+
+	//incremented when particles are added or deleted or when their fluorophores are photomanipulated
+	unsigned int m_fluoStates_revision;
 };
 
 
@@ -33,6 +33,7 @@ ChemicalSpecies::ChemicalSpecies(const string& name,const vec4& color)
 	m_color = color;
 	m_color_trapped = vec4(1,1,1,0);
 	m_immobileFraction = 0.0f;
+	m_kineticIdx = -1;
 }
 
 ChemicalSpecies::ChemicalSpecies(const string& name, const vec4& color, const vec4& color_trapped)
@@ -41,6 +42,7 @@ ChemicalSpecies::ChemicalSpecies(const string& name, const vec4& color, const ve
 	m_color = color;
 	m_color_trapped = color_trapped;
 	m_immobileFraction = 0.0f;
+	m_kineticIdx = -1;
 }
 
 
@@ -32,6 +32,8 @@
 
 class CELLENGINE_LIBRARYSHARED_EXPORT ChemicalSpecies
 {
+    friend class BiologicalWorld;
+
 public :
 
     ChemicalSpecies(const std::string& name,const glm::vec4& color);
@@ -48,6 +50,8 @@ public :
 	void setImmobileFraction(float immobile_fraction);
 	float getImmobileFraction();
 
+	int getKineticIdx() const{return m_kineticIdx;} //column in the biological world kinetic table
+
 
 private :
 
@@ -55,6 +59,7 @@ private :
 	glm::vec4 m_color;
 	glm::vec4 m_color_trapped;
 	float m_immobileFraction;
+	int m_kineticIdx;
 
 };
 
@@ -19,7 +19,10 @@
 */
 
 
+#include "thread"
+
 #include "FrapHead.h"
+#include "toolBox_src/developmentTools/myProfiler.h"
 
 using namespace std;
 using namespace glm;
@@ -38,10 +41,22 @@ void FrapHead::setRegion(Region* region)
 
 }
 
+Region* FrapHead::getRegion()
+{
+	return m_region;
+}
+
+FluorophoreSpecies* FrapHead::getFluoSpecie()
+{
+	return m_fluoSpecie;
+}
+
 
 
 void FrapHead::bleachRegion(float k_off, float delta_t)
 {
+	PROFILE_ZONE("frap bleaching");
+	m_bio_world->m_fluoStates_revision++;
 
 	for(Particle& ptcl : m_bio_world->m_particles)
 	{
@@ -63,6 +78,7 @@ void FrapHead::bleachRegion(float k_off, float delta_t)
 
 void FrapHead::bleachRegion()
 {
+	m_bio_world->m_fluoStates_revision++;
 	for(Particle& ptcl : m_bio_world->m_particles)
 	{
 		if(ptcl.getFluorophore()->isBleached() == true) continue;
@@ -79,12 +95,13 @@ void FrapHead::bleachRegion()
 
 void FrapHead::photoActivateRegion()
 {
+	m_bio_world->m_fluoStates_revision++;
 	for(Particle &ptcl : m_bio_world->m_particles)
 	{
 		if(ptcl.getFluorophore()->isBlinked() == false) continue;
 		//<-
 
-		if(ptcl.getFluoSpecie() == m_fluoSpecie && m_region->isInside(ptcl.getR()))
+		if(ptcl.getFluoSpecie() == m_fluoSpecie && ptcl.isInside(m_region))
 		{
 		   ptcl.getFluorophore()->setBlinked(false);
 		}
@@ -94,12 +111,15 @@ void FrapHead::photoActivateRegion()
 
 void FrapHead::photoActivateRegion(float k_on, float delta_t)
 {
+	PROFILE_ZONE("photoactivation");
+	m_bio_world->m_fluoStates_revision++;
+
 	for(Particle &ptcl : m_bio_world->m_particles)
 	{
 		if(ptcl.getFluorophore()->isBlinked() == false) continue;
 		//<-
 
-		if(ptcl.getFluoSpecie() == m_fluoSpecie && m_region->isInside(ptcl.getR()))
+		if(ptcl.getFluoSpecie() == m_fluoSpecie && ptcl.isInside(m_region))
 		{
 			float rdm_number = uniformDistributiion(float(0.0),float(1.0));
 			if(rdm_number < k_on* delta_t)
@@ -109,3 +129,79 @@ void FrapHead::photoActivateRegion(float k_on, float delta_t)
 		}
 	}
 }
+
+
+
+void FrapHead::bleachRegions(vector<FrapHead>& frapHeads_v, float k_off, float delta_t, vector<RandomNumberGenerator>& randomFactories_v)
+{
+	PROFILE_ZONE("frap bleaching");
+	_photoManipulateRegions(frapHeads_v, BLEACHING, k_off*delta_t, randomFactories_v);
+}
+
+void FrapHead::photoActivateRegions(vector<FrapHead>& frapHeads_v, float k_on, float delta_t, vector<RandomNumberGenerator>& randomFactories_v)
+{
+	PROFILE_ZONE("photoactivation");
+	_photoManipulateRegions(frapHeads_v, PHOTOACTIVATION, k_on*delta_t, randomFactories_v);
+}
+
+void FrapHead::_photoManipulateRegions(vector<FrapHead>& frapHeads_v, PHOTOMANIPULATION_TYPE type, float proba,
+									   vector<RandomNumberGenerator>& randomFactories_v)
+{
+	if(frapHeads_v.empty() || randomFactories_v.empty()) return; //->
+
+	list<Particle>& particles = frapHeads_v.front().m_bio_world->m_particles;
+	frapHeads_v.front().m_bio_world->m_fluoStates_revision++;
+	int nb_particles = particles.size();
+
+	//below a few thousand particles, spawning the threads costs more than the sweep
+	int nb_threads = randomFactories_v.size();
+	if(nb_particles < 10000) nb_threads = 1;
+
+	if(nb_threads == 1)
+	{
+		_photoManipulateParticles(frapHeads_v, type, proba, particles.begin(), particles.end(), randomFactories_v[0]);
+		return; //->
+	}
+
+	vector<thread> threads_v;
+	int nb_particle_per_thread = nb_particles/nb_threads;
+	auto particle_beg = particles.begin();
+	for(int thread_idx = 0; thread_idx <= nb_threads-1; thread_idx++)
+	{
+		auto particle_end = particle_beg;
+		if(thread_idx == nb_threads-1) particle_end = particles.end();
+		else advance(particle_end, nb_particle_per_thread);
+
+		threads_v.push_back(thread(&FrapHead::_photoManipulateParticles, ref(frapHeads_v), type, proba,
+								   particle_beg, particle_end, ref(randomFactories_v[thread_idx])));
+		particle_beg = particle_end;
+	}
+
+	for(thread& t : threads_v) t.join();
+}
+
+void FrapHead::_photoManipulateParticles(vector<FrapHead>& frapHeads_v, PHOTOMANIPULATION_TYPE type, float proba,
+										 list<Particle>::iterator particle_beg, list<Particle>::iterator particle_end,
+										 RandomNumberGenerator& random_factory)
+{
+	for(auto particle = particle_beg; particle != particle_end; particle++)
+	{
+		Fluorophore* fluorophore = particle->getFluorophore();
+
+		for(FrapHead& frapHead : frapHeads_v)
+		{
+			if(type == BLEACHING && fluorophore->isBleached() == true) break; //<-
+			if(type == PHOTOACTIVATION && fluorophore->isBlinked() == false) break; //<-
+
+			//the membership is given by the mask updated with the towers during the diffusion step
+			if(particle->getFluoSpecie() != frapHead.m_fluoSpecie ||
+			   particle->isInside(frapHead.m_region) == false) continue; //<-
+
+			if(random_factory.uniformRandomNumber() < proba)
+			{
+				if(type == BLEACHING) fluorophore->setBleached(true);
+				else fluorophore->setBlinked(false);
+			}
+		}
+	}
+}
@@ -22,11 +22,14 @@
 #define FRAPHEAD_H
 
 
+#include "vector"
+
 #include "cellEngine_library_global.h"
 
 #include "ChemicalSpecies.h"
 #include "BiologicalWorld.h"
 #include "Region_gpu.h"
+#include "physicsEngine/RandomNumberGenerator.h"
 
 
 class CELLENGINE_LIBRARYSHARED_EXPORT FrapHead
@@ -40,6 +43,27 @@ public :
 	void photoActivateRegion();
 	void photoActivateRegion(float k_on, float delta_t);
 
+	Region* getRegion();
+	FluorophoreSpecies* getFluoSpecie();
+
+	//fused photomanipulation : all the heads are processed in a single (multithreaded) sweep over the particles,
+	//one thread per random number generator. A particle inside several heads gets one draw per head, as when the
+	//heads are processed one after the other.
+	static void bleachRegions(std::vector<FrapHead>& frapHeads_v, float k_off, float delta_t,
+							  std::vector<RandomNumberGenerator>& randomFactories_v);
+	static void photoActivateRegions(std::vector<FrapHead>& frapHeads_v, float k_on, float delta_t,
+									 std::vector<RandomNumberGenerator>& randomFactories_v);
+
+
+private :
+
+	enum PHOTOMANIPULATION_TYPE {BLEACHING, PHOTOACTIVATION};
+
+	static void _photoManipulateRegions(std::vector<FrapHead>& frapHeads_v, PHOTOMANIPULATION_TYPE type, float proba,
+										std::vector<RandomNumberGenerator>& randomFactories_v);
+	static void _photoManipulateParticles(std::vector<FrapHead>& frapHeads_v, PHOTOMANIPULATION_TYPE type, float proba,
+										  std::list<Particle>::iterator particle_beg, std::list<Particle>::iterator particle_end,
+										  RandomNumberGenerator& random_factory);
 
 private :
 
@@ -37,6 +37,7 @@ long Particle::m_nbReflection = 0;
 
 Tower::Tower()
 {
+	isSet = false;
 }
 
 bool Tower::isInsideScope(const glm::vec2 &r) const
@@ -228,6 +229,10 @@ bool Particle::isInside(Region* rgn)
 {
 	if(rgn == m_mother_rgn) return true; //fastest way to know
 
+	//every particle carries a tower per region : the membership mask is up to date once the lookup is built
+	int rgn_idx = rgn->getRegionIdx();
+	if(rgn_idx != -1) return m_membership.test(rgn_idx); //->
+
     Tower& tower = m_towers[rgn];
 	if(tower.isSet == true)
 	{
@@ -391,41 +396,44 @@ void Particle::updatePosition(float delta_t, list<Region>& rgns_l, RandomNumberG
 
 	vec2 r_test;
 	float dr_length = length(d_r);
-	map<Region*, int> rgn_to_avoid;
-	list<Region*> close_rgns_l;
-
+	myEdgeToAvoid edge_to_avoid;
 
+	//kept from one call to the other : no heap allocation once their capacity has been reached
+	thread_local vector<Region*> close_rgns_v;
+	thread_local vector<Region*> close_trapped_rgns_v;
 
 	CROSSING_DIRECTION cross_dir;
 
 	while(dr_length)
 	{
 		r_test = m_r + d_r;
-		close_rgns_l.clear();
+		close_rgns_v.clear();
 //		dr_length = length(d_r);
 
 		if(isTrapped() == true)
 		{
-			if(m_towers[m_mother_rgn].isInsideScope(r_test) == false) close_rgns_l.push_back(m_mother_rgn);
+			if(m_towers[m_mother_rgn].isInsideScope(r_test) == false) close_rgns_v.push_back(m_mother_rgn);
 			if(m_child_rgn != m_mother_rgn &&
-			   m_towers[m_child_rgn].isInsideScope(r_test) == false) close_rgns_l.push_back(m_child_rgn);
+			   m_towers[m_child_rgn].isInsideScope(r_test) == false) close_rgns_v.push_back(m_child_rgn);
 
-			list<Region*> close_trapped_rgns_l;
+			close_trapped_rgns_v.clear();
 			for(Region& rgn : rgns_l)
 			{
 				if(m_towers[&rgn].isInsideScope(r_test) == false)
 				{
-					close_trapped_rgns_l.push_back(&rgn);
+					close_trapped_rgns_v.push_back(&rgn);
 				}
 			}
 
-			reflectParticle(*this, d_r, rgn_to_avoid, d_r, rgn_to_avoid, close_rgns_l, cross_dir, factory);
+			reflectParticle(*this, d_r, edge_to_avoid, d_r, edge_to_avoid, close_rgns_v, cross_dir, factory);
 			dr_length = length(d_r);
 
-			for(Region* rgn : close_trapped_rgns_l)
+			for(Region* rgn : close_trapped_rgns_v)
 			{
-				m_towers[rgn].r = m_r;
-                m_towers[rgn].radius_squared = (1-0.005)*rgn->getMaximumRadiusSquared(m_r, m_towers[rgn].isInsideRgn);//0.005 to avoid particle to be too close to the region
+				Tower& tower = m_towers[rgn];
+				tower.r = m_r;
+                tower.radius_squared = (1-0.005)*rgn->getMaximumRadiusSquared(m_r, tower.isInsideRgn);//0.005 to avoid particle to be too close to the region
+				_setMembership(rgn, tower.isInsideRgn);
 			}
 
 
@@ -436,17 +444,19 @@ void Particle::updatePosition(float delta_t, list<Region>& rgns_l, RandomNumberG
 			{
 				if(m_towers[&rgn].isInsideScope(r_test) == false)
 				{
-					close_rgns_l.push_back(&rgn);
+					close_rgns_v.push_back(&rgn);
 				}
 			}
 
-			reflectParticle(*this, d_r, rgn_to_avoid, d_r, rgn_to_avoid, close_rgns_l, cross_dir, factory);
+			reflectParticle(*this, d_r, edge_to_avoid, d_r, edge_to_avoid, close_rgns_v, cross_dir, factory);
 			dr_length = length(d_r);
 
-			for(Region* rgn : close_rgns_l)
+			for(Region* rgn : close_rgns_v)
 			{
-				m_towers[rgn].r = m_r;
-                m_towers[rgn].radius_squared = (1-0.005)*rgn->getMaximumRadiusSquared(m_r, m_towers[rgn].isInsideRgn);//0.005 to avoid particle to be too close from the region
+				Tower& tower = m_towers[rgn];
+				tower.r = m_r;
+                tower.radius_squared = (1-0.005)*rgn->getMaximumRadiusSquared(m_r, tower.isInsideRgn);//0.005 to avoid particle to be too close from the region
+				_setMembership(rgn, tower.isInsideRgn);
 			}
 		}
 
@@ -514,27 +524,66 @@ void Particle::updateD(RandomNumberGenerator& factory)
 
 	if(m_trappingStateChanged_flag == true)
 	{
+		const myKineticParam& kinetic_param = m_child_rgn->getKineticParam(m_specie);
 		if(m_trapped == true)
 		{
-			if(m_child_rgn->isDDistributed(m_specie) == true)
+			if(kinetic_param.isDDistributed == true)
 			{
-				float poisson_mean = m_child_rgn->getPoissonMean(m_specie);
+				float poisson_mean = kinetic_param.poisson_mean;
 				factory.setPoissonMean(poisson_mean);
-				m_D = m_child_rgn->getDtrapped(m_specie)*factory.poissonRandomNumber()/poisson_mean;
+				m_D = kinetic_param.Dt*factory.poissonRandomNumber()/poisson_mean;
 			}
 
-			else m_D = m_child_rgn->getDtrapped(m_specie);
+			else m_D = kinetic_param.Dt;
 
 		}
 		else
 		{
-			m_D = m_child_rgn->getD(m_specie);
+			m_D = kinetic_param.D;
 		}
 
 		m_trappingStateChanged_flag = false;
 	}
 }
 
+bool Particle::fastForward(float delta_t, int nb_steps, float safety_factor, int nb_regions, RandomNumberGenerator& factory)
+{
+	if(m_trappingStateChanged_flag == true) return false; //-> D not settled yet
+
+	if(m_fluorophore.isBleached() == false)
+	{
+		const FluorophoreSpecies* fluo_spc = m_fluorophore.getFluoSpecie();
+		float k_blink = m_fluorophore.isBlinked() ? fluo_spc->getKon() : fluo_spc->getKoff();
+		if(k_blink > 0) return false; //->
+	}
+
+	if(m_isImmobile == true) return true; //->
+	if(m_trapped == true) return false; //->
+
+	const myKineticParam& kinetic_param = m_child_rgn->getKineticParam(m_specie);
+	if(kinetic_param.isTrapping_enable == true && kinetic_param.p_on > 0) return false; //->
+
+	//clearance : distance to the closest region edge, the towers being disks free of edges
+	if(int(m_towers.size()) != nb_regions) return false; //->
+
+	float min_clearance = safety_factor*std::sqrt(4*m_D*nb_steps*delta_t);
+	float clearance = std::numeric_limits<float>::max();
+	for(auto& tower_it : m_towers)
+	{
+		const Tower& tower = tower_it.second;
+		clearance = std::min(clearance, std::sqrt(tower.radius_squared) - length(m_r - tower.r));
+		if(clearance < min_clearance) return false; //->
+	}
+
+	//the sum of nb_steps gaussian steps, kept inside the towers (the far tail is stepped instead)
+	vec2 d_r = std::sqrt(2*m_D*nb_steps*delta_t)*vec2(factory.gaussianRandomNumber(false),
+													   factory.gaussianRandomNumber(false));
+	if(dot(d_r, d_r) >= clearance*clearance) return false; //->
+
+	m_r += d_r;
+	return true;
+}
+
 void Particle::updatePhotophysicState(float delta_t, RandomNumberGenerator& factory)
 {
 	m_fluorophore.updatePhotophysicState(delta_t, factory);
@@ -567,18 +616,39 @@ void Particle::addTower(Region* rgn)
 	tower.r = m_r;
 	tower.radius_squared = rgn->getMaximumRadiusSquared(m_r, tower.isInsideRgn);
 	tower.isSet = true;
+	_setMembership(rgn, tower.isInsideRgn);
 }
 
 void Particle::removeTower(Region* rgn)
 {
 	m_towers.erase(rgn);
+	_setMembership(rgn, false);
+}
+
+void Particle::_setMembership(Region* rgn, bool isInside)
+{
+	int rgn_idx = rgn->getRegionIdx();
+	if(rgn_idx == -1) return; //-> picked up by the next lookup rebuild
+
+	m_membership.set(rgn_idx, isInside);
+}
+
+void Particle::_rebuildMembership()
+{
+	m_membership.clear();
+	for(auto& rgn_tower : m_towers)
+	{
+		const Tower& tower = rgn_tower.second;
+		if(tower.isSet == true) _setMembership(rgn_tower.first, tower.isInsideRgn);
+	}
 }
 
-void reflectParticle(Particle& ptcl, vec2 dr_start, map<Region*, int> rgns_to_avoid_start,
-					 vec2& dr_end, map<Region*, int>& rgns_to_avoid_end, list<Region*> rgns_l,
+void reflectParticle(Particle& ptcl, vec2 dr_start, const myEdgeToAvoid& edge_to_avoid_start,
+					 vec2& dr_end, myEdgeToAvoid& edge_to_avoid_end, const vector<Region*>& rgns_v,
 					 CROSSING_DIRECTION& cross_dir_end, RandomNumberGenerator& factory)
 {
-	rgns_to_avoid_end.clear();
+	const myEdgeToAvoid avoided_edge = edge_to_avoid_start; //start and end can be the same object
+	edge_to_avoid_end = myEdgeToAvoid();
 
 	vec2 r_start = ptcl.getR();
 	vec2 r_end;
@@ -595,25 +665,18 @@ void reflectParticle(Particle& ptcl, vec2 dr_start, map<Region*, int> rgns_to_av
 	Region* intersected_rgn = 0;
 	bool hasIntersected = false;
 
-	for(Region* rgn : rgns_l)
+	for(Region* rgn : rgns_v)
 	{
 		float temp_t_end = -1;
 
-		map<Region*, int>::iterator rgn_to_avoid = rgns_to_avoid_start.find(rgn);
-		if(rgn_to_avoid != rgns_to_avoid_start.end()) edge_to_avoid = rgns_to_avoid_start[rgn];
+		if(rgn == avoided_edge.rgn) edge_to_avoid = avoided_edge.edge_idx;
 		else edge_to_avoid = -1;
 
-		if(rgn->isACompartment(specie) &&
+		if(rgn->getKineticParam(specie).isACompartment &&
 		   rgn->intersect(r_start, dr_start, edge_to_avoid, temp_t_end, temp_intersected_edge, temp_cross_dir) == true)
 		{
-//			if(temp_t_end == t_end)
-//			{
-//				rgns_to_avoid_end[rgn] = temp_intersected_edge;
-//			}
 			if(temp_t_end < t_end)
 			{
-				rgns_to_avoid_end.clear();
-
 				t_end = temp_t_end;
 				hasIntersected = true;
 				intersected_rgn = rgn;
@@ -621,7 +684,8 @@ void reflectParticle(Particle& ptcl, vec2 dr_start, map<Region*, int> rgns_to_av
 				cross_dir = temp_cross_dir;
 				cross_dir_end = temp_cross_dir;
 
-				rgns_to_avoid_end[rgn] = temp_intersected_edge;
+				edge_to_avoid_end.rgn = rgn;
+				edge_to_avoid_end.edge_idx = temp_intersected_edge;
 			}
 		}
 	}
@@ -631,12 +695,16 @@ void reflectParticle(Particle& ptcl, vec2 dr_start, map<Region*, int> rgns_to_av
 	{
 		ptcl.m_nbReflection++;
 
-		map<Region*, int>::iterator rgn_to_avoid = rgns_to_avoid_start.find(intersected_rgn);
-		if(rgn_to_avoid != rgns_to_avoid_start.end()) edge_to_avoid = rgns_to_avoid_start[intersected_rgn];
+		if(intersected_rgn == avoided_edge.rgn) edge_to_avoid = avoided_edge.edge_idx;
 		else edge_to_avoid = -1;
 
-		float p_crossing = intersected_rgn->getCrossing(specie, cross_dir); //particle not trapped
-		if(ptcl.isTrapped() == true) p_crossing = 0.0f; //particle is trapped
+		float p_crossing = 0.0f; //particle is trapped
+		if(ptcl.isTrapped() == false)
+		{
+			const myKineticParam& kinetic_param = intersected_rgn->getKineticParam(specie);
+			if(cross_dir == INOUT_CROSSING) p_crossing = kinetic_param.p_crossing_insideOut;
+			else p_crossing = kinetic_param.p_crossing_outsideIn;
+		}
 		intersected_rgn->reflect(r_start, dr_start, edge_to_avoid, r_end, dr_end, edge_to_avoid, factory, p_crossing);
 	}
 
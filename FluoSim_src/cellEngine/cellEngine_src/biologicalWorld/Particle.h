@@ -31,14 +31,56 @@
 #include "toolBox_src/toolBox_library_global.h"
     #include "toolBox_src/otherFunctions/otherFunctions.h"
 #include <list>
+#include "stdint.h"
 
 #include "physicsEngine/RandomNumberGenerator.h"
 #include "Measure/Trace.h"
 
+//regions a particle lies in, bit i standing for the region of lookup index i (Region::getRegionIdx())
+class myRegionMask
+{
+public :
+
+	myRegionMask() : m_bits(0) {}
+
+	void clear() {m_bits = 0; m_extraBits_v.clear();}
+	void set(int rgn_idx, bool isInside)
+	{
+		uint64_t* word = &m_bits;
+		if(rgn_idx >= 64)
+		{
+			size_t word_idx = rgn_idx/64 - 1;
+			if(word_idx >= m_extraBits_v.size())
+			{
+				if(isInside == false) return; //->
+				m_extraBits_v.resize(word_idx+1, 0);
+			}
+			word = &m_extraBits_v[word_idx];
+		}
+
+		uint64_t bit = uint64_t(1) << (rgn_idx%64);
+		if(isInside) *word |= bit;
+		else *word &= ~bit;
+	}
+	bool test(int rgn_idx) const
+	{
+		if(rgn_idx < 64) return (m_bits >> rgn_idx) & 1; //->
+
+		size_t word_idx = rgn_idx/64 - 1;
+		return word_idx < m_extraBits_v.size() && ((m_extraBits_v[word_idx] >> (rgn_idx%64)) & 1);
+	}
+
+private :
+
+	uint64_t m_bits; //regions 0 to 63 : no heap allocation in the common case
+	std::vector<uint64_t> m_extraBits_v;
+};
+
 class Tower
 {
     friend class Particle;
     friend class BiologicalWorld;
+    friend class SteadyStateCache;
 
 public :
 
@@ -60,6 +102,7 @@ class CELLENGINE_LIBRARYSHARED_EXPORT Particle
 {
  friend class BiologicalWorld;
  friend class Probe;
+ friend class SteadyStateCache;
 
 public:
 
@@ -71,7 +114,7 @@ public:
                ChemicalSpecies* specie, FluorophoreSpecies* fluoSpecie, bool isTrapped = false);
     Particle(Region* associated_region, Region* creation_region, Region* forbidden_region,
                ChemicalSpecies* specie, FluorophoreSpecies* fluoSpecie, bool isTrapped = false);
-    Particle(Region* associated_region, Region* creation_region, vector<Region*> forbidden_regions,
+    Particle(Region* associated_region, Region* creation_region, std::vector<Region*> forbidden_regions,
                ChemicalSpecies* specie, FluorophoreSpecies* fluoSpecie, bool isTrapped = false);
 
 	void setR(glm::vec2 r);
@@ -94,14 +137,19 @@ public:
     const FluorophoreSpecies* getFluoSpecie();
 
     void updatePosition(float delta_t, bool pre_calc, RandomNumberGenerator& randomFactory);
-    void updatePosition(float delta_t, list<Region>& rgns_l, RandomNumberGenerator& factory);
+    void updatePosition(float delta_t, std::list<Region>& rgns_l, RandomNumberGenerator& factory);
     void updateTrappingState(float delta_t, std::list<Region>& regions, RandomNumberGenerator& factory);
     void updatePhotophysicState(float delta_t, RandomNumberGenerator& factory);
     void updateD(RandomNumberGenerator& factory);
+	//replaces nb_steps updates by a single diffusion jump, only if no trapping, D or blinking event can happen
+	//and if every region edge is farther than safety_factor*sqrt(4*D*nb_steps*delta_t), returns false otherwise
+	bool fastForward(float delta_t, int nb_steps, float safety_factor, int nb_regions, RandomNumberGenerator& factory);
 
     ChemicalSpecies* getSpecie();
     bool isTrapped();
 	bool isInside(Region* rgn);
+	//read-only membership test by lookup index, kept up to date by the tower bookkeeping
+	bool isInsideRgnIdx(int rgn_idx) const {return m_membership.test(rgn_idx);}
     Fluorophore* getFluorophore();
     float getIntensity();
 
@@ -116,7 +164,11 @@ private:
 
 
 
+	void _setMembership(Region* rgn, bool isInside);
+	void _rebuildMembership();
+
     std::map<Region*, Tower> m_towers;
+    myRegionMask m_membership; //mirrors the towers isInsideRgn flags
 
     bool m_trapped;
 	COLOR_MODE m_color_mode;
@@ -141,10 +193,17 @@ private:
 };
 
 
+//edge the particle has just been reflected on (or crossed), it must not be intersected again
+struct myEdgeToAvoid
+{
+	Region* rgn = 0;
+	int edge_idx = -1;
+};
+
 CELLENGINE_LIBRARYSHARED_EXPORT
-void reflectParticle(Particle& ptcl, glm::vec2 dr_start, map<Region*, int> rgns_to_avoid_start,
-					 glm::vec2& dr_end, map<Region*, int>& rgns_to_avoid_end,
-					 list<Region*> rgns_l,  CROSSING_DIRECTION& cross_dir,
+void reflectParticle(Particle& ptcl, glm::vec2 dr_start, const myEdgeToAvoid& edge_to_avoid_start,
+					 glm::vec2& dr_end, myEdgeToAvoid& edge_to_avoid_end,
+					 const std::vector<Region*>& rgns_v,  CROSSING_DIRECTION& cross_dir,
                      RandomNumberGenerator& factory);
 
 
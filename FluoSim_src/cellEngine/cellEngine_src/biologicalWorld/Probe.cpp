@@ -20,7 +20,10 @@
 
 
 
+#include "thread"
+
 #include "Probe.h"
+#include "toolBox_src/developmentTools/myProfiler.h"
 
 using namespace std;
 using namespace glm;
@@ -29,8 +32,8 @@ using namespace glm;
 
 Probe::Probe()
 {
-
-
+	m_randomFactories_v = NULL;
+	m_traceTracker_revision = 0;
 }
 
 Probe::Probe(BiologicalWorld* bio_world)
@@ -42,6 +45,9 @@ Probe::Probe(BiologicalWorld* bio_world)
 
 	m_specie1 = NULL;
 	m_specie2 = NULL;
+
+	m_randomFactories_v = NULL;
+	m_traceTracker_revision = 0;
 }
 
 void Probe::setBiologicalWorld(BiologicalWorld* bio_world)
@@ -77,11 +83,154 @@ void Probe::setMeasureType(measureType measure_type)
 void Probe::setGaussianBeamParam(myGaussianBeamParams &gaussianBeam_params)
 {
 	m_gaussianBeam_params = gaussianBeam_params;
+	_computeGaussianBeamLookup();
+}
+
+void Probe::setRandomFactories(vector<RandomNumberGenerator>* randomFactories_v)
+{
+	m_randomFactories_v = randomFactories_v;
+}
+
+void Probe::_computeGaussianBeamLookup()
+{
+	const int table_size = 4096;
+	myGaussianBeamLookup& lookup = m_gaussianBeam_lookup;
+
+	float sigma = m_gaussianBeam_params.sigma;
+	float noise_cutOff = m_gaussianBeam_params.noise_cutOff;
+
+	lookup.inv_twoSigmaSquared = 1.0f/(2.0f*sigma*sigma);
+
+	//cut-off : exp(-r²/2s²) = noise_cutOff/100  <=> r² = 2*log(100/noise_cutOff)*s²
+	lookup.isCutOff = (noise_cutOff != 0);
+	if(lookup.isCutOff)
+	{
+		lookup.cutOff_radiusSquared = 2.0f*log(100.0f/noise_cutOff)*sigma*sigma;
+		lookup.cutOff_radius = std::sqrt(std::max(lookup.cutOff_radiusSquared, 0.0f));
+	}
+	else
+	{
+		lookup.cutOff_radiusSquared = -1;
+		lookup.cutOff_radius = -1;
+	}
+
+	//beyond table_maxX the gaussian is below 1e-7 and exp() is called directly
+	lookup.table_maxX = 16.0f;
+	lookup.table_invStep = (table_size-1)/lookup.table_maxX;
+	lookup.expTable_v.resize(table_size+1);
+	for(int x_idx = 0; x_idx <= table_size; x_idx++)
+	{
+		lookup.expTable_v[x_idx] = exp(-x_idx/lookup.table_invStep);
+	}
+}
+
+float Probe::_measureInGaussianBeam(float dt)
+{
+	list<Particle>& particles = m_bio_world->m_particles;
+	int nb_particles = particles.size();
+	if(m_gaussianBeam_params.koff >= 0 && dt >= 0) m_bio_world->m_fluoStates_revision++; //bleaching beam
+
+	int nb_threads = 1;
+	if(m_randomFactories_v != NULL && nb_particles >= 10000) nb_threads = m_randomFactories_v->size();
+
+	if(nb_threads <= 1)
+	{
+		RandomNumberGenerator* random_factory = &(m_bio_world->m_randomNumberFactory);
+		if(m_randomFactories_v != NULL && m_randomFactories_v->empty() == false) random_factory = &(m_randomFactories_v->front());
+
+		float intensity = 0.0f;
+		_measureInGaussianBeamSubSystem(particles.begin(), particles.end(), dt, random_factory, &intensity);
+		return intensity; //->
+	}
+
+	//partial sums are reduced in thread order so that the result does not depend on the scheduling
+	vector<float> intensities_v(nb_threads, 0.0f);
+	vector<thread> threads_v;
+	int nb_particle_per_thread = nb_particles/nb_threads;
+	auto particle_beg = particles.begin();
+	for(int thread_idx = 0; thread_idx <= nb_threads-1; thread_idx++)
+	{
+		auto particle_end = particle_beg;
+		if(thread_idx == nb_threads-1) particle_end = particles.end();
+		else advance(particle_end, nb_particle_per_thread);
+
+		threads_v.push_back(thread(&Probe::_measureInGaussianBeamSubSystem, this, particle_beg, particle_end, dt,
+								   &((*m_randomFactories_v)[thread_idx]), &(intensities_v[thread_idx])));
+		particle_beg = particle_end;
+	}
+
+	float intensity = 0.0f;
+	for(int thread_idx = 0; thread_idx <= nb_threads-1; thread_idx++)
+	{
+		threads_v[thread_idx].join();
+		intensity += intensities_v[thread_idx];
+	}
+
+	return intensity;
+}
+
+void Probe::_measureInGaussianBeamSubSystem(list<Particle>::iterator particle_beg, list<Particle>::iterator particle_end,
+											float dt, RandomNumberGenerator* random_factory, float* intensity)
+{
+	const myGaussianBeamLookup& lookup = m_gaussianBeam_lookup;
+	const vec2 center = m_gaussianBeam_params.center;
+	const float max_intensity = m_gaussianBeam_params.maxIntensity;
+	const float koff = m_gaussianBeam_params.koff;
+	const bool isBleaching = (koff >= 0 && dt >= 0);
+
+	float sum = 0.0f;
+	for(auto prtl = particle_beg; prtl != particle_end; prtl++)
+	{
+		if(prtl->getSpecie() != m_specie1) continue; //<-
+
+		vec2 dr = prtl->getR() - center;
+
+		//cheap culling before the region test and the exponential
+		if(lookup.isCutOff)
+		{
+			if(fabs(dr.x) > lookup.cutOff_radius || fabs(dr.y) > lookup.cutOff_radius) continue; //<-
+		}
+
+		float dr_square = dr.x*dr.x + dr.y*dr.y;
+		if(lookup.isCutOff && dr_square > lookup.cutOff_radiusSquared) continue; //<-
+		if(prtl->isInside(m_region1) == false) continue; //<-
+
+		float x = dr_square*lookup.inv_twoSigmaSquared;
+		float gauss;
+		if(x < lookup.table_maxX)
+		{
+			float x_pos = x*lookup.table_invStep;
+			int x_idx = int(x_pos);
+			float frac = x_pos - x_idx;
+			gauss = lookup.expTable_v[x_idx] + frac*(lookup.expTable_v[x_idx+1] - lookup.expTable_v[x_idx]);
+		}
+		else gauss = exp(-x);
+
+		sum += prtl->getIntensity()*max_intensity*gauss;
+
+		if(isBleaching)
+		{
+			prtl->getFluorophore()->bleach(gauss*koff, dt, *random_factory);
+		}
+	}
+
+	*intensity = sum;
 }
 
 
 float Probe::measure(int plane, float current_time, float dt)
 {
+	//one profiler zone per measure type (names must be static strings)
+	static const char* zone_names[] = {"probe : none", "probe : intensity", "probe : average intensity",
+									   "probe : relative intensity", "probe : relative average intensity",
+									   "probe : relative average intensity (two pop.)",
+									   "probe : average intensity in gaussian beam", "probe : intensity in gaussian beam",
+									   "probe : trace tracker", "probe : localisation"};
+	PROFILE_ZONE(zone_names[m_measure_type]);
+
+	//no-op after a diffusion step : the region membership is then read from the particles masks
+	m_bio_world->updateRegionLookup();
+
 	switch(m_measure_type)
 	{
 		case NONE:
@@ -215,66 +364,19 @@ float Probe::measure(int plane, float current_time, float dt)
 		}
 		break;
 
-        case INTENSITY_IN_GAUSSIAN_BEAM: // spc1 and spc2 intensities are meseared in rgn1 and compared to the intensity of the same spcs in rgn2
+        case INTENSITY_IN_GAUSSIAN_BEAM:
 		{
-				float intensity1 = 0.0f;
-				glm::vec2 dr;
-				float dr_square;
-
-				for(Particle& prtl : m_bio_world->m_particles)
-				{
-					if(prtl.getSpecie() == m_specie1 && prtl.isInside(m_region1))
-					{
-						dr = prtl.getR() - m_gaussianBeam_params.center;
-						dr_square = dr.x*dr.x + dr.y*dr.y;
-
-						if(m_gaussianBeam_params.noise_cutOff == 0 || dr_square <= 2*log(100.0f/m_gaussianBeam_params.noise_cutOff)*pow(m_gaussianBeam_params.sigma, 2.0f))
-						{
-							float gauss = exp(-dr_square/(2*pow(m_gaussianBeam_params.sigma,2.0)));
-							intensity1 += prtl.getIntensity()*m_gaussianBeam_params.maxIntensity*gauss;
-
-							if(m_gaussianBeam_params.koff >= 0 && dt >= 0)
-							{
-								prtl.getFluorophore()->bleach(gauss*m_gaussianBeam_params.koff, dt, m_bio_world->m_randomNumberFactory);
-							}
-						}
-					}
-				}
+				float intensity1 = _measureInGaussianBeam(dt);
 
 				m_signal.addValue(vec2(current_time, intensity1));
 				return intensity1;
 		}
 		break;
 
-        case AVERAGE_INTENSITY_IN_GAUSSIAN_BEAM: // spc1 and spc2 intensities are meseared in rgn1 and compared to the intensity of the same spcs in rgn2
+        case AVERAGE_INTENSITY_IN_GAUSSIAN_BEAM:
 		{
-				float intensity1 = 0.0f;
-				float average_intensity1 = 0.0f;
 				float surface1 = m_region1->getSurface();
-				glm::vec2 dr;
-				float dr_square;
-
-				for(auto& prtl : m_bio_world->m_particles)
-				{
-					if(prtl.getSpecie() == m_specie1 && prtl.isInside(m_region1))
-					{
-						dr = prtl.getR() - m_gaussianBeam_params.center;
-						dr_square = dr.x*dr.x + dr.y*dr.y;
-						if(m_gaussianBeam_params.noise_cutOff == 0 || dr_square <= 2*log(100.0f/m_gaussianBeam_params.noise_cutOff)*pow(m_gaussianBeam_params.sigma, 2.0f))
-						{
-							float gauss = exp(-dr_square/(2*pow(m_gaussianBeam_params.sigma,2.0)));
-							intensity1 += prtl.getIntensity()*m_gaussianBeam_params.maxIntensity*gauss;
-
-							if(m_gaussianBeam_params.koff >= 0 && dt >= 0)
-							{
-								prtl.getFluorophore()->bleach(gauss*m_gaussianBeam_params.koff, dt, m_bio_world->m_randomNumberFactory);
-							}
-						}
-					}
-				}
-
-				average_intensity1 = intensity1 / surface1;
-
+				float average_intensity1 = _measureInGaussianBeam(dt) / surface1;
 
 				m_signal.addValue(vec2(current_time, average_intensity1));
 				return average_intensity1;
@@ -283,50 +385,31 @@ float Probe::measure(int plane, float current_time, float dt)
 
 		case TRACE_TRACKER:
 		{
+			//particles were added or deleted : the running traces follow their particle to its new rank
+			if(m_traceTracker_revision != m_bio_world->m_fluoStates_revision)
+			{
+				m_traceTracker.rekeySlots(_getParticleSlots());
+				m_traceTracker_revision = m_bio_world->m_fluoStates_revision;
+			}
+			m_traceTracker.beginPlane(m_bio_world->m_particles.size());
 
-			map<Particle*, Trace>::iterator it_trc;
-			FluoEvent fluo_event;
-
-
-
+			int ptcl_idx = 0;
 			for(Particle &ptcl : m_bio_world->m_particles)
 			{
 				//is the particle of the right specie? And is the particle visible?
 				if(ptcl.getSpecie() == m_specie1)
 				{
-					//has the particle started a trace
-					it_trc = m_runningTraces.find(&ptcl);
-                    if(it_trc != m_runningTraces.end()) //the trace exists
+					if((ptcl.m_mother_rgn == m_region1 || ptcl.m_child_rgn == m_region1 || ptcl.isInside(m_region1)) &&
+						ptcl.getIntensity())
 					{
-						if((ptcl.m_mother_rgn == m_region1 || ptcl.m_child_rgn == m_region1 || ptcl.isInside(m_region1)) &&
-							ptcl.getIntensity())
-						{
-							fluo_event = FluoEvent{0, plane, ptcl.getR().x, ptcl.getR().y, 1, -1, 1};
-							it_trc->second.addFluoEvent(fluo_event);
-						}
-						else
-						{
-							m_mesauredTraces.push_back((*it_trc).second);
-							m_runningTraces.erase(it_trc);
-						}
+						m_traceTracker.addEvent(ptcl_idx, &ptcl, plane, ptcl.getR().x, ptcl.getR().y);
 					}
-
 					else
 					{
-						if((ptcl.m_mother_rgn == m_region1 || ptcl.m_child_rgn == m_region1 || ptcl.isInside(m_region1)) &&
-							ptcl.getIntensity())
-						{
-							fluo_event = FluoEvent{0, plane, ptcl.getR().x, ptcl.getR().y, 1, -1, 1};
-							m_runningTraces[&ptcl] = Trace();
-							m_runningTraces[&ptcl].addFluoEvent(fluo_event);
-						}
-
-						else
-						{
-                            //the trace
-						}
+						m_traceTracker.endTrace(ptcl_idx, &ptcl);
 					}
 				}
+				ptcl_idx++;
 			}
 		}
 		break;
@@ -394,16 +477,29 @@ Signal& Probe::getSignalRef()
 	return m_signal;
 }
 
+StatsAccumulator& Probe::getTraceLengthsStatsRef()
+{
+	return m_traceTracker.getLengthsStatsRef();
+}
+
 vector<Trace> Probe::getAllTraces()
 {
-	vector<Trace> traces = m_mesauredTraces;
+	return m_traceTracker.getAllTraces();
+}
 
-	for(map<Particle*, Trace>::iterator it_trc = m_runningTraces.begin(); it_trc!= m_runningTraces.end(); ++it_trc)
-	{
-		traces.push_back((*it_trc).second);
-	}
+vector<Trace> Probe::takeAllTraces()
+{
+	return m_traceTracker.takeAllTraces();
+}
 
-	return traces;
+bool Probe::startTraceStreaming(string file_path, FLUOEVENT_FILE_FORMAT format, float dt, float px)
+{
+	return m_traceTracker.startStreaming(file_path, format, dt, px);
+}
+
+void Probe::stopTraceStreaming()
+{
+	m_traceTracker.stopStreaming();
 }
 
 vector<FluoEvent> Probe::getAllLocalisations()
@@ -424,10 +520,49 @@ void Probe::resetProbe()
 
 void Probe::resetProbeMeasure()
 {
-	m_runningTraces.clear();
-	m_mesauredTraces.clear();
+	m_traceTracker.clear();
 	m_signal.clearValues();
 	m_localisations_v.clear();
 }
 
+void Probe::saveState(myBinaryWriter& writer)
+{
+	writer.write<int>(m_measure_type);
+	writer.writeVector(m_signal.getValuesRef_v());
+	m_traceTracker.saveState(writer, _getParticleSlots());
+	writer.writeVector(m_localisations_v);
+}
+
+bool Probe::loadState(myBinaryReader& reader)
+{
+	int measure_type;
+	reader.read(measure_type);
+	if(reader.isGood() == false || measure_type != m_measure_type)
+	{
+		cout<<"In Probe::loadState : error (the state was saved by another kind of probe)\n";
+		return false; //->
+	}
+
+	vector<vec2> values_v;
+	reader.readVector(values_v);
+	m_signal.clearValues();
+	if(values_v.empty() == false) m_signal.addValues(values_v);
+
+	if(m_traceTracker.loadState(reader, _getParticleSlots()) == false) return false; //->
+	if(m_bio_world != 0) m_traceTracker_revision = m_bio_world->m_fluoStates_revision; //the slots were matched to the current particles
+
+	return reader.readVector(m_localisations_v);
+}
+
+vector<const void*> Probe::_getParticleSlots()
+{
+	vector<const void*> slotParticles_v;
+	if(m_bio_world == 0) return slotParticles_v; //->
+
+	slotParticles_v.reserve(m_bio_world->m_particles.size());
+	for(Particle& ptcl : m_bio_world->m_particles) slotParticles_v.push_back(&ptcl);
+
+	return slotParticles_v;
+}
+
 
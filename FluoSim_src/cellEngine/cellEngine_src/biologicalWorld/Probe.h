@@ -22,13 +22,16 @@
 #define PROBE_H
 
 #include "list"
+#include "vector"
 
 #include "cellEngine_library_global.h"
     #include "Measure/Trace.h"
+    #include "Measure/TraceTracker.h"
     #include "Measure/Signal.h"
     #include "Region_gpu.h"
     #include "ChemicalSpecies.h"
     #include "BiologicalWorld.h"
+    #include "physicsEngine/RandomNumberGenerator.h"
 
 struct CELLENGINE_LIBRARYSHARED_EXPORT myGaussianBeamParams
 {
@@ -39,6 +42,18 @@ struct CELLENGINE_LIBRARYSHARED_EXPORT myGaussianBeamParams
 	float koff = -1.0f;
 };
 
+//beam quantities derived once per setGaussianBeamParam
+struct CELLENGINE_LIBRARYSHARED_EXPORT myGaussianBeamLookup
+{
+	bool isCutOff = false;
+	float cutOff_radius = -1; //px, the cut-off disk is first culled with its bounding box
+	float cutOff_radiusSquared = -1;
+	float inv_twoSigmaSquared = 0;
+	float table_maxX = 0; //exp(-x) is tabulated for x in [0, table_maxX]
+	float table_invStep = 0;
+	std::vector<float> expTable_v;
+};
+
 class CELLENGINE_LIBRARYSHARED_EXPORT Probe
 {
 public :
@@ -57,6 +72,7 @@ public :
     void setChemicalSpecie2(ChemicalSpecies* spc);
     void setMeasureType(measureType measure_type);
 	void setGaussianBeamParam(myGaussianBeamParams& gaussianBeam_params);
+	void setRandomFactories(vector<RandomNumberGenerator>* randomFactories_v); //one per thread, used by the gaussian beam measures
 
     BiologicalWorld* getBiologicalWorld();
 	Region* getRegion1();
@@ -66,18 +82,36 @@ public :
 	measureType getMeasureType();
 	myGaussianBeamParams getGaussianBeamParams();
     Signal& getSignalRef();
+    StatsAccumulator& getTraceLengthsStatsRef(); //TRACE_TRACKER : lengths of the closed traces, accumulated while measuring
     vector<Trace> getAllTraces();
+    vector<Trace> takeAllTraces(); //moves the traces out of the probe (the traces measure is reset)
+    bool startTraceStreaming(string file_path, FLUOEVENT_FILE_FORMAT format = PALMTRACER_FORMAT, float dt = -1, float px = -1);
+    void stopTraceStreaming();
     vector<FluoEvent>getAllLocalisations();
 
     void resetProbe();
 	void resetProbeMeasure();
 	float measure(int plane =-1, float current_time = -10, float dt = -1.0f);
 
+	//checkpoint of the measure (signal, traces, localisations), to be loaded once the biological world state is loaded
+	void saveState(myBinaryWriter& writer);
+	bool loadState(myBinaryReader& reader);
+
+private :
+
+	void _computeGaussianBeamLookup();
+	std::vector<const void*> _getParticleSlots();
+	float _measureInGaussianBeam(float dt);
+	void _measureInGaussianBeamSubSystem(list<Particle>::iterator particle_beg, list<Particle>::iterator particle_end,
+										 float dt, RandomNumberGenerator* random_factory, float* intensity);
+
 private :
 
 //probe data
 	measureType m_measure_type;
 	myGaussianBeamParams m_gaussianBeam_params;
+	myGaussianBeamLookup m_gaussianBeam_lookup;
+	vector<RandomNumberGenerator>* m_randomFactories_v;
 
 //measurement data
     BiologicalWorld* m_bio_world;
@@ -88,8 +122,8 @@ private :
 
 //signal data
     Signal m_signal;
-    vector<Trace> m_mesauredTraces;
-    map<Particle*, Trace> m_runningTraces;
+    TraceTracker m_traceTracker;
+    unsigned int m_traceTracker_revision; //particles revision the tracker slots are keyed on
 
     vector<FluoEvent> m_localisations_v;
 };
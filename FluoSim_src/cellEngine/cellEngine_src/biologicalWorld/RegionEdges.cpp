@@ -0,0 +1,216 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+
+
+#include "RegionEdges.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#define REGIONEDGES_AVX2
+	#include "immintrin.h"
+#endif
+
+
+using namespace std;
+using namespace glm;
+
+void myRegionEdges::build(const vector<vec2>& r_v)
+{
+	nb_edges = r_v.size();
+	int nb_padded = 8*((nb_edges+7)/8);
+
+	ox_v.assign(nb_padded, 0.0f);
+	oy_v.assign(nb_padded, 0.0f);
+	tx_v.assign(nb_padded, 0.0f);
+	ty_v.assign(nb_padded, 0.0f);
+	dirx_v.assign(nb_padded, 0.0f);
+	diry_v.assign(nb_padded, 0.0f);
+
+	for(int edge_idx = 0; edge_idx < nb_edges; edge_idx++)
+	{
+		vec2 vec_t = r_v[(edge_idx+1)%nb_edges] - r_v[edge_idx];
+		vec2 dir_t = normalize(vec_t);
+
+		ox_v[edge_idx] = r_v[edge_idx].x;
+		oy_v[edge_idx] = r_v[edge_idx].y;
+		tx_v[edge_idx] = vec_t.x;
+		ty_v[edge_idx] = vec_t.y;
+		dirx_v[edge_idx] = dir_t.x;
+		diry_v[edge_idx] = dir_t.y;
+	}
+}
+
+static int _getNearestEdgeHit_scalar(const myRegionEdges& edges, vec2 r, vec2 dr, int edge_to_avoid,
+									 EDGE_TEST_MODE mode, float& u_min, unsigned int& nb_hits, bool& isOnAnEdge)
+{
+	int i_min = -1;
+	for(int i = 0; i < edges.nb_edges; i++)
+	{
+		float delta_x = r.x - edges.ox_v[i];
+		float delta_y = r.y - edges.oy_v[i];
+		float tx = edges.tx_v[i];
+		float ty = edges.ty_v[i];
+
+		float D = ty*dr.x - tx*dr.y;
+		if(D == 0.0f) continue; //<-
+
+		float t = (delta_y*dr.x - delta_x*dr.y)/D; //along the edge
+		float u = (delta_y*tx - delta_x*ty)/D; //along dr
+
+		if(mode == RAY_EDGE_TEST)
+		{
+			if(!(t >= 0.0f && t < 1.0f && u >= 0.0f)) continue; //<-
+
+			nb_hits++;
+			if(u == 0.0f) isOnAnEdge = true;
+			else if(i != edge_to_avoid && u < u_min)
+			{
+				u_min = u;
+				i_min = i;
+			}
+		}
+		else
+		{
+			if(i != edge_to_avoid && t > 0.0f && t < 1.0f && u > 0.0f && u < 1.0f && u < u_min)
+			{
+				u_min = u;
+				i_min = i;
+			}
+		}
+	}
+	return i_min;
+}
+
+#ifdef REGIONEDGES_AVX2
+//same operations as the scalar version (no fma), hence the same hits
+__attribute__((target("avx2")))
+static int _getNearestEdgeHit_avx2(const myRegionEdges& edges, vec2 r, vec2 dr, int edge_to_avoid,
+								   EDGE_TEST_MODE mode, float& u_min, unsigned int& nb_hits, bool& isOnAnEdge)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 rx = _mm256_set1_ps(r.x);
+	const __m256 ry = _mm256_set1_ps(r.y);
+	const __m256 ux = _mm256_set1_ps(dr.x);
+	const __m256 uy = _mm256_set1_ps(dr.y);
+	const __m256i avoided_idx = _mm256_set1_epi32(edge_to_avoid);
+	const __m256i eight = _mm256_set1_epi32(8);
+
+	__m256 best_u = _mm256_set1_ps(u_min);
+	__m256i best_idx = _mm256_set1_epi32(-1);
+	__m256i lane_idx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+	int nb_padded = edges.ox_v.size();
+	for(int i = 0; i < nb_padded; i += 8)
+	{
+		__m256 delta_x = _mm256_sub_ps(rx, _mm256_loadu_ps(&edges.ox_v[i]));
+		__m256 delta_y = _mm256_sub_ps(ry, _mm256_loadu_ps(&edges.oy_v[i]));
+		__m256 tx = _mm256_loadu_ps(&edges.tx_v[i]);
+		__m256 ty = _mm256_loadu_ps(&edges.ty_v[i]);
+
+		__m256 D = _mm256_sub_ps(_mm256_mul_ps(ty, ux), _mm256_mul_ps(tx, uy));
+		__m256 t = _mm256_div_ps(_mm256_sub_ps(_mm256_mul_ps(delta_y, ux), _mm256_mul_ps(delta_x, uy)), D);
+		__m256 u = _mm256_div_ps(_mm256_sub_ps(_mm256_mul_ps(delta_y, tx), _mm256_mul_ps(delta_x, ty)), D);
+
+		__m256 isValid = _mm256_cmp_ps(D, zero, _CMP_NEQ_OQ); //null and padding edges
+		__m256 isAvoided = _mm256_castsi256_ps(_mm256_cmpeq_epi32(lane_idx, avoided_idx));
+		__m256 isCandidate;
+
+		if(mode == RAY_EDGE_TEST)
+		{
+			__m256 isHit = _mm256_and_ps(isValid, _mm256_cmp_ps(t, zero, _CMP_GE_OQ));
+			isHit = _mm256_and_ps(isHit, _mm256_cmp_ps(t, one, _CMP_LT_OQ));
+			isHit = _mm256_and_ps(isHit, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+
+			int hit_mask = _mm256_movemask_ps(isHit);
+			if(hit_mask == 0)
+			{
+				lane_idx = _mm256_add_epi32(lane_idx, eight);
+				continue; //<-
+			}
+			nb_hits += __builtin_popcount(hit_mask);
+			if(_mm256_movemask_ps(_mm256_and_ps(isHit, _mm256_cmp_ps(u, zero, _CMP_EQ_OQ))) != 0) isOnAnEdge = true;
+
+			isCandidate = _mm256_and_ps(isHit, _mm256_cmp_ps(u, zero, _CMP_NEQ_OQ));
+		}
+		else
+		{
+			isCandidate = _mm256_and_ps(isValid, _mm256_cmp_ps(t, zero, _CMP_GT_OQ));
+			isCandidate = _mm256_and_ps(isCandidate, _mm256_cmp_ps(t, one, _CMP_LT_OQ));
+			isCandidate = _mm256_and_ps(isCandidate, _mm256_cmp_ps(u, zero, _CMP_GT_OQ));
+			isCandidate = _mm256_and_ps(isCandidate, _mm256_cmp_ps(u, one, _CMP_LT_OQ));
+		}
+		isCandidate = _mm256_andnot_ps(isAvoided, isCandidate);
+		isCandidate = _mm256_and_ps(isCandidate, _mm256_cmp_ps(u, best_u, _CMP_LT_OQ));
+
+		best_u = _mm256_blendv_ps(best_u, u, isCandidate);
+		best_idx = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(best_idx), _mm256_castsi256_ps(lane_idx), isCandidate));
+		lane_idx = _mm256_add_epi32(lane_idx, eight);
+	}
+
+	//lanes reduction : smallest u, then smallest index as in the sequential scan
+	float lane_u[8];
+	int lane_i[8];
+	_mm256_storeu_ps(lane_u, best_u);
+	_mm256_storeu_si256((__m256i*) lane_i, best_idx);
+
+	int i_min = -1;
+	for(int lane = 0; lane < 8; lane++)
+	{
+		if(lane_i[lane] == -1) continue; //<-
+		if(i_min == -1 || lane_u[lane] < u_min || (lane_u[lane] == u_min && lane_i[lane] < i_min))
+		{
+			u_min = lane_u[lane];
+			i_min = lane_i[lane];
+		}
+	}
+	return i_min;
+}
+
+static bool _isAvx2Supported()
+{
+	static const bool isSupported = (__builtin_cpu_init(), __builtin_cpu_supports("avx2") != 0);
+	return isSupported;
+}
+#endif
+
+int getNearestEdgeHit(const myRegionEdges& edges, vec2 r, vec2 dr, int edge_to_avoid,
+					  EDGE_TEST_MODE mode, float& u_min, unsigned int* nb_hits, bool* isOnAnEdge)
+{
+	unsigned int temp_nbHits = 0;
+	bool temp_isOnAnEdge = false;
+	int i_min;
+
+#ifdef REGIONEDGES_AVX2
+	//below two blocks of 8, the scalar loop is as fast
+	if(edges.nb_edges >= 16 && _isAvx2Supported())
+	{
+		i_min = _getNearestEdgeHit_avx2(edges, r, dr, edge_to_avoid, mode, u_min, temp_nbHits, temp_isOnAnEdge);
+	}
+	else
+#endif
+	{
+		i_min = _getNearestEdgeHit_scalar(edges, r, dr, edge_to_avoid, mode, u_min, temp_nbHits, temp_isOnAnEdge);
+	}
+
+	if(nb_hits != 0) *nb_hits = temp_nbHits;
+	if(isOnAnEdge != 0) *isOnAnEdge = temp_isOnAnEdge;
+	return i_min;
+}
@@ -0,0 +1,60 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#ifndef REGIONEDGES_H
+#define REGIONEDGES_H
+
+#include "vector"
+
+#include "glm.hpp"
+
+#include "cellEngine_library_global.h"
+
+
+enum EDGE_TEST_MODE {RAY_EDGE_TEST, SEGMENT_EDGE_TEST};
+
+//edges of a polygon as structure of arrays, edge i going from vertex i to vertex i+1 (the last one closing the polygon)
+//the arrays are padded to a multiple of 8 with null edges, which are never hit
+struct CELLENGINE_LIBRARYSHARED_EXPORT myRegionEdges
+{
+	int nb_edges = 0;
+
+	std::vector<float> ox_v; //origin
+	std::vector<float> oy_v;
+	std::vector<float> tx_v; //vertex i+1 - vertex i
+	std::vector<float> ty_v;
+	std::vector<float> dirx_v; //unit tangent
+	std::vector<float> diry_v;
+
+	void build(const std::vector<glm::vec2>& r_v);
+	glm::vec2 getTangent(int edge_idx) const {return glm::vec2(tx_v[edge_idx], ty_v[edge_idx]);}
+	glm::vec2 getDirection(int edge_idx) const {return glm::vec2(dirx_v[edge_idx], diry_v[edge_idx]);}
+};
+
+//nearest edge crossed by r + u*dr, edge_to_avoid being skipped, 8 edges at a time when the cpu supports AVX2
+//RAY_EDGE_TEST (Region::intersect) : 0 <= u, the hits are counted, u = 0 only sets isOnAnEdge (the avoided edge is counted)
+//SEGMENT_EDGE_TEST (Region::reflect) : 0 < u < 1, the end points of the edges excluded
+//u_min : in, upper bound of u (excluded) / out, u of the nearest hit ; returns its edge index, -1 if none
+CELLENGINE_LIBRARYSHARED_EXPORT int getNearestEdgeHit(const myRegionEdges& edges, glm::vec2 r, glm::vec2 dr, int edge_to_avoid,
+													  EDGE_TEST_MODE mode, float& u_min,
+													  unsigned int* nb_hits = 0, bool* isOnAnEdge = 0);
+
+
+#endif // REGIONEDGES_H
@@ -20,6 +20,9 @@
 
 
 
+#include "atomic"
+#include "cassert"
+
 #include "Region_gpu.h"
 
 #include "toolBox_src/toolbox_library_global.h"
@@ -31,11 +34,12 @@ using namespace std;
 using namespace glm;
 
 
-Region::Region(myMultiVector<glm::vec2>& r_mv, gstd::gMultiVector<glm::vec2>& r_gmv) :
+static std::atomic<unsigned long long> lastRegion_revision(0);
+
 
-	myGLObject(myGLObject::RENDERABLE_ABILITY_BIT, myGLObject::UNDEFINED_TYPE),
-	m_r(r_mv.addSubVector()),
-	m_r_gv(r_gmv.addSubVector())
+Region::Region(myMultiVector<glm::vec2>& r_mv) :
+
+	m_r(r_mv.addSubVector())
 
 {
 	m_region_radiusSquared =-1.0;
@@ -43,56 +47,19 @@ Region::Region(myMultiVector<glm::vec2>& r_mv, gstd::gMultiVector<glm::vec2>& r_
 	m_color = vec4(0.0,0.0,1.0,1.0);
     m_highlighted_color = vec4(0,1,0,1);
     m_isHighlighted = false;
+	m_kineticParams = 0;
+	m_nbKineticParams = 0;
+	m_areDynamicParams_modified = true;
+	m_regionIdx = -1;
+	_updateEdges();
+}
 
-	string vs_raw_src;
-	vs_raw_src +="#version 150 core\n"
-				"\n"
-				"in vec2 R;\n"
-				"uniform mat4 scaling_matrix;\n"
-//				"uniform mat4 screen_matrix;\n"
-				"\n"
-				"void main(void)\n"
-				"{\n"
-				"	vec4 temp = vec4(R,0.0, 1.0);\n"
-				"	gl_Position = scaling_matrix*temp;\n"
-				"}\n";
-
-	string fs_raw_src;
-	fs_raw_src +="#version 150 core\n\n"
-				"\n"
-				"uniform vec4 color;\n"
-				"out vec4 gl_FragColor;\n"
-				"\n"
-				"void main(void)\n"
-				"{\n"
-				"	gl_FragColor=color;\n"
-				"}\n";
-
-	string log;
-	gstd::gShader vs_raw(gstd::VERTEX_SHADER);
-		vs_raw.setSource(vs_raw_src, 0);
-		vs_raw.compile(log);
-	gstd::gShader fs_raw(gstd::FRAGMENT_SHADER);
-		fs_raw.setSource(fs_raw_src, 0);
-		fs_raw.compile(log);
-	gstd::gProgram rawPrimitiveRendering_pgm("rawRendering");
-		rawPrimitiveRendering_pgm.addShader(vs_raw);
-		rawPrimitiveRendering_pgm.addShader(fs_raw);
-		rawPrimitiveRendering_pgm.linkShaders();
-
-	myGLObject::addProgram(rawPrimitiveRendering_pgm);
-}
-
-Region::Region(myMultiVector<glm::vec2>& r_mv, gstd::gMultiVector<glm::vec2>& r_gmv,
-				   vector<vec2>& r) :
-
-	myGLObject(myGLObject::RENDERABLE_ABILITY_BIT, myGLObject::UNDEFINED_TYPE),
-	m_r(r_mv.addSubVector()),
-	m_r_gv(r_gmv.addSubVector())
+Region::Region(myMultiVector<glm::vec2>& r_mv, vector<vec2>& r) :
+
+	m_r(r_mv.addSubVector())
 
 {
 	m_r.insert(0,r);
-	m_r_gv.insert(0, r);
 
 	m_color = vec4(0.0,0.0,1.0,1.0);
     m_highlighted_color = vec4(0,1,0,1);
@@ -101,45 +68,11 @@ Region::Region(myMultiVector<glm::vec2>& r_mv, gstd::gMultiVector<glm::vec2>& r_
 	computeBarycenter();
 	computeRadiusSquared();
 	m_surface = -1.0;
-
-	string vs_raw_src;
-	vs_raw_src +="#version 150 core\n"
-				"\n"
-				"in vec2 R;\n"
-				"uniform mat4 scaling_matrix;\n"
-//				"uniform mat4 screen_matrix;\n"
-				"\n"
-				"void main(void)\n"
-				"{\n"
-				"	vec4 temp = vec4(R,0.0, 1.0);\n"
-				"	gl_Position = scaling_matrix*temp;\n"
-				"}\n";
-
-	string fs_raw_src;
-	fs_raw_src +="#version 150 core\n\n"
-				"\n"
-				"uniform vec4 color;\n"
-				"out vec4 gl_FragColor;\n"
-				"\n"
-				"void main(void)\n"
-				"{\n"
-				"	gl_FragColor=color;\n"
-				"}\n";
-
-	string log;
-	gstd::gShader vs_raw(gstd::VERTEX_SHADER);
-		vs_raw.setSource(vs_raw_src, 0);
-		vs_raw.compile(log);
-	gstd::gShader fs_raw(gstd::FRAGMENT_SHADER);
-		fs_raw.setSource(fs_raw_src, 0);
-		fs_raw.compile(log);
-	gstd::gProgram rawPrimitiveRendering_pgm("rawRendering");
-		rawPrimitiveRendering_pgm.addShader(vs_raw);
-		rawPrimitiveRendering_pgm.addShader(fs_raw);
-		rawPrimitiveRendering_pgm.linkShaders();
-
-	myGLObject::addProgram(rawPrimitiveRendering_pgm);
-
+	m_kineticParams = 0;
+	m_nbKineticParams = 0;
+	m_areDynamicParams_modified = true;
+	m_regionIdx = -1;
+	_updateEdges();
 }
 
 bool Region::operator==(Region& rgn)
@@ -166,34 +99,6 @@ bool Region::operator==(Region& rgn)
 }
 
 
-void Region::render(myGLObject* renderingTarget)
-{
-    if(renderingTarget->isRenderingTargetObject() == false || isBlinking()&&isBlinked()) return; //->
-
-	mat4 m;
-	m = renderingTarget->getWorldToExtendedHomMatrix();
-    vec4 color = m_isHighlighted ? m_highlighted_color : m_color;
-
-	gstd::gProgram& pgm = myGLObject::getProgram(0);
-
-	glDisable(GL_BLEND);
-	glLineWidth(2.0);
-
-	pgm.useProgram(true);
-
-	gstd::myConnector<vec2>::connect(pgm, "R", m_r_gv);
-	gstd::connectUniform(pgm, "scaling_matrix", (float*) &m);
-//	gstd::connectUniform(pgm, "screen_matrix", (float*) &screen_matrix);
-    gstd::connectUniform(pgm, "color", &color);
-
-	int n_vertices_segment = m_r.size();
-	glDrawArrays(GL_LINE_LOOP, 0, n_vertices_segment);
-
-	pgm.useProgram(false);
-}
-
-
-
 void Region::setName(const string& name)
 {
 	m_name = name;
@@ -211,15 +116,13 @@ Region::~Region()
 void Region::addPoint(vec2& r)
 {
 	m_r.push_back(r);
-	m_r_gv.push_back(r);
-
+	_updateEdges();
 }
 
 void Region::addPoints(std::vector<glm::vec2>& r_v)
 {
 	m_r.insert(m_r.size(), r_v);
-	m_r_gv.insert(m_r_gv.size(), r_v);
-
+	_updateEdges();
 }
 
 const vec2 Region::getPoint(const int pt_idx)
@@ -236,7 +139,26 @@ const vec2 Region::getPoint(const int pt_idx)
 void Region::clearRegion()
 {
 	m_r.clear();
-	m_r_gv.clear();
+	_updateEdges();
+}
+
+void Region::_updateEdges()
+{
+	m_revision = ++lastRegion_revision; //every change of the vertices goes through here
+
+	vector<vec2> r_v(m_r.size());
+	for(int pt_idx = 0; pt_idx < int(m_r.size()); pt_idx++) r_v[pt_idx] = m_r[pt_idx];
+
+	m_edges.build(r_v);
+}
+
+const myKineticParam& Region::_getUnbuiltKineticParam()
+{
+	//returned (with default parameters) when the region or the species is not in the kinetic table yet :
+	//on the per-particle path, nothing is printed, the biological world entry points rebuild the table first
+	static const myKineticParam unbuilt_param;
+	assert(false && "kinetic table not built, updateKineticTable has to be called first");
+	return unbuilt_param;
 }
 
 vec4 Region::getColor() const
@@ -369,12 +291,14 @@ void Region::addDynamicParam(ChemicalSpecies* spc)
 {
 	myDynamicParam dyn_param;
 	m_dynamicParams_map.insert({spc, dyn_param});
+	m_areDynamicParams_modified = true;
 }
 
 void Region::removeDynamicParam(ChemicalSpecies* spc)
 {
 	auto dyn_map = m_dynamicParams_map.find(spc);
 	m_dynamicParams_map.erase(dyn_map);
+	m_areDynamicParams_modified = true;
 }
 
 bool Region::isACompartment(ChemicalSpecies* spc) const
@@ -387,52 +311,62 @@ bool Region::isACompartment(ChemicalSpecies* spc) const
 void Region::setIsACompartment(ChemicalSpecies* spc, bool new_state)
 {
 	m_dynamicParams_map[spc].isACompartment = new_state;
+	m_areDynamicParams_modified = true;
 }
 
 void Region::setIsDDistrubuted(ChemicalSpecies* spc, bool isDDistributed)
 {
 	m_dynamicParams_map[spc].isDDistributed = isDDistributed;
+	m_areDynamicParams_modified = true;
 }
 
 void Region::setIsTrappingEnable(ChemicalSpecies* spc, bool isTrapping_enable)
 {
 	m_dynamicParams_map[spc].isTrapping_enable = isTrapping_enable;
+	m_areDynamicParams_modified = true;
 }
 
 void Region::setAreSitesAbundant(ChemicalSpecies *spc, bool areSites_abundant)
 {
 	m_dynamicParams_map[spc].areSites_abundant = areSites_abundant;
+	m_areDynamicParams_modified = true;
 }
 
 void Region::setD(ChemicalSpecies* spc, float D)
 {
 	m_dynamicParams_map[spc].D = D;
+	m_areDynamicParams_modified = true;
 }
 
 void Region::setDtrapped(ChemicalSpecies* spc, float Dtrapped)
 {
 	m_dynamicParams_map[spc].Dt = Dtrapped;
+	m_areDynamicParams_modified = true;
 }
 
 void Region::setKonAbundant(ChemicalSpecies *spc, float kt_on_abundant)
 {
 	m_dynamicParams_map[spc].kt_on_abundant = kt_on_abundant;
+	m_areDynamicParams_modified = true;
 }
 
 void Region::setKonNAbundant(ChemicalSpecies *spc, float kt_on_Nabundant)
 {
 	m_dynamicParams_map[spc].kt_on_Nabundant = kt_on_Nabundant;
+	m_areDynamicParams_modified = true;
 }
 
 void Region::setSiteDensity(ChemicalSpecies* spc, float site_density)
 {
-	m_dynamicParams_map[spc].site_density = site_density;;
+	m_dynamicParams_map[spc].site_density = site_density;
+	m_areDynamicParams_modified = true;
 }
 
 
 void Region::setKoff(ChemicalSpecies* spc, float kt_off)
 {
 	m_dynamicParams_map[spc].kt_off = kt_off;
+	m_areDynamicParams_modified = true;
 }
 
 void Region::setNumberTrappedPrtl(ChemicalSpecies* spc, int nb_ptcl)
@@ -453,12 +387,14 @@ void Region::deleteATrappedPrtlToNb(ChemicalSpecies *spc)
 void Region::setPoissonMean(ChemicalSpecies* spc, float poisson_mean)
 {
 	m_dynamicParams_map[spc].poisson_mean = poisson_mean;
+	m_areDynamicParams_modified = true;
 }
 
 void Region::setCrossing(ChemicalSpecies* spc, float p_crossing_insideOut, float p_crossing_outsideIn)
 {
 	m_dynamicParams_map[spc].p_crossing_insideOut = p_crossing_insideOut;
 	m_dynamicParams_map[spc].p_crossing_outsideIn = p_crossing_outsideIn;
+	m_areDynamicParams_modified = true;
 }
 
 
@@ -682,6 +618,7 @@ void Region::scaleRegion(float scaling_param)
 	{
 		m_r[pt_idx] = m_barycenter_r + scaling_param * (m_r[pt_idx] - m_barycenter_r);
 	}
+	_updateEdges();
 
 	computeRadiusSquared();
 	computeSurface();
@@ -691,47 +628,12 @@ void Region::reflect(vec2 r_start, vec2 dr_start, int edge_to_avoid_start,
 					   vec2 &r_end, vec2 &dr_end, int &edge_to_avoid_end,
 					   RandomNumberGenerator& randomFactory, float p_crossing)
 {
-	int N = m_r.size();
-
-	vec2 delta_R;
-
 	vec2 vec_u = dr_start;
-	vec2 vec_t;
-	float D;
-	float t, u;
-	float u_min;
-	int i_min;
-
-	u_min = std::numeric_limits<float>::max();
-	i_min=-1;
-
-    for(int i=0; i<N; i++) //the first element tells the number of elements
-	{
-		if(i==edge_to_avoid_start) continue; //<-
+	float u;
+	float u_min = std::numeric_limits<float>::max();
 
-		if(i != N-1) vec_t = m_r[i+1] - m_r[i];
-		else vec_t = m_r[0] - m_r[i];
-
-		delta_R = r_start - m_r[i];
-		D=vec_t.y*vec_u.x-vec_t.x*vec_u.y;
-
-		if(D == 0.0)
-		{
-			continue; //<-
-		}
-
-		t=(delta_R.y*vec_u.x-delta_R.x*vec_u.y)/D; //along the curve line
-		u=(delta_R.y*vec_t.x-delta_R.x*vec_t.y)/D; //along the direction u
-
-		if(t>0.0 && t<1.0 && u>0.0 && u<1.0) //t_bis has to be different from 0, or the point wont't move!
-		{
-			if(u<u_min)
-			{
-				u_min=u;
-				i_min=i;
-			}
-		}
-	}
+	//t_bis has to be different from 0, or the point wont't move!
+	int i_min = getNearestEdgeHit(m_edges, r_start, vec_u, edge_to_avoid_start, SEGMENT_EDGE_TEST, u_min);
 
     if(i_min == -1) //no intersection
 	{
@@ -755,11 +657,7 @@ void Region::reflect(vec2 r_start, vec2 dr_start, int edge_to_avoid_start,
 			u = (1.0f-0.20f)* u_min;
 			r_end = r_start + u*vec_u;
 
-			if(i_min != N-1)  vec_t = m_r[i_min+1] - m_r[i_min];
-			else vec_t = m_r[0] - m_r[i_min];
-
-			vec2 dir_t;
-			dir_t = normalize(vec_t);
+			vec2 dir_t = m_edges.getDirection(i_min);
 
 			float scal = (1-u)*vec_u.x * dir_t.x + (1-u)*vec_u.y*dir_t.y;
 			dr_end = 2*scal*dir_t - (1-u)*vec_u;
@@ -771,50 +669,11 @@ void Region::reflect(vec2 r_start, vec2 dr_start, int edge_to_avoid_start,
 bool Region::intersect(glm::vec2 r, glm::vec2 dr, int edge_to_avoid,
 						 float& u_end, int& intersected_edge_idx, CROSSING_DIRECTION& cross_dir)
 {
-	int N = m_r.size();
 	uint N_intersection = 0;
-
-	vec2 delta_R;
-
-	uint isOnAnEdge = 0;
-	vec2 vec_t, vec_u(dr);
-	float D;
-	float t, u;
+	bool isOnAnEdge = false;
 	float u_min = 1.0f;
-	int i_min(-1);
-	intersected_edge_idx = -1;
-
-	for(int i=0; i<N; i++)
-	{
-			if(i != N-1) vec_t = m_r[i+1] - m_r[i];
-			else vec_t = m_r[0] - m_r[i];
-
-			delta_R = r - m_r[i];
-			D=vec_t.y*vec_u.x-vec_t.x*vec_u.y;
-
-			if(D == 0.0) continue; //<-
 
-			t=(delta_R.y*vec_u.x-delta_R.x*vec_u.y)/D; //along the curve line
-			u=(delta_R.y*vec_t.x-delta_R.x*vec_t.y)/D; //along the direction u
-
-			if(t>=0.0 && t<1.0 && u>=0.0) //t_bis has to be different from 0, or the point wont't move!
-			{
-				N_intersection++;
-
-				if(u == 0) isOnAnEdge = 1;
-				else
-				{
-					if(i!=edge_to_avoid)
-					{
-						if(u<u_min) //u_min is initialized to one
-						{
-							u_min=u;
-							i_min=i;
-						}
-					}
-				}
-			}
-	}
+	int i_min = getNearestEdgeHit(m_edges, r, dr, edge_to_avoid, RAY_EDGE_TEST, u_min, &N_intersection, &isOnAnEdge);
 
 	u_end = u_min;
 	intersected_edge_idx = i_min;
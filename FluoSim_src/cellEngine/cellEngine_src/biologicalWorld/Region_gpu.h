@@ -24,6 +24,7 @@
 #include "stdlib.h"
 #include "string"
 #include "vector"
+#include "list"
 #include "map"
 #include "iostream"
 #include "fstream"
@@ -34,17 +35,13 @@
 
 #include "cellEngine_library_global.h"
     #include "ChemicalSpecies.h"
+    #include "RegionEdges.h"
     #include "physicsEngine/RandomNumberGenerator.h"
 
-#include "gpuTools_library_global.h"
-    #include "gl/gVector.h"
-    #include "gl/gMultiVector.h"
-    #include "gl/gToolBox.h"
-
 #include "toolBox_src/toolBox_library_global.h"
     #include "toolBox_src/containers/myMultiVector.h"
     #include "toolBox_src/otherFunctions/otherFunctions.h"
-    #include "glGUI/glObjects/myGLObject.h"
+
 
 enum GEOMETRY_FILE_FORMAT {IMAGEJ_GEOMETRY_FILE_FORMAT,
 						   METAMORPH_GEOMETRY_FILE_FORMAT,
@@ -70,25 +67,42 @@ struct myDynamicParam
 	float p_crossing_outsideIn = 0.0f;
 };
 
+//compiled copy of myDynamicParam read by the diffusion loop (see BiologicalWorld::updateKineticTable),
+//rates are stored as per-step probabilities (k*dt), 32 bytes i.e. two entries per cache line
+struct myKineticParam
+{
+	bool isACompartment = true;
+	bool isTrapping_enable = false;
+	bool areSites_abundant = false;
+	bool isDDistributed = false;
+	float D = -1;
+	float Dt = -1;
+	float poisson_mean = -1;
+	float p_on = 0.0f; //kt_on_abundant*dt or kt_on_Nabundant*dt
+	float p_off = 0.0f; //kt_off*dt
+	float p_crossing_insideOut = 0.0f;
+	float p_crossing_outsideIn = 0.0f;
+};
+static_assert(sizeof(myKineticParam) == 32, "myKineticParam entries must not straddle cache lines");
 
-class CELLENGINE_LIBRARYSHARED_EXPORT Region : public myGLObject
+
+//physics geometry of a region, no GL resource : the regions are drawn by a RegionRenderer
+class CELLENGINE_LIBRARYSHARED_EXPORT Region
 {
-    friend void saveRegionsList(list<Region>& regions_l, std::string image_filePath, GEOMETRY_FILE_FORMAT format);
-    friend bool getIntersectionRegion(Region& rgn1, Region& rgn2, vector<glm::vec2>& vertices);
+    friend void saveRegionsList(std::list<Region>& regions_l, std::string image_filePath, GEOMETRY_FILE_FORMAT format);
+    friend bool getIntersectionRegion(Region& rgn1, Region& rgn2, std::vector<glm::vec2>& vertices);
+    friend class BiologicalWorld;
 
 public :
 
-    Region(myMultiVector<glm::vec2>& r_mv, gstd::gMultiVector<glm::vec2>& r_gmv);
-    Region(myMultiVector<glm::vec2>& r_mv, gstd::gMultiVector<glm::vec2>& r_gmv,
-			 std::vector<glm::vec2>& r);
+    Region(myMultiVector<glm::vec2>& r_mv);
+    Region(myMultiVector<glm::vec2>& r_mv, std::vector<glm::vec2>& r);
     ~Region();
 
     bool operator==(Region& rgn); //test if the region has the same vertices
 
-	void render(myGLObject* renderingTarget);
-
-	void setName(const string& name);
-	string getName() const;
+	void setName(const std::string& name);
+	std::string getName() const;
 
 	void addPoint(glm::vec2& r);
 	void addPoints(std::vector<glm::vec2>& r_v);
@@ -143,6 +157,18 @@ public :
     float getPoissonMean(ChemicalSpecies* spc) const;
     float getCrossing(ChemicalSpecies* spc, CROSSING_DIRECTION cross_dir) const;
 
+    //only valid once the biological world has built its kinetic table (see BiologicalWorld::updateKineticTable)
+    const myKineticParam& getKineticParam(const ChemicalSpecies* spc) const
+    {
+        int kinetic_idx = spc->getKineticIdx();
+        if(kinetic_idx < 0 || kinetic_idx >= m_nbKineticParams) return _getUnbuiltKineticParam(); //->
+        return m_kineticParams[kinetic_idx];
+    }
+    //index in the biological world region lookup, -1 until the lookup has been (re)built
+    int getRegionIdx() const {return m_regionIdx;}
+    //changes whenever the vertices change, unique across the regions (see RegionRenderer)
+    unsigned long long getRevision() const {return m_revision;}
+
 
     void computeBarycenter();
     void computeRadiusSquared();
@@ -167,15 +193,23 @@ public :
 
 private :
 
-	string m_name;
+	std::string m_name;
 	glm::vec4 m_color;
     glm::vec4 m_highlighted_color;
     bool m_isHighlighted;
 
 	mySubVector<glm::vec2> m_r;
-	gstd::gSubVector<glm::vec2> m_r_gv;
+	myRegionEdges m_edges; //cached copy of the edges of m_r, read by intersect and reflect
+
+	void _updateEdges();
+	static const myKineticParam& _getUnbuiltKineticParam();
 
     std::map<ChemicalSpecies*, myDynamicParam> m_dynamicParams_map;
+    myKineticParam* m_kineticParams; //row of the biological world kinetic table
+    int m_nbKineticParams; //length of the row, 0 until the table has been built
+    bool m_areDynamicParams_modified;
+    int m_regionIdx; //set by the biological world region lookup
+    unsigned long long m_revision;
 
 	glm::vec2 m_barycenter_r;
     float m_region_radiusSquared;
@@ -194,8 +228,8 @@ CELLENGINE_LIBRARYSHARED_EXPORT void saveRegionsList(std::list<Region>& regions_
 bool intersect(glm::vec2 r, glm::vec2 dr, int edge_to_avoid,
 			   float& t_end, int& edge_idx, CROSSING_DIRECTION& cross_dir);
 
-CELLENGINE_LIBRARYSHARED_EXPORT bool getIntersectionRegion(Region& rgn1, Region& rgn2, vector<glm::vec2>& vertices);
-CELLENGINE_LIBRARYSHARED_EXPORT float computeSurface(vector<glm::vec2>& r_v);
+CELLENGINE_LIBRARYSHARED_EXPORT bool getIntersectionRegion(Region& rgn1, Region& rgn2, std::vector<glm::vec2>& vertices);
+CELLENGINE_LIBRARYSHARED_EXPORT float computeSurface(std::vector<glm::vec2>& r_v);
 
 
 #endif // REGION_GPU_H
@@ -0,0 +1,396 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+#include "SteadyStateCache.h"
+
+#include "cstdio"
+#include "cstring"
+#include "cmath"
+
+using namespace std;
+using namespace glm;
+
+
+const unsigned int STEADYSTATE_FILE_MAGIC = 0x53534346; //"FCSS"
+const int STEADYSTATE_FILE_VERSION = 1;
+
+
+//64 bits FNV-1a hash
+static void hashBytes(unsigned long long& hash, const void* data, size_t size)
+{
+	const unsigned char* bytes = (const unsigned char*) data;
+	for(size_t byte_idx = 0; byte_idx < size; byte_idx++)
+	{
+		hash ^= bytes[byte_idx];
+		hash *= 1099511628211ULL;
+	}
+}
+
+
+SteadyStateCache::SteadyStateCache()
+{
+	m_oversampling_factor = 2.0f;
+	m_arePositionsPooled = false;
+	m_seed = 0;
+}
+
+void SteadyStateCache::setStorageFolder(string folder_path)
+{
+	m_storage_folder = folder_path;
+}
+
+void SteadyStateCache::setOversamplingFactor(float factor)
+{
+	if(factor < 1.0f)
+	{
+		cout<<"In SteadyStateCache::setOversamplingFactor : error (factor < 1)\n";
+		return;
+	}
+	m_oversampling_factor = factor;
+}
+
+void SteadyStateCache::setArePositionsPooled(bool arePositionsPooled)
+{
+	m_arePositionsPooled = arePositionsPooled;
+}
+
+void SteadyStateCache::setSeed(unsigned int seed)
+{
+	m_seed = seed;
+}
+
+void SteadyStateCache::clear()
+{
+	m_pools_map.clear();
+}
+
+const vector<float>& SteadyStateCache::getSurfaces(BiologicalWorld& bio_world, int spc_idx)
+{
+	return _getPool(bio_world, spc_idx).surfaces_v;
+}
+
+void SteadyStateCache::drawSteadyState(BiologicalWorld& bio_world, int spc_idx, int fluoSpecie_idx, int n,
+									   const vector<float>& freeWeights_v, const vector<float>& trappedWeights_v)
+{
+	int N_rgn = bio_world.getNbRegions();
+	if(N_rgn <= 0) return; //->
+
+	if(spc_idx > int(bio_world.m_species.size())-1 || fluoSpecie_idx > int(bio_world.m_fluo_species.size())-1)
+	{
+		cout<<"In SteadyStateCache::drawSteadyState : error (spc_idx or fluoSpecie_idx out of range)\n";
+		return;
+	}
+
+	if(int(freeWeights_v.size()) != N_rgn || int(trappedWeights_v.size()) != N_rgn)
+	{
+		cout<<"In SteadyStateCache::drawSteadyState : error (one weight per region is expected)\n";
+		return;
+	}
+
+	bio_world.deleteAllParticles();
+
+	mySteadyStatePool& pool = _getPool(bio_world, spc_idx);
+	ChemicalSpecies* spc = bio_world.getSpecieAdr(spc_idx);
+	FluorophoreSpecies* fluoSpc = bio_world.getFluoSpecieAdr(fluoSpecie_idx);
+
+//multinomial draw of the state counts, the states being ordered as the intervals they own
+	struct particleState
+	{
+		int creation_rgn_idx;
+		bool is_trapped;
+		float interval_min, interval_max;
+		int nb_particles;
+	};
+
+	vector<particleState> particle_states;
+	particle_states.push_back({0, false, 0.0f, freeWeights_v[0], 0});
+	for(int rgn_idx = 1; rgn_idx < N_rgn; rgn_idx++)
+	{
+		if(bio_world.getRegionRef(rgn_idx).isACompartment(spc) == false) continue; //<-
+
+		particle_states.push_back({rgn_idx, false, particle_states.back().interval_max,
+								   particle_states.back().interval_max + freeWeights_v[rgn_idx], 0});
+		particle_states.push_back({rgn_idx, true, particle_states.back().interval_max,
+								   particle_states.back().interval_max + trappedWeights_v[rgn_idx], 0});
+	}
+
+	float interval_MAX = particle_states.back().interval_max;
+	for(int ptcl_idx = 0; ptcl_idx < n; ptcl_idx++)
+	{
+		float value = uniformDistributiion(0.0f, interval_MAX);
+		for(particleState& part_state : particle_states)
+		{
+			if(value >= part_state.interval_min &&
+			   value < part_state.interval_max)
+			{
+				part_state.nb_particles++;
+			}
+		}
+	}
+
+	//as addParticles, no particle is created in a region which is not a compartment of the species
+	for(particleState& part_state : particle_states)
+	{
+		if(bio_world.getRegionRef(part_state.creation_rgn_idx).isACompartment(spc) == false) part_state.nb_particles = 0;
+	}
+
+	vector<int> nbDrawn_v(N_rgn, 0);
+	for(particleState& part_state : particle_states) nbDrawn_v[part_state.creation_rgn_idx] += part_state.nb_particles;
+
+//the pools too small for the draw are completed, the missing particles being created by rejection sampling,
+//without pooling, the positions of the previous draw are discarded and exactly the drawn particles are created
+	for(int rgn_idx = 0; rgn_idx < N_rgn; rgn_idx++)
+	{
+		if(m_arePositionsPooled == false)
+		{
+			pool.r_vv[rgn_idx].clear();
+			pool.towerRadius_vv[rgn_idx].clear();
+			pool.towerInside_vv[rgn_idx].clear();
+		}
+		if(nbDrawn_v[rgn_idx] == 0) continue; //<-
+
+		int pool_size = nbDrawn_v[rgn_idx];
+		if(m_arePositionsPooled) pool_size = int(std::ceil(m_oversampling_factor*nbDrawn_v[rgn_idx]));
+		if(int(pool.r_vv[rgn_idx].size()) < pool_size) _fillPool(bio_world, spc_idx, fluoSpecie_idx, pool, rgn_idx, pool_size);
+	}
+
+//particles are drawn without replacement (partial Fisher-Yates shuffle), free and trapped ones sharing the pool of their creation region
+	vector<Region*> regions_v;
+	for(Region& rgn : bio_world.m_regions) regions_v.push_back(&rgn);
+	Region* cell_rgn = regions_v[0];
+
+	vector<vector<int> > poolIdxs_vv(N_rgn);
+	vector<int> nbTaken_v(N_rgn, 0);
+	for(particleState& part_state : particle_states)
+	{
+		int rgn_idx = part_state.creation_rgn_idx;
+		const vector<vec2>& r_v = pool.r_vv[rgn_idx];
+		const float* towerRadius = pool.towerRadius_vv[rgn_idx].data();
+		const char* towerInside = pool.towerInside_vv[rgn_idx].data();
+		vector<int>& poolIdxs_v = poolIdxs_vv[rgn_idx];
+		if(poolIdxs_v.empty())
+		{
+			poolIdxs_v.resize(r_v.size());
+			for(int idx = 0; idx < int(r_v.size()); idx++) poolIdxs_v[idx] = idx;
+		}
+
+		for(int ptcl_idx = 0; ptcl_idx < part_state.nb_particles; ptcl_idx++)
+		{
+			int& taken = nbTaken_v[rgn_idx];
+			int swap_idx = taken + bio_world.m_randomNumberFactory.uniformIntRandomNumber(int(poolIdxs_v.size()) - taken);
+			std::swap(poolIdxs_v[taken], poolIdxs_v[swap_idx]);
+			int pool_idx = poolIdxs_v[taken];
+			taken++;
+
+			//color and immobility are drawn again by the constructor
+			bio_world.m_particles.push_back(Particle(r_v[pool_idx], cell_rgn, spc, fluoSpc));
+			Particle& ptcl = bio_world.m_particles.back();
+			ptcl.m_trapped = part_state.is_trapped;
+			if(part_state.is_trapped) ptcl.m_child_rgn = regions_v[rgn_idx];
+
+			for(int tower_idx = 0; tower_idx < N_rgn; tower_idx++)
+			{
+				Tower& tower = ptcl.m_towers[regions_v[tower_idx]];
+				tower.r = r_v[pool_idx];
+				tower.radius_squared = towerRadius[pool_idx*N_rgn + tower_idx];
+				tower.isInsideRgn = towerInside[pool_idx*N_rgn + tower_idx];
+				tower.isSet = true;
+			}
+			ptcl._rebuildMembership();
+		}
+	}
+
+	if(m_arePositionsPooled && pool.isToBe_saved && m_storage_folder.empty() == false)
+	{
+		_savePool(_getGeometryKey(bio_world, spc_idx), pool);
+	}
+}
+
+unsigned long long SteadyStateCache::_getGeometryKey(BiologicalWorld& bio_world, int spc_idx)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+
+	int N_rgn = bio_world.getNbRegions();
+	hashBytes(hash, &N_rgn, sizeof(int));
+	hashBytes(hash, &spc_idx, sizeof(int));
+	hashBytes(hash, &m_seed, sizeof(unsigned int));
+
+	ChemicalSpecies* spc = bio_world.getSpecieAdr(spc_idx);
+	for(Region& rgn : bio_world.m_regions)
+	{
+		int nb_vertices = rgn.getSize();
+		char isACompartment = rgn.isACompartment(spc);
+		hashBytes(hash, &nb_vertices, sizeof(int));
+		hashBytes(hash, &isACompartment, sizeof(char));
+		for(int pt_idx = 0; pt_idx < nb_vertices; pt_idx++)
+		{
+			vec2 r = rgn.getPoint(pt_idx);
+			hashBytes(hash, &r, sizeof(vec2));
+		}
+	}
+
+	return hash;
+}
+
+mySteadyStatePool& SteadyStateCache::_getPool(BiologicalWorld& bio_world, int spc_idx)
+{
+	unsigned long long key = _getGeometryKey(bio_world, spc_idx);
+	auto pool_it = m_pools_map.find(key);
+	if(pool_it != m_pools_map.end()) return pool_it->second; //->
+
+	int N_rgn = bio_world.getNbRegions();
+	mySteadyStatePool& pool = m_pools_map[key];
+	if(m_arePositionsPooled && m_storage_folder.empty() == false && _loadPool(key, N_rgn, pool)) return pool; //->
+
+	pool = mySteadyStatePool();
+	pool.surfaces_v.assign(N_rgn, 0.0f);
+	pool.r_vv.resize(N_rgn);
+	pool.towerRadius_vv.resize(N_rgn);
+	pool.towerInside_vv.resize(N_rgn);
+
+	ChemicalSpecies* spc = bio_world.getSpecieAdr(spc_idx);
+	float S2 = 0;
+	for(int rgn_idx = 1; rgn_idx < N_rgn; rgn_idx++)
+	{
+		Region& rgn = bio_world.getRegionRef(rgn_idx);
+		if(rgn.isACompartment(spc) == false) continue; //<-
+
+		vector<vec2> r_v;
+		getIntersectionRegion(bio_world.getRegionRef(0), rgn, r_v);
+		pool.surfaces_v[rgn_idx] = computeSurface(r_v);
+		S2 += pool.surfaces_v[rgn_idx];
+	}
+	pool.surfaces_v[0] = bio_world.getRegionRef(0).getSurface() - S2;
+
+	return pool;
+}
+
+void SteadyStateCache::_fillPool(BiologicalWorld& bio_world, int spc_idx, int fluoSpecie_idx, mySteadyStatePool& pool, int creationRgn_idx, int nb_ptcl)
+{
+	ChemicalSpecies* spc = bio_world.getSpecieAdr(spc_idx);
+	FluorophoreSpecies* fluoSpc = bio_world.getFluoSpecieAdr(fluoSpecie_idx);
+
+	vector<Region*> regions_v;
+	for(Region& rgn : bio_world.m_regions) regions_v.push_back(&rgn);
+	int N_rgn = regions_v.size();
+
+	vector<Region*> forbidden_rgns_v; //the cell state excludes the compartments
+	if(creationRgn_idx == 0)
+	{
+		for(int rgn_idx = 1; rgn_idx < N_rgn; rgn_idx++)
+		{
+			if(regions_v[rgn_idx]->isACompartment(spc)) forbidden_rgns_v.push_back(regions_v[rgn_idx]);
+		}
+	}
+
+	vector<vec2>& r_v = pool.r_vv[creationRgn_idx];
+	vector<float>& towerRadius_v = pool.towerRadius_vv[creationRgn_idx];
+	vector<char>& towerInside_v = pool.towerInside_vv[creationRgn_idx];
+	while(int(r_v.size()) < nb_ptcl)
+	{
+		Particle ptcl(regions_v[0], regions_v[creationRgn_idx], forbidden_rgns_v, spc, fluoSpc);
+		r_v.push_back(ptcl.m_r);
+		for(Region* rgn : regions_v)
+		{
+			bool isInsideRgn;
+			towerRadius_v.push_back(rgn->getMaximumRadiusSquared(ptcl.m_r, isInsideRgn));
+			towerInside_v.push_back(isInsideRgn);
+		}
+	}
+
+	pool.isToBe_saved = true;
+}
+
+string SteadyStateCache::_getPoolFilePath(unsigned long long key)
+{
+	char key_str[17];
+	sprintf(key_str, "%016llx", key);
+	return m_storage_folder + "/steadyState_" + key_str + ".bin";
+}
+
+bool SteadyStateCache::_loadPool(unsigned long long key, int nb_regions, mySteadyStatePool& pool)
+{
+	myBinaryReader reader;
+	if(reader.open(_getPoolFilePath(key)) == false) return false; //->
+
+	unsigned int magic;
+	int version, file_nbRegions;
+	unsigned long long file_key;
+	reader.read(magic);
+	reader.read(version);
+	reader.read(file_key);
+	reader.read(file_nbRegions);
+	if(magic != STEADYSTATE_FILE_MAGIC || version != STEADYSTATE_FILE_VERSION ||
+	   file_key != key || file_nbRegions != nb_regions)
+	{
+		cout<<"In SteadyStateCache::_loadPool : error (the pool file does not match the geometry, it is ignored)\n";
+		return false; //->
+	}
+
+	pool = mySteadyStatePool();
+	pool.r_vv.resize(nb_regions);
+	pool.towerRadius_vv.resize(nb_regions);
+	pool.towerInside_vv.resize(nb_regions);
+	reader.readVector(pool.surfaces_v);
+	for(int rgn_idx = 0; rgn_idx < nb_regions; rgn_idx++)
+	{
+		reader.readVector(pool.r_vv[rgn_idx]);
+		reader.readVector(pool.towerRadius_vv[rgn_idx]);
+		reader.readVector(pool.towerInside_vv[rgn_idx]);
+
+		size_t nb_towers = pool.r_vv[rgn_idx].size()*nb_regions;
+		if(pool.towerRadius_vv[rgn_idx].size() != nb_towers || pool.towerInside_vv[rgn_idx].size() != nb_towers)
+		{
+			cout<<"In SteadyStateCache::_loadPool : error (inconsistent pool file, it is ignored)\n";
+			return false; //->
+		}
+	}
+
+	if(reader.isGood() == false || int(pool.surfaces_v.size()) != nb_regions)
+	{
+		cout<<"In SteadyStateCache::_loadPool : error (truncated pool file, it is ignored)\n";
+		return false; //->
+	}
+
+	return true;
+}
+
+void SteadyStateCache::_savePool(unsigned long long key, mySteadyStatePool& pool)
+{
+	myBinaryWriter writer;
+	if(writer.open(_getPoolFilePath(key)) == false)
+	{
+		cout<<"In SteadyStateCache::_savePool : error (the pool file can't be created)\n";
+		return;
+	}
+
+	writer.write(STEADYSTATE_FILE_MAGIC);
+	writer.write(STEADYSTATE_FILE_VERSION);
+	writer.write(key);
+	writer.write<int>(pool.r_vv.size());
+	writer.writeVector(pool.surfaces_v);
+	for(int rgn_idx = 0; rgn_idx < int(pool.r_vv.size()); rgn_idx++)
+	{
+		writer.writeVector(pool.r_vv[rgn_idx]);
+		writer.writeVector(pool.towerRadius_vv[rgn_idx]);
+		writer.writeVector(pool.towerInside_vv[rgn_idx]);
+	}
+
+	pool.isToBe_saved = writer.isGood() == false;
+}
@@ -0,0 +1,84 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+#ifndef STEADYSTATECACHE_H
+#define STEADYSTATECACHE_H
+
+#include "map"
+#include "string"
+#include "vector"
+
+#include "cellEngine_library_global.h"
+    #include "BiologicalWorld.h"
+#include "toolBox_src/toolBox_library_global.h"
+    #include "toolBox_src/fileAndstring_manipulation/myBinaryFile.h"
+
+
+//equilibrated positions of the particles of a species, for one geometry (region vertices and compartment flags) :
+//the positions only depend on the geometry, the kinetic parameters only set how many particles are drawn in each state,
+//unless the positions are pooled, only the surfaces are reused and fresh positions are drawn at each call
+struct CELLENGINE_LIBRARYSHARED_EXPORT mySteadyStatePool
+{
+	std::vector<float> surfaces_v; //[0] : cell outside the compartments, [rgn_idx] : cell part of the compartment, 0 if not a compartment
+	std::vector<std::vector<glm::vec2> > r_vv; //per creation region, [0] : cell outside the compartments
+	std::vector<std::vector<float> > towerRadius_vv; //per creation region, one tower per region and per particle
+	std::vector<std::vector<char> > towerInside_vv;
+	bool isToBe_saved = false;
+};
+
+class CELLENGINE_LIBRARYSHARED_EXPORT SteadyStateCache
+{
+public :
+
+	SteadyStateCache();
+
+	void setStorageFolder(std::string folder_path); //pools are also saved on disk, empty to keep them in memory only
+	void setOversamplingFactor(float factor); //a pool holds factor times the drawn particles
+	void setArePositionsPooled(bool arePositionsPooled); //opt-in (default : false), successive draws then share their positions
+	void setSeed(unsigned int seed); //pooled positions drawn with different seeds are kept apart
+	void clear();
+
+	const std::vector<float>& getSurfaces(BiologicalWorld& bio_world, int spc_idx);
+
+	//replaces the particles of the world by n particles, each one being in a state with a probability proportional to its weight :
+	//free in the cell outside the compartments (freeWeights_v[0]), free or trapped in a compartment (freeWeights_v[rgn_idx], trappedWeights_v[rgn_idx])
+	void drawSteadyState(BiologicalWorld& bio_world, int spc_idx, int fluoSpecie_idx, int n,
+						 const std::vector<float>& freeWeights_v, const std::vector<float>& trappedWeights_v);
+
+private :
+
+	unsigned long long _getGeometryKey(BiologicalWorld& bio_world, int spc_idx);
+	mySteadyStatePool& _getPool(BiologicalWorld& bio_world, int spc_idx);
+	void _fillPool(BiologicalWorld& bio_world, int spc_idx, int fluoSpecie_idx, mySteadyStatePool& pool, int creationRgn_idx, int nb_ptcl);
+
+	std::string _getPoolFilePath(unsigned long long key);
+	bool _loadPool(unsigned long long key, int nb_regions, mySteadyStatePool& pool);
+	void _savePool(unsigned long long key, mySteadyStatePool& pool);
+
+private :
+
+	std::map<unsigned long long, mySteadyStatePool> m_pools_map;
+	std::string m_storage_folder;
+	float m_oversampling_factor;
+	bool m_arePositionsPooled;
+	unsigned int m_seed;
+};
+
+
+#endif // STEADYSTATECACHE_H
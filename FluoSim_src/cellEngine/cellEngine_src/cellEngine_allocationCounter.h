@@ -0,0 +1,35 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#ifndef CELLENGINE_ALLOCATIONCOUNTER_H
+#define CELLENGINE_ALLOCATIONCOUNTER_H
+
+#include "cellEngine_library_global.h"
+
+
+//heap allocations made by the code of the library, counted only when it is built with CONFIG+=countAllocations :
+//a windows dll keeps the operator new of its own runtime, the one an executable replaces does not see them.
+//Where operator new is resolved globally (linux, macOS), the replacement of the executable serves the library too.
+
+CELLENGINE_LIBRARYSHARED_EXPORT bool areLibraryAllocationsCounted();
+CELLENGINE_LIBRARYSHARED_EXPORT long long getNbLibraryAllocations();
+
+
+#endif // CELLENGINE_ALLOCATIONCOUNTER_H
@@ -0,0 +1,151 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+
+
+#include "RegionRenderer.h"
+
+
+using namespace std;
+using namespace glm;
+
+RegionRenderer::RegionRenderer()
+{
+	m_pgm = 0;
+	m_r_gv = 0;
+}
+
+RegionRenderer::~RegionRenderer()
+{
+	//the GL program and buffer are released with the context
+	if(m_pgm != 0) delete m_pgm;
+	if(m_r_gv != 0) delete m_r_gv;
+}
+
+void RegionRenderer::_createProgram()
+{
+	string vs_raw_src;
+	vs_raw_src +="#version 150 core\n"
+				"\n"
+				"in vec2 R;\n"
+				"uniform mat4 scaling_matrix;\n"
+				"\n"
+				"void main(void)\n"
+				"{\n"
+				"	vec4 temp = vec4(R,0.0, 1.0);\n"
+				"	gl_Position = scaling_matrix*temp;\n"
+				"}\n";
+
+	string fs_raw_src;
+	fs_raw_src +="#version 150 core\n\n"
+				"\n"
+				"uniform vec4 color;\n"
+				"out vec4 gl_FragColor;\n"
+				"\n"
+				"void main(void)\n"
+				"{\n"
+				"	gl_FragColor=color;\n"
+				"}\n";
+
+	string log;
+	gstd::gShader vs_raw(gstd::VERTEX_SHADER);
+		vs_raw.setSource(vs_raw_src, 0);
+		vs_raw.compile(log);
+	gstd::gShader fs_raw(gstd::FRAGMENT_SHADER);
+		fs_raw.setSource(fs_raw_src, 0);
+		fs_raw.compile(log);
+	m_pgm = new gstd::gProgram("regionRendering");
+		m_pgm->addShader(vs_raw);
+		m_pgm->addShader(fs_raw);
+		m_pgm->linkShaders(log);
+}
+
+void RegionRenderer::_updateBuffer(list<Region>& regions)
+{
+	if(m_r_gv == 0) m_r_gv = new gstd::gVector<vec2>();
+	else
+	{
+		//the revisions are unique across the regions : a modified, added or removed region changes the sequence
+		bool isUpToDate = m_revisions_v.size() == regions.size();
+		auto revision = m_revisions_v.begin();
+		for(auto rgn = regions.begin(); isUpToDate && rgn != regions.end(); rgn++, revision++)
+		{
+			isUpToDate = rgn->getRevision() == *revision;
+		}
+		if(isUpToDate) return; //-> unchanged contours
+	}
+
+	m_revisions_v.clear();
+	m_offsets_v.clear();
+	m_r_v.clear();
+
+	vector<vec2> region_r;
+	for(Region& rgn : regions)
+	{
+		m_revisions_v.push_back(rgn.getRevision());
+		m_offsets_v.push_back(m_r_v.size());
+		region_r.clear();
+		rgn.getRegionSubData(&region_r, 0, rgn.getSize());
+		m_r_v.insert(m_r_v.end(), region_r.begin(), region_r.end());
+	}
+	m_offsets_v.push_back(m_r_v.size());
+
+	m_r_gv->clear();
+	m_r_gv->insert(0, m_r_v);
+}
+
+void RegionRenderer::render(list<Region>& regions, myGLObject* renderingTarget)
+{
+	if(renderingTarget->isRenderingTargetObject() == false || regions.empty()) return; //->
+
+	_updateBuffer(regions);
+	if(m_r_v.empty()) return; //->
+
+	mat4 m = renderingTarget->getWorldToExtendedHomMatrix();
+	if(m_pgm == 0) _createProgram();
+	gstd::gProgram& pgm = *m_pgm;
+
+	glDisable(GL_BLEND);
+	glLineWidth(2.0);
+
+	pgm.useProgram(true);
+
+	gstd::myConnector<vec2>::connect(pgm, "R", *m_r_gv);
+	gstd::connectUniform(pgm, "scaling_matrix", (float*) &m);
+
+	//first pass : regular regions, second pass : highlighted ones on top of them
+	for(int pass_idx = 0; pass_idx <= 1; pass_idx++)
+	{
+		int rgn_idx = 0;
+		for(Region& rgn : regions)
+		{
+			int nb_vertices = m_offsets_v[rgn_idx+1] - m_offsets_v[rgn_idx];
+			if(rgn.isHighlighted() == bool(pass_idx) && nb_vertices != 0)
+			{
+				vec4 color = rgn.isHighlighted() ? rgn.getHighlightedColor() : rgn.getColor();
+				gstd::connectUniform(pgm, "color", &color);
+				glDrawArrays(GL_LINE_LOOP, m_offsets_v[rgn_idx], nb_vertices);
+			}
+			rgn_idx++;
+		}
+	}
+
+	pgm.useProgram(false);
+}
@@ -0,0 +1,70 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#ifndef REGIONRENDERER_H
+#define REGIONRENDERER_H
+
+#include "list"
+#include "vector"
+
+#include "glm.hpp"
+
+#include "cellEngine_library_global.h"
+    #include "biologicalWorld/Region_gpu.h"
+
+#include "gpuTools_library_global.h"
+    #include "gl/gProgram.h"
+    #include "gl/gVector.h"
+    #include "gl/gToolBox.h"
+
+#include "toolBox_src/toolBox_library_global.h"
+    #include "glGUI/glObjects/myGLObject.h"
+
+
+//draws the contours of a list of regions : one vertex buffer holds every contour (uploaded again only when
+//a region revision has changed) and one program, both created on the first rendering in the current GL context,
+//a renderer is therefore bound to the context it first renders in
+class CELLENGINE_LIBRARYSHARED_EXPORT RegionRenderer
+{
+public :
+
+	RegionRenderer();
+	~RegionRenderer();
+
+	RegionRenderer(const RegionRenderer&) = delete;
+	RegionRenderer& operator=(const RegionRenderer&) = delete;
+
+	void render(std::list<Region>& regions, myGLObject* renderingTarget); //the highlighted regions are drawn last
+
+private :
+
+	void _createProgram();
+	void _updateBuffer(std::list<Region>& regions);
+
+	gstd::gProgram* m_pgm; //created on the first rendering, a GL context being current
+	gstd::gVector<glm::vec2>* m_r_gv;
+	std::vector<unsigned long long> m_revisions_v; //revision of each region of the buffer
+	std::vector<int> m_offsets_v; //first vertex of each region, the last entry being the total size
+	std::vector<glm::vec2> m_r_v; //content of the buffer
+};
+
+
+
+#endif // REGIONRENDERER_H
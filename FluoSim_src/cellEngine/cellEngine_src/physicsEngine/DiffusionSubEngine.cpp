@@ -20,28 +20,42 @@
 
 
 
+#include "algorithm"
+
 #include "DiffusionSubEngine.h"
 
 
 using namespace std;
 using namespace glm;
 
-DiffusionSubEngine::DiffusionSubEngine(BiologicalWorld * bio_wolrd)
+DiffusionSubEngine::DiffusionSubEngine(BiologicalWorld * bio_wolrd) :
+
+	m_photophysics_engine(bio_wolrd)
 {
 	m_bio_world = bio_wolrd;
 
 	m_singleThreadLoop_clock.setNbRecordedTours(20);
 	m_multiThreadLoop_clock.setNbRecordedTours(20);
 
+	m_engine_mode = AUTOMATIC_SELECTION_MODE;
+	m_engine_selected_mode = SINGLETHREADED_SELECTED_MODE;
+	m_isSelectedModePinned = false;
+	updateSelectedMode();
+
+	m_fastForward_safetyFactor = 4.0f;
+	m_nbFastForwarded = 0;
+
 	m_nbThreadsMulti_perIt = std::thread::hardware_concurrency();
 	cout<<"Hint multiThread : "<<std::thread::hardware_concurrency()<<"\n";
 
 	for(int t_idx= 0; t_idx <= m_nbThreadsMulti_perIt-1; t_idx++)
 	{
 		m_threads_v.push_back(thread());
-        m_randomFactories_v.push_back(RandomNumberGenerator());
+		m_randomFactories_v.push_back(RandomNumberGenerator());
 	}
 
+	//one decorrelated stream per thread (identical or consecutive seeds would correlate the particles of different threads)
+	setRandomSeed(std::default_random_engine::default_seed);
 }
 
 void DiffusionSubEngine::updateSubSystem(float delta_t, int particle_idx_beg, int particle_idx_end, int thread_idx)
@@ -53,50 +67,82 @@ void DiffusionSubEngine::updateSubSystem(float delta_t, int particle_idx_beg, in
 	advance(particle_beg, particle_idx_beg);
 	advance(particle_end, particle_idx_end);
 
-	if(m_bio_world->isFixed() == true)
+	//only reached for a moving world : a fixed one is updated by the photophysics engine
+	const char* isSkipped = m_isFastForwarded_v.empty() ? 0 : m_isFastForwarded_v.data() + particle_idx_beg;
+	_updateParticles(delta_t, particle_beg, particle_end, m_randomFactories_v[thread_idx], isSkipped);
+}
+
+void DiffusionSubEngine::_updateParticles(float delta_t, list<Particle>::iterator particle_beg,
+										  list<Particle>::iterator particle_end, RandomNumberGenerator& random_factory,
+										  const char* isSkipped)
+{
+	if(myProfiler::isEnabled() == false)
 	{
-		for(auto particle = particle_beg; particle != particle_end; particle++)
+		int ptcl_idx = 0;
+		for(auto particle = particle_beg; particle != particle_end; particle++, ptcl_idx++)
 		{
-			particle->updatePhotophysicState(delta_t, m_bio_world->m_randomNumberFactory);
+			if(isSkipped != 0 && isSkipped[ptcl_idx]) continue; //<-
+
+			particle->updatePosition(delta_t,m_bio_world->m_regions, random_factory);
+			m_bio_world->updateTrappingState(delta_t, *particle, random_factory);
+			m_bio_world->updateD(*particle);
+			particle->updatePhotophysicState(delta_t, random_factory);
 		}
+		return; //->
 	}
-	else
+
+	//profiled version : the time spent in each stage is accumulated over the particles
+	//and recorded as consecutive sub-zones of the diffusion zone
+	long long diffusion_start = myProfiler::getTime_ns();
+	long long reflection_time = 0;
+	long long trapping_time = 0;
+	long long photophysics_time = 0;
+
+	myProfiler::beginZone("diffusion");
+	int ptcl_idx = 0;
+	for(auto particle = particle_beg; particle != particle_end; particle++, ptcl_idx++)
 	{
-		int particle_idx = 0;
-		for(auto particle = particle_beg; particle != particle_end; particle++)
-		{
-			particle->updatePosition(delta_t,m_bio_world->m_regions,  m_randomFactories_v[thread_idx]);
-			m_bio_world->updateTrappingState(delta_t, *particle, m_randomFactories_v[thread_idx]);
-			m_bio_world->updateD(*particle);
-			particle->updatePhotophysicState(delta_t, m_randomFactories_v[thread_idx]);
-			particle_idx++;
-		}
+		if(isSkipped != 0 && isSkipped[ptcl_idx]) continue; //<-
+
+		long long t0 = myProfiler::getTime_ns();
+		particle->updatePosition(delta_t,m_bio_world->m_regions, random_factory);
+		long long t1 = myProfiler::getTime_ns();
+		m_bio_world->updateTrappingState(delta_t, *particle, random_factory);
+		m_bio_world->updateD(*particle);
+		long long t2 = myProfiler::getTime_ns();
+		particle->updatePhotophysicState(delta_t, random_factory);
+		long long t3 = myProfiler::getTime_ns();
+
+		reflection_time += t1-t0;
+		trapping_time += t2-t1;
+		photophysics_time += t3-t2;
 	}
+	myProfiler::addZone("displacement & reflection", diffusion_start, reflection_time);
+	myProfiler::addZone("trapping", diffusion_start + reflection_time, trapping_time);
+	myProfiler::addZone("photophysics", diffusion_start + reflection_time + trapping_time, photophysics_time);
+	myProfiler::endZone();
 }
 
 
 void DiffusionSubEngine::updateSystem(float delta_t)
 {
+	PROFILE_ZONE("updateSystem");
+	m_bio_world->updateKineticTable(delta_t); //no-op unless a parameter, a region or dt has changed
+	m_bio_world->updateRegionLookup(); //no-op unless a region has been added or deleted
+	if(m_bio_world->isFixed() == false) m_photophysics_engine.invalidate(); //the particles blink on their own
+
 	switch(m_engine_mode)
 	{
 		case SINGLETHREADED_MODE :
 		{
 			if(m_bio_world->isFixed() == true)
 			{
-				for(Particle& part : m_bio_world->m_particles)
-				{
-					part.updatePhotophysicState(delta_t, m_bio_world->m_randomNumberFactory);
-				}
+				m_photophysics_engine.updateSystem(delta_t, m_randomFactories_v, false);
 			}
 			else
 			{
-				for(Particle& part : m_bio_world->m_particles)
-				{
-					part.updatePosition(delta_t, m_bio_world->m_regions, m_bio_world->m_randomNumberFactory);
-					m_bio_world->updateTrappingState(delta_t, part, m_bio_world->m_randomNumberFactory);
-					m_bio_world->updateD(part);
-					part.updatePhotophysicState(delta_t, m_bio_world->m_randomNumberFactory);
-				}
+				_updateParticles(delta_t, m_bio_world->m_particles.begin(), m_bio_world->m_particles.end(),
+								 m_bio_world->m_randomNumberFactory, m_isFastForwarded_v.empty() ? 0 : m_isFastForwarded_v.data());
 			}
 		}
 		break;
@@ -104,6 +150,12 @@ void DiffusionSubEngine::updateSystem(float delta_t)
 		case MULTITHREADED_MODE :
 		{
 			m_multiThreadLoop_clock.startTour();
+			if(m_bio_world->isFixed() == true)
+			{
+				m_photophysics_engine.updateSystem(delta_t, m_randomFactories_v, true);
+				m_multiThreadLoop_clock.endTour();
+				break; //->
+			}
 
 			int nbThreads = m_nbThreadsMulti_perIt;
 
@@ -187,20 +239,12 @@ void DiffusionSubEngine::updateSystem(float delta_t)
 					m_singleThreadLoop_clock.startTour();
 					if(m_bio_world->isFixed() == true)
 					{
-						for(Particle& part : m_bio_world->m_particles)
-						{
-							part.updatePhotophysicState(delta_t, m_bio_world->m_randomNumberFactory);
-						}
+						m_photophysics_engine.updateSystem(delta_t, m_randomFactories_v, false);
 					}
 					else
 					{
-						for(Particle& part : m_bio_world->m_particles)
-						{
-							part.updatePosition(delta_t, m_bio_world->m_regions, m_bio_world->m_randomNumberFactory);
-							m_bio_world->updateTrappingState(delta_t, part, m_bio_world->m_randomNumberFactory);
-							m_bio_world->updateD(part);
-							part.updatePhotophysicState(delta_t, m_bio_world->m_randomNumberFactory);
-						}
+						_updateParticles(delta_t, m_bio_world->m_particles.begin(), m_bio_world->m_particles.end(),
+										 m_bio_world->m_randomNumberFactory, m_isFastForwarded_v.empty() ? 0 : m_isFastForwarded_v.data());
 					}
 					m_singleThreadLoop_clock.endTour();
 				}
@@ -209,6 +253,12 @@ void DiffusionSubEngine::updateSystem(float delta_t)
 				case MULTITHREADED_SELECTED_MODE :
 				{
 					m_multiThreadLoop_clock.startTour();
+					if(m_bio_world->isFixed() == true)
+					{
+						m_photophysics_engine.updateSystem(delta_t, m_randomFactories_v, true);
+						m_multiThreadLoop_clock.endTour();
+						break; //->
+					}
 
 					int nbThreads = m_nbThreadsMulti_perIt;
 
@@ -255,6 +305,167 @@ void DiffusionSubEngine::updateSystem(float delta_t)
 	}
 }
 
+void DiffusionSubEngine::updateSystem(float delta_t, int nb_steps)
+{
+	if(nb_steps <= 1 || m_bio_world->isFixed() == true)
+	{
+		for(int step_idx = 0; step_idx < nb_steps; step_idx++) updateSystem(delta_t);
+		return; //->
+	}
+
+	PROFILE_ZONE("fastForward");
+	m_bio_world->updateKineticTable(delta_t);
+	m_bio_world->updateRegionLookup();
+
+	//aggregated jumps, with the particle split and the random streams of the regular steps
+	int nb_particles = m_bio_world->m_particles.size();
+	m_isFastForwarded_v.assign(nb_particles, 0);
+
+	int nbThreads = getNbThreads();
+	if(nbThreads == 1)
+	{
+		_fastForwardSubSystem(delta_t, nb_steps, 0, nb_particles, &m_bio_world->m_randomNumberFactory);
+	}
+	else
+	{
+		int nb_particle_per_thread = nb_particles/nbThreads;
+		for(int thread_idx = 0; thread_idx < nbThreads; thread_idx++)
+		{
+			int particle_idx_end = (thread_idx == nbThreads-1 ? nb_particles : (thread_idx+1)*nb_particle_per_thread);
+			m_threads_v[thread_idx] = thread(&DiffusionSubEngine::_fastForwardSubSystem, this,
+											 delta_t, nb_steps,
+											 thread_idx*nb_particle_per_thread, particle_idx_end,
+											 &m_randomFactories_v[thread_idx]);
+		}
+		for(int thread_idx = 0; thread_idx < nbThreads; thread_idx++) m_threads_v[thread_idx].join();
+	}
+	m_nbFastForwarded = std::count(m_isFastForwarded_v.begin(), m_isFastForwarded_v.end(), 1);
+
+	//the other particles are stepped as usual
+	if(m_nbFastForwarded != nb_particles)
+	{
+		for(int step_idx = 0; step_idx < nb_steps; step_idx++) updateSystem(delta_t);
+	}
+	m_isFastForwarded_v.clear();
+}
+
+void DiffusionSubEngine::_fastForwardSubSystem(float delta_t, int nb_steps, int particle_idx_beg, int particle_idx_end,
+											   RandomNumberGenerator* random_factory)
+{
+	auto particle = m_bio_world->m_particles.begin();
+	advance(particle, particle_idx_beg);
+
+	int nb_regions = m_bio_world->m_regions.size();
+	for(int ptcl_idx = particle_idx_beg; ptcl_idx < particle_idx_end; ptcl_idx++, particle++)
+	{
+		m_isFastForwarded_v[ptcl_idx] = particle->fastForward(delta_t, nb_steps, m_fastForward_safetyFactor,
+															   nb_regions, *random_factory);
+	}
+}
+
+void DiffusionSubEngine::setFastForwardSafetyFactor(float safety_factor)
+{
+	if(safety_factor <= 0)
+	{
+		cout<<"In DiffusionSubEngine::setFastForwardSafetyFactor : error (safety_factor <= 0)\n";
+		return;
+	}
+	m_fastForward_safetyFactor = safety_factor;
+}
+
+int DiffusionSubEngine::getNbFastForwardedParticles() const
+{
+	return m_nbFastForwarded;
+}
+
+vector<RandomNumberGenerator>& DiffusionSubEngine::getRandomFactoriesRef()
+{
+	return m_randomFactories_v;
+}
+
+void DiffusionSubEngine::setRandomSeed(unsigned int seed)
+{
+	for(uint t_idx = 0; t_idx < m_randomFactories_v.size(); t_idx++)
+	{
+		std::seed_seq seed_sequence{seed, t_idx};
+		unsigned int thread_seed;
+		seed_sequence.generate(&thread_seed, &thread_seed + 1);
+
+		m_randomFactories_v[t_idx].setSeed(thread_seed);
+	}
+}
+
+void DiffusionSubEngine::saveState(myBinaryWriter& writer)
+{
+	//the selection is timed on the wall-clock : it is ended here so that this run and the restored one go on alike
+	m_isUpdatingSelectedMode = false;
+	m_isSelectedModePinned = true;
+
+	writer.write<int>(m_engine_mode);
+	writer.write<int>(m_engine_selected_mode);
+	writer.write<bool>(m_isUpdatingSelectedMode);
+	writer.write<unsigned int>(m_currentNbMeasureInSingleThread);
+	writer.write<unsigned int>(m_currentNbMeasureInMultiThread);
+
+	//the single threaded steps draw from the world stream, the multi threaded ones from the per-thread streams
+	m_bio_world->m_randomNumberFactory.saveState(writer);
+	writer.write<int>(m_randomFactories_v.size());
+	for(const RandomNumberGenerator& random_factory : m_randomFactories_v) random_factory.saveState(writer);
+}
+
+bool DiffusionSubEngine::loadState(myBinaryReader& reader)
+{
+	int engine_mode, engine_selectedMode;
+	bool isUpdatingSelectedMode;
+	unsigned int nbMeasureInSingleThread, nbMeasureInMultiThread;
+	reader.read(engine_mode);
+	reader.read(engine_selectedMode);
+	reader.read(isUpdatingSelectedMode);
+	reader.read(nbMeasureInSingleThread);
+	reader.read(nbMeasureInMultiThread);
+	if(reader.isGood() == false ||
+	   engine_mode < SINGLETHREADED_MODE || engine_mode > AUTOMATIC_SELECTION_MODE ||
+	   engine_selectedMode < SINGLETHREADED_SELECTED_MODE || engine_selectedMode > MULTITHREADED_SELECTED_MODE)
+	{
+		cout<<"In DiffusionSubEngine::loadState : error (corrupted engine mode)\n";
+		return false; //->
+	}
+
+	RandomNumberGenerator world_factory;
+	if(world_factory.loadState(reader) == false) return false; //->
+
+	int nb_factories;
+	reader.read(nb_factories);
+	if(reader.isGood() == false || nb_factories < 0) return false; //->
+
+	//with another number of threads the particles are not split the same way : the run would diverge
+	if(nb_factories != int(m_randomFactories_v.size()))
+	{
+		cout<<"In DiffusionSubEngine::loadState : error (state saved with "<<nb_factories<<" threads, "<<
+			  m_randomFactories_v.size()<<" here)\n";
+		return false; //->
+	}
+
+	vector<RandomNumberGenerator> randomFactories_v(nb_factories);
+	for(RandomNumberGenerator& random_factory : randomFactories_v)
+	{
+		if(random_factory.loadState(reader) == false) return false; //->
+	}
+
+	//nothing is changed before the whole state has been read
+	m_engine_mode = ENGINE_MODE(engine_mode);
+	m_engine_selected_mode = ENGINE_SELECTED_MODE(engine_selectedMode);
+	m_isUpdatingSelectedMode = isUpdatingSelectedMode;
+	m_currentNbMeasureInSingleThread = nbMeasureInSingleThread;
+	m_currentNbMeasureInMultiThread = nbMeasureInMultiThread;
+	m_isSelectedModePinned = true;
+
+	m_bio_world->m_randomNumberFactory = world_factory;
+	m_randomFactories_v.swap(randomFactories_v);
+
+	return true;
+}
+
 int DiffusionSubEngine::getNbThreads()
 {
 	if(m_engine_mode == SINGLETHREADED_MODE || (m_engine_mode == AUTOMATIC_SELECTION_MODE &&
@@ -268,6 +479,7 @@ int DiffusionSubEngine::getNbThreads()
 void DiffusionSubEngine::setEngineMode(ENGINE_MODE engine_mode)
 {
 	m_engine_mode = engine_mode;
+	m_isSelectedModePinned = false;
 }
 
 
@@ -279,6 +491,8 @@ DiffusionSubEngine::ENGINE_MODE DiffusionSubEngine::getEngineMode()
 
 void DiffusionSubEngine::updateSelectedMode()
 {
+	if(m_isSelectedModePinned == true) return; //-> a checkpointed run keeps its split of the particles
+
 	m_isUpdatingSelectedMode = true;
 	m_currentNbMeasureInSingleThread = 0;
 	m_currentNbMeasureInMultiThread = 0;
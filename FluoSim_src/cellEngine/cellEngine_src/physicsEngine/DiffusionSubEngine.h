@@ -30,8 +30,10 @@
     #include "biologicalWorld/Particle.h"
     #include "biologicalWorld/BiologicalWorld.h"
     #include "RandomNumberGenerator.h"
+    #include "PhotophysicsSubEngine.h"
 
 #include "toolBox_src/developmentTools/myClock.h"
+#include "toolBox_src/developmentTools/myProfiler.h"
 
 
 class CELLENGINE_LIBRARYSHARED_EXPORT DiffusionSubEngine
@@ -44,16 +46,35 @@ public :
     DiffusionSubEngine(BiologicalWorld* bio_wolrd);
 	void updateSubSystem(float delta_t, int particle_idx_beg, int particle_idx_end,  int subSystem_idx);
 	void updateSystem(float delta_t);
+	//nb_steps updates at once (time-lapse planes without acquisition in between) : the particles which are far from
+	//the region edges and can't change of state take a single aggregated jump, the others are stepped at delta_t
+	void updateSystem(float delta_t, int nb_steps);
+	void setFastForwardSafetyFactor(float safety_factor); //edges farther than factor*sqrt(4*D*nb_steps*delta_t), 4 by default
+	int getNbFastForwardedParticles() const; //during the last fast-forward
 	void setEngineMode(ENGINE_MODE engine_mode);
 	ENGINE_MODE getEngineMode();
 
 	int getNbThreads();
+	vector<RandomNumberGenerator>& getRandomFactoriesRef(); //one per thread, can be used by the other per-step stages
+	void setRandomSeed(unsigned int seed); //reproducible run : one decorrelated stream per thread
+	//random streams and engine mode, the particles belong to the biological world.
+	//Saving or loading pins the automatic selection : the particles are split the same way in both runs.
+	void saveState(myBinaryWriter& writer);
+	bool loadState(myBinaryReader& reader); //fails if the state was saved with another number of threads
 
-	void updateSelectedMode();
+	void updateSelectedMode(); //no-op once the selection is pinned, until the next setEngineMode
 
 	float getSingeThreadTime() const;
 	float getMultiThreadTime() const;
 
+private:
+
+	void _updateParticles(float delta_t, std::list<Particle>::iterator particle_beg,
+						  std::list<Particle>::iterator particle_end, RandomNumberGenerator& random_factory,
+						  const char* isSkipped = 0);
+	void _fastForwardSubSystem(float delta_t, int nb_steps, int particle_idx_beg, int particle_idx_end,
+							   RandomNumberGenerator* random_factory);
+
 private:
 
     BiologicalWorld* m_bio_world;
@@ -61,6 +82,7 @@ private:
 	ENGINE_MODE m_engine_mode;
 	ENGINE_SELECTED_MODE m_engine_selected_mode;
 	bool m_isUpdatingSelectedMode;
+	bool m_isSelectedModePinned;
 	uint m_currentNbMeasureInSingleThread;
 	uint m_currentNbMeasureInMultiThread;
 
@@ -68,6 +90,12 @@ private:
 	vector<thread> m_threads_v;
     vector<RandomNumberGenerator> m_randomFactories_v;
 
+	PhotophysicsSubEngine m_photophysics_engine; //fixed sample : blinking only, sampled in bulk
+
+	vector<char> m_isFastForwarded_v; //particles skipped by the steps of the current fast-forward, empty otherwise
+	float m_fastForward_safetyFactor;
+	int m_nbFastForwarded;
+
 	myChrono m_singleThreadLoop_clock;
 	myChrono m_multiThreadLoop_clock;
 
@@ -0,0 +1,226 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+
+
+#include "algorithm"
+
+#include "PhotophysicsSubEngine.h"
+
+
+using namespace std;
+
+PhotophysicsSubEngine::PhotophysicsSubEngine(BiologicalWorld* bio_world)
+{
+	m_bio_world = bio_world;
+	m_isSynchronized = false;
+	m_fluoStates_revision = 0;
+}
+
+void PhotophysicsSubEngine::invalidate()
+{
+	m_isSynchronized = false;
+}
+
+int PhotophysicsSubEngine::getNbParticles() const
+{
+	return m_fluorophores_v.size();
+}
+
+bool PhotophysicsSubEngine::isBleached(int ptcl_idx) const
+{
+	return (m_bleached_v[ptcl_idx >> 6] >> (ptcl_idx & 63)) & 1;
+}
+
+bool PhotophysicsSubEngine::isBlinked(int ptcl_idx) const
+{
+	return (m_blinked_v[ptcl_idx >> 6] >> (ptcl_idx & 63)) & 1;
+}
+
+void PhotophysicsSubEngine::updateSystem(float delta_t, vector<RandomNumberGenerator>& random_factories, bool isMultithreaded)
+{
+	PROFILE_ZONE("photophysics");
+	if(random_factories.empty()) return; //->
+
+	//particles added, deleted or photomanipulated since the last step
+	int nb_shards = random_factories.size();
+	if(m_isSynchronized == false ||
+	   m_fluoStates_revision != m_bio_world->m_fluoStates_revision ||
+	   m_fluorophores_v.size() != m_bio_world->m_particles.size() ||
+	   int(m_shards_v.size()) != nb_shards)
+	{
+		_synchronize(nb_shards);
+	}
+
+	//the update is in o(transitions) : spawning the threads only pays off for large samples
+	if(isMultithreaded == false || m_fluorophores_v.size() < 100000)
+	{
+		for(int shard_idx = 0; shard_idx < nb_shards; shard_idx++)
+		{
+			_updateShard(delta_t, &m_shards_v[shard_idx], &random_factories[shard_idx]);
+		}
+		return; //->
+	}
+
+	m_threads_v.resize(nb_shards);
+	for(int shard_idx = 0; shard_idx < nb_shards; shard_idx++)
+	{
+		m_threads_v[shard_idx] = thread(&PhotophysicsSubEngine::_updateShard, this, delta_t,
+										&m_shards_v[shard_idx], &random_factories[shard_idx]);
+	}
+	for(thread& t : m_threads_v) t.join();
+}
+
+void PhotophysicsSubEngine::_synchronize(int nb_shards)
+{
+	PROFILE_ZONE("photophysics synchronization");
+
+	list<Particle>& particles = m_bio_world->m_particles;
+	int nb_particles = particles.size();
+	int nb_words = (nb_particles+63)/64;
+
+	m_fluorophores_v.resize(nb_particles);
+	m_fluoSpecieIdx_v.resize(nb_particles);
+	m_fluoSpecies_v.clear();
+	m_bleached_v.assign(nb_words, 0);
+	m_blinked_v.assign(nb_words, 0);
+
+	int ptcl_idx = 0;
+	int fluoSpecie_idx = -1;
+	for(Particle& ptcl : particles)
+	{
+		Fluorophore* fluorophore = ptcl.getFluorophore();
+		const FluorophoreSpecies* fluo_spc = fluorophore->getFluoSpecie();
+
+		//particles of a same species are usually contiguous
+		if(fluoSpecie_idx == -1 || m_fluoSpecies_v[fluoSpecie_idx] != fluo_spc)
+		{
+			auto spc_it = find(m_fluoSpecies_v.begin(), m_fluoSpecies_v.end(), fluo_spc);
+			fluoSpecie_idx = spc_it - m_fluoSpecies_v.begin();
+			if(spc_it == m_fluoSpecies_v.end()) m_fluoSpecies_v.push_back(fluo_spc);
+		}
+
+		m_fluorophores_v[ptcl_idx] = fluorophore;
+		m_fluoSpecieIdx_v[ptcl_idx] = fluoSpecie_idx;
+
+		uint64_t bit = uint64_t(1) << (ptcl_idx & 63);
+		if(fluorophore->isBleached()) m_bleached_v[ptcl_idx >> 6] |= bit;
+		if(fluorophore->isBlinked()) m_blinked_v[ptcl_idx >> 6] |= bit;
+		ptcl_idx++;
+	}
+
+	if(m_fluoSpecies_v.size() > 256)
+	{
+		cout<<"In PhotophysicsSubEngine::_synchronize : error (more than 256 fluorophore species)\n";
+		m_fluorophores_v.clear();
+		m_fluoSpecies_v.clear();
+	}
+
+	//shards boundaries on whole words : the threads never write the same word of the bitsets
+	int nb_particle_per_shard = 64*((nb_words + nb_shards-1)/nb_shards);
+	m_shards_v.resize(nb_shards);
+	for(int shard_idx = 0; shard_idx < nb_shards; shard_idx++)
+	{
+		myPhotophysicsShard& shard = m_shards_v[shard_idx];
+		shard.ptcl_idx_beg = std::min(shard_idx*nb_particle_per_shard, int(m_fluorophores_v.size()));
+		shard.ptcl_idx_end = std::min((shard_idx+1)*nb_particle_per_shard, int(m_fluorophores_v.size()));
+		shard.isToBe_built = true;
+	}
+
+	m_fluoStates_revision = m_bio_world->m_fluoStates_revision;
+	m_isSynchronized = true;
+}
+
+void PhotophysicsSubEngine::_buildShard(myPhotophysicsShard& shard)
+{
+	int nb_fluoSpecies = m_fluoSpecies_v.size();
+	shard.emitting_vv.resize(nb_fluoSpecies);
+	shard.blinked_vv.resize(nb_fluoSpecies);
+	for(int fluoSpecie_idx = 0; fluoSpecie_idx < nb_fluoSpecies; fluoSpecie_idx++)
+	{
+		shard.emitting_vv[fluoSpecie_idx].clear();
+		shard.blinked_vv[fluoSpecie_idx].clear();
+	}
+
+	for(int ptcl_idx = shard.ptcl_idx_beg; ptcl_idx < shard.ptcl_idx_end; ptcl_idx++)
+	{
+		if(isBleached(ptcl_idx)) continue; //<- bleaching is irreversible
+
+		int fluoSpecie_idx = m_fluoSpecieIdx_v[ptcl_idx];
+		if(isBlinked(ptcl_idx)) shard.blinked_vv[fluoSpecie_idx].push_back(ptcl_idx);
+		else shard.emitting_vv[fluoSpecie_idx].push_back(ptcl_idx);
+	}
+	shard.isToBe_built = false;
+}
+
+void PhotophysicsSubEngine::_updateShard(float delta_t, myPhotophysicsShard* shard, RandomNumberGenerator* random_factory)
+{
+	if(shard->isToBe_built) _buildShard(*shard);
+
+	int nb_fluoSpecies = m_fluoSpecies_v.size();
+	for(int fluoSpecie_idx = 0; fluoSpecie_idx < nb_fluoSpecies; fluoSpecie_idx++)
+	{
+		const FluorophoreSpecies* fluo_spc = m_fluoSpecies_v[fluoSpecie_idx];
+		vector<int>& emitting_v = shard->emitting_vv[fluoSpecie_idx];
+		vector<int>& blinked_v = shard->blinked_vv[fluoSpecie_idx];
+
+		//both counts are drawn on the states at the beginning of the step : one transition per particle at most
+		int nb_blinking = random_factory->binomialRandomNumber(emitting_v.size(), fluo_spc->getKoff()*delta_t);
+		int nb_unblinking = random_factory->binomialRandomNumber(blinked_v.size(), fluo_spc->getKon()*delta_t);
+
+		_drawSwitching(blinked_v, nb_unblinking, shard->switching_v, *random_factory);
+		_drawSwitching(emitting_v, nb_blinking, shard->switching_v, *random_factory);
+
+		//switching_v : the unblinking particles, then the blinking ones
+		for(int switching_idx = 0; switching_idx < nb_unblinking + nb_blinking; switching_idx++)
+		{
+			int ptcl_idx = shard->switching_v[switching_idx];
+			bool isBlinking = (switching_idx >= nb_unblinking);
+
+			m_blinked_v[ptcl_idx >> 6] ^= uint64_t(1) << (ptcl_idx & 63);
+			m_fluorophores_v[ptcl_idx]->setBlinked(isBlinking);
+
+			if(isBlinking) blinked_v.push_back(ptcl_idx);
+			else emitting_v.push_back(ptcl_idx);
+		}
+		shard->switching_v.clear();
+	}
+}
+
+void PhotophysicsSubEngine::_drawSwitching(vector<int>& pool_v, int nb_switching, vector<int>& switching_v,
+										   RandomNumberGenerator& random_factory)
+{
+	if(nb_switching == 0) return; //->
+
+	//partial Fisher-Yates : the switching particles end up at the front of the pool
+	int nb_pool = pool_v.size();
+	for(int pool_idx = 0; pool_idx < nb_switching; pool_idx++)
+	{
+		int picked_idx = pool_idx + random_factory.uniformIntRandomNumber(nb_pool - pool_idx);
+		swap(pool_v[pool_idx], pool_v[picked_idx]);
+	}
+	switching_v.insert(switching_v.end(), pool_v.begin(), pool_v.begin() + nb_switching);
+
+	//the front is then filled by the tail of the pool
+	int nb_kept = nb_pool - nb_switching;
+	int nb_moved = std::min(nb_switching, nb_kept);
+	copy(pool_v.end() - nb_moved, pool_v.end(), pool_v.begin());
+	pool_v.resize(nb_kept);
+}
@@ -0,0 +1,93 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#ifndef PHOTOPHYSICSSUBENGINE_H
+#define PHOTOPHYSICSSUBENGINE_H
+
+
+#include "thread"
+#include "vector"
+#include "stdint.h"
+
+#include "cellEngine_library_global.h"
+    #include "biologicalWorld/Particle.h"
+    #include "biologicalWorld/BiologicalWorld.h"
+    #include "RandomNumberGenerator.h"
+
+#include "toolBox_src/developmentTools/myProfiler.h"
+
+
+//blinking of a fixed sample : the fluorophore states are mirrored in packed bitsets and, per fluorophore species,
+//in pools of emitting and blinked particles. At each step, the number of transitions of each pool is drawn from a
+//binomial law and the switching particles are picked at random in the pool : the cost scales with the number of
+//transitions instead of the number of particles. The particles are split into shards (one random stream each),
+//the result does not depend on the number of threads actually used.
+class CELLENGINE_LIBRARYSHARED_EXPORT PhotophysicsSubEngine
+{
+public :
+
+	PhotophysicsSubEngine(BiologicalWorld* bio_world);
+
+	//one step of every particle, nb shards = random_factories.size()
+	void updateSystem(float delta_t, std::vector<RandomNumberGenerator>& random_factories, bool isMultithreaded);
+	void invalidate(); //the states have been updated elsewhere (moving sample) : the mirror is rebuilt on next step
+
+	int getNbParticles() const;
+	bool isBleached(int ptcl_idx) const;
+	bool isBlinked(int ptcl_idx) const;
+
+private :
+
+	struct myPhotophysicsShard
+	{
+		int ptcl_idx_beg;
+		int ptcl_idx_end;
+		bool isToBe_built;
+
+		std::vector<std::vector<int> > emitting_vv; //per fluorophore species, particles neither blinked nor bleached
+		std::vector<std::vector<int> > blinked_vv;
+		std::vector<int> switching_v; //kept from one step to the other : no heap allocation once grown
+	};
+
+	void _synchronize(int nb_shards);
+	void _buildShard(myPhotophysicsShard& shard);
+	void _updateShard(float delta_t, myPhotophysicsShard* shard, RandomNumberGenerator* random_factory);
+	static void _drawSwitching(std::vector<int>& pool_v, int nb_switching, std::vector<int>& switching_v,
+							   RandomNumberGenerator& random_factory);
+
+private :
+
+	BiologicalWorld* m_bio_world;
+	bool m_isSynchronized;
+	unsigned int m_fluoStates_revision;
+
+	std::vector<Fluorophore*> m_fluorophores_v; //particles order
+	std::vector<unsigned char> m_fluoSpecieIdx_v;
+	std::vector<const FluorophoreSpecies*> m_fluoSpecies_v;
+	std::vector<uint64_t> m_bleached_v; //bit i : particle i
+	std::vector<uint64_t> m_blinked_v;
+
+	std::vector<myPhotophysicsShard> m_shards_v;
+	std::vector<std::thread> m_threads_v;
+};
+
+
+
+#endif // PHOTOPHYSICSSUBENGINE_H
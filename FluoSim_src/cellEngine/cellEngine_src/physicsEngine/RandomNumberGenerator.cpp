@@ -23,13 +23,35 @@
 
 #include "RandomNumberGenerator.h"
 
+#include "iostream"
+#include "locale"
+#include "sstream"
+
 RandomNumberGenerator::RandomNumberGenerator() :
 
 	m_poissonGenerator(1.0),
 	m_gaussianGenerator(0.0,1.0),
 	m_uniformGenerator(0.0,1.0)
 {
+	m_next_idx = 0;
+}
+
+RandomNumberGenerator::RandomNumberGenerator(unsigned int seed) :
 
+	m_defaultGenerator(seed),
+	m_poissonGenerator(1.0),
+	m_gaussianGenerator(0.0,1.0),
+	m_uniformGenerator(0.0,1.0)
+{
+	m_next_idx = 0;
+}
+
+void RandomNumberGenerator::setSeed(unsigned int seed)
+{
+	m_defaultGenerator.seed(seed);
+	m_poissonGenerator.reset();
+	m_gaussianGenerator.reset();
+	m_uniformGenerator.reset();
 }
 
 void RandomNumberGenerator::setPoissonMean(float mean)
@@ -105,3 +127,48 @@ float RandomNumberGenerator::uniformRandomNumber()
 {
 	return m_uniformGenerator(m_defaultGenerator);
 }
+
+int RandomNumberGenerator::uniformIntRandomNumber(int n)
+{
+	if(n <= 1) return 0; //->
+	return std::uniform_int_distribution<int>(0, n-1)(m_defaultGenerator);
+}
+
+int RandomNumberGenerator::binomialRandomNumber(int n, float p)
+{
+	if(n <= 0 || p <= 0.0f) return 0; //->
+	if(p >= 1.0f) return n; //->
+
+	//built per call : nothing to restore at checkpoints, the draws only depend on the engine state
+	return std::binomial_distribution<int>(n, p)(m_defaultGenerator);
+}
+
+void RandomNumberGenerator::saveState(myBinaryWriter& writer) const
+{
+	//the standard textual representation is the only portable access to the engine and distribution states
+	std::ostringstream state_stream;
+	state_stream.imbue(std::locale::classic());
+	state_stream<<m_defaultGenerator<<" "<<m_poissonGenerator<<" "<<m_gaussianGenerator<<" "<<m_uniformGenerator;
+
+	writer.writeString(state_stream.str());
+	writer.write<int>(m_next_idx);
+	writer.writeVector(m_gaussianRandomNumbers_v);
+}
+
+bool RandomNumberGenerator::loadState(myBinaryReader& reader)
+{
+	std::string state_str;
+	if(reader.readString(state_str) == false) return false; //->
+
+	std::istringstream state_stream(state_str);
+	state_stream.imbue(std::locale::classic());
+	state_stream>>m_defaultGenerator>>m_poissonGenerator>>m_gaussianGenerator>>m_uniformGenerator;
+	if(state_stream.fail())
+	{
+		std::cout<<"In RandomNumberGenerator::loadState : error (corrupted generator state)\n";
+		return false; //->
+	}
+
+	reader.read<int>(m_next_idx);
+	return reader.readVector(m_gaussianRandomNumbers_v);
+}
@@ -24,11 +24,16 @@
 
 #include "cellEngine_library_global.h"
 
+#include "toolBox_src/fileAndstring_manipulation/myBinaryFile.h"
+
 class CELLENGINE_LIBRARYSHARED_EXPORT RandomNumberGenerator
 {
 public :
 
     RandomNumberGenerator();
+	RandomNumberGenerator(unsigned int seed);
+
+	void setSeed(unsigned int seed);
 
 	//poisson
 	void setPoissonMean(float mean);
@@ -46,7 +51,14 @@ public :
 	float getUniformUpperBound();
 	float getUniformLowerBound();
 	float uniformRandomNumber();
+	int uniformIntRandomNumber(int n); //in [0, n[
+
+	//binomial : number of successes among n trials of probability p (clamped to [0,1])
+	int binomialRandomNumber(int n, float p);
 
+	//checkpoint : engine and distributions are restored exactly, the next draws are the same
+	void saveState(myBinaryWriter& writer) const;
+	bool loadState(myBinaryReader& reader);
 
 
 private :
@@ -0,0 +1,96 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#include "AllocationCounter.h"
+
+#include "atomic"
+#include "cstdlib"
+#include "new"
+
+#include "cellEngine_allocationCounter.h"
+
+
+static std::atomic<long long> nb_allocations(0);
+
+long long getNbAllocations()
+{
+	//where the replacement below serves the library, its own counter stays at 0
+	return nb_allocations.load(std::memory_order_relaxed) + getNbLibraryAllocations();
+}
+
+bool areAllocationsCounted()
+{
+#ifdef _WIN32
+	return areLibraryAllocationsCounted();
+#else
+	return true;
+#endif
+}
+
+static void* countedAllocation(std::size_t size)
+{
+	nb_allocations.fetch_add(1, std::memory_order_relaxed);
+
+	void* ptr = std::malloc(size == 0 ? 1 : size);
+	if(ptr == 0) throw std::bad_alloc();
+	return ptr;
+}
+
+void* operator new(std::size_t size)
+{
+	return countedAllocation(size);
+}
+
+void* operator new[](std::size_t size)
+{
+	return countedAllocation(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	nb_allocations.fetch_add(1, std::memory_order_relaxed);
+	return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	nb_allocations.fetch_add(1, std::memory_order_relaxed);
+	return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+	std::free(ptr);
+}
@@ -0,0 +1,33 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+
+//the global operator new of the benchmark is replaced to count the heap allocations,
+//the shared libraries go through it on the platforms resolving operator new globally (linux, macOS)
+//whereas a windows dll keeps the operator new of its own runtime : the cellEngine then counts its own ones.
+
+long long getNbAllocations(); //benchmark and cellEngine
+bool areAllocationsCounted(); //false if the cellEngine dll was not built with CONFIG+=countAllocations
+
+
+#endif // ALLOCATIONCOUNTER_H
@@ -0,0 +1,271 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#include "BenchmarkRunner.h"
+#include "AllocationCounter.h"
+
+#include "algorithm"
+#include "cstdio"
+#include "fstream"
+#include "iostream"
+
+#include "biologicalWorld/FrapHead.h"
+#include "Measure/Trace.h"
+
+#include "toolBox_src/developmentTools/myClock.h"
+
+
+using namespace std;
+using namespace glm;
+
+
+BenchmarkRunner::BenchmarkRunner()
+{
+	m_nbParticles_v = {1000, 10000, 100000, 1000000};
+	m_scenes_v = {CONVEX_CELL_SCENE, SYNAPSES_SCENE, TRACED_CONTOUR_SCENE};
+	m_output_dir = ".";
+	m_isSucceeded = true;
+}
+
+void BenchmarkRunner::setParticleCounts(vector<int> nb_particles_v)
+{
+	m_nbParticles_v = nb_particles_v;
+}
+
+void BenchmarkRunner::setScenes(vector<BENCHMARK_SCENE> scenes_v)
+{
+	m_scenes_v = scenes_v;
+}
+
+void BenchmarkRunner::setSceneParams(benchmarkSceneParams scene_params)
+{
+	m_scene_params = scene_params;
+}
+
+void BenchmarkRunner::setOutputDirectory(string output_dir)
+{
+	m_output_dir = output_dir;
+}
+
+const vector<benchmarkResult>& BenchmarkRunner::getResults() const
+{
+	return m_results_v;
+}
+
+bool BenchmarkRunner::run()
+{
+	m_results_v.clear();
+	m_isSucceeded = true;
+
+	for(BENCHMARK_SCENE scene : m_scenes_v)
+	{
+		for(int nb_particles : m_nbParticles_v)
+		{
+			cout<<"scene "<<getSceneName(scene)<<", "<<nb_particles<<" particles...\n";
+			_runScene(scene, nb_particles);
+		}
+	}
+
+	return m_isSucceeded;
+}
+
+int BenchmarkRunner::_getNbSteps(int nb_particles)
+{
+	//about 10^7 particle updates per measure, bounded to keep the small and large systems meaningful
+	return std::max(3, std::min(200, 10000000/std::max(1, nb_particles)));
+}
+
+void BenchmarkRunner::_runScene(BENCHMARK_SCENE scene, int nb_particles)
+{
+	const float dt = m_scene_params.dt;
+	const int nb_steps = _getNbSteps(nb_particles);
+
+	BiologicalWorld bio_world;
+	bio_world.addChemicalSpecie(ChemicalSpecies("spc1", vec4(0.2,1,0.2,1)));
+	bio_world.addFluorophoreSpecie(m_scene_params.k_on_fluo, m_scene_params.k_off_fluo);
+	buildScene(bio_world, scene, m_scene_params);
+
+	myChrono clock;
+	clock.startTour();
+	bio_world.addParticles(nb_particles, 0, 0, 0);
+	_addResult(scene, nb_particles, "addParticles", 1, clock.endTour());
+
+	DiffusionSubEngine engine(&bio_world);
+
+//updateSystem
+	engine.setEngineMode(DiffusionSubEngine::SINGLETHREADED_MODE);
+	engine.updateSystem(dt); //warm-up (towers initialisation, kinetic table, reflection buffers)
+
+	//the single threaded step loop must not allocate once warmed-up : the run fails otherwise
+	long long nb_allocations = getNbAllocations();
+	clock.startTour();
+	for(int step = 0; step <= nb_steps-1; step++) engine.updateSystem(dt);
+	double step_time = clock.endTour();
+	nb_allocations = getNbAllocations() - nb_allocations;
+
+	if(areAllocationsCounted() == false)
+	{
+		cout<<"In BenchmarkRunner::_runScene : error (the cellEngine allocations are not counted, build it with CONFIG+=countAllocations)\n";
+		nb_allocations = -1;
+		m_isSucceeded = false;
+	}
+	else if(nb_allocations != 0)
+	{
+		cout<<"In BenchmarkRunner::_runScene : error ("<<nb_allocations<<" heap allocations in the step loop)\n";
+		m_isSucceeded = false;
+	}
+	_addResult(scene, nb_particles, "updateSystem_singleThreaded", nb_steps, step_time, nb_allocations);
+
+	engine.setEngineMode(DiffusionSubEngine::MULTITHREADED_MODE);
+	clock.startTour();
+	for(int step = 0; step <= nb_steps-1; step++) engine.updateSystem(dt);
+	_addResult(scene, nb_particles, "updateSystem_multiThreaded", nb_steps, clock.endTour());
+
+//probes
+	Region* measured_rgn = &(bio_world.getRegionRef(bio_world.getNbRegions()-1));
+	Region* cell_rgn = &(bio_world.getRegionRef(0));
+
+	vector<pair<Probe::measureType, string> > measureTypes_v =
+	{
+		{Probe::INTENSITY, "measure_INTENSITY"},
+		{Probe::AVERAGE_INTENSITY, "measure_AVERAGE_INTENSITY"},
+		{Probe::RELATIVE_INTENSITY, "measure_RELATIVE_INTENSITY"},
+		{Probe::RELATIVE_AVERAGE_INTENSITY, "measure_RELATIVE_AVERAGE_INTENSITY"},
+		{Probe::RELATIVE_AVERAGE_INTENSITY_TWO_POP, "measure_RELATIVE_AVERAGE_INTENSITY_TWO_POP"},
+		{Probe::INTENSITY_IN_GAUSSIAN_BEAM, "measure_INTENSITY_IN_GAUSSIAN_BEAM"},
+		{Probe::AVERAGE_INTENSITY_IN_GAUSSIAN_BEAM, "measure_AVERAGE_INTENSITY_IN_GAUSSIAN_BEAM"},
+		{Probe::LOCALISATION, "measure_LOCALISATION"},
+		{Probe::TRACE_TRACKER, "measure_TRACE_TRACKER"}
+	};
+
+	vector<Trace> traces;
+	for(auto& measureType_pair : measureTypes_v)
+	{
+		Probe probe(&bio_world);
+		probe.setRegion1(measured_rgn);
+		probe.setRegion2(cell_rgn);
+		probe.setChemicalSpecie1(bio_world.getSpecieAdr(0));
+		probe.setChemicalSpecie2(bio_world.getSpecieAdr(0));
+		probe.setMeasureType(measureType_pair.first);
+
+		myGaussianBeamParams beam_params;
+			beam_params.center = measured_rgn->getBarycenter();
+			beam_params.maxIntensity = 1.0;
+			beam_params.sigma = 0.3/m_scene_params.pixel_size;
+			beam_params.noise_cutOff = 0.0f;
+			beam_params.koff = -1.0f; //no bleaching : the measure is not altered between the repetitions
+		probe.setGaussianBeamParam(beam_params);
+		probe.setRandomFactories(&(engine.getRandomFactoriesRef()));
+
+		//the trajectories need the particles to move between the planes
+		bool isMoving = (measureType_pair.first == Probe::TRACE_TRACKER);
+
+		double total_time = 0.0;
+		for(int plane = 0; plane <= nb_steps-1; plane++)
+		{
+			clock.startTour();
+			probe.measure(plane, plane*dt, dt);
+			total_time += clock.endTour();
+
+			if(isMoving) engine.updateSystem(dt);
+		}
+		_addResult(scene, nb_particles, measureType_pair.second, nb_steps, total_time);
+
+		if(isMoving) traces = probe.getAllTraces();
+	}
+
+//frap
+	FrapHead frap_head(measured_rgn, bio_world.getFluoSpecieAdr(0), &bio_world);
+
+	clock.startTour();
+	for(int step = 0; step <= nb_steps-1; step++) frap_head.bleachRegion(1.0, dt);
+	_addResult(scene, nb_particles, "bleachRegion", nb_steps, clock.endTour());
+
+	//one head per region : sequential heads vs fused pass
+	vector<FrapHead> frapHeads_v;
+	for(int rgn_idx = 0; rgn_idx <= bio_world.getNbRegions()-1; rgn_idx++)
+	{
+		frapHeads_v.push_back(FrapHead(&(bio_world.getRegionRef(rgn_idx)), bio_world.getFluoSpecieAdr(0), &bio_world));
+	}
+
+	clock.startTour();
+	for(int step = 0; step <= nb_steps-1; step++)
+	{
+		for(FrapHead& frapHead : frapHeads_v) frapHead.bleachRegion(0.01, dt);
+	}
+	_addResult(scene, nb_particles, "bleachRegion_allRegions", nb_steps, clock.endTour());
+
+	clock.startTour();
+	for(int step = 0; step <= nb_steps-1; step++)
+	{
+		FrapHead::bleachRegions(frapHeads_v, 0.01, dt, engine.getRandomFactoriesRef());
+	}
+	_addResult(scene, nb_particles, "bleachRegions_fused_allRegions", nb_steps, clock.endTour());
+
+//traces export and analysis
+	string traces_path = m_output_dir + "/benchmark_traces.trc";
+
+	clock.startTour();
+	saveTracesAsString(traces, traces_path, PALMTRACER_FORMAT, dt);
+	_addResult(scene, nb_particles, "saveTracesAsString", 1, clock.endTour());
+	remove(traces_path.data());
+
+	clock.startTour();
+	computeMSDs(traces, 10);
+	computeDs(traces, m_scene_params.pixel_size, dt, 1, 4);
+	_addResult(scene, nb_particles, "MSD_fitting", 1, clock.endTour());
+}
+
+void BenchmarkRunner::_addResult(BENCHMARK_SCENE scene, int nb_particles, string operation, int nb_calls, double total_time,
+								 long long nb_allocations)
+{
+	benchmarkResult result = {getSceneName(scene), nb_particles, operation, nb_calls, total_time, nb_allocations};
+	m_results_v.push_back(result);
+
+	cout<<"\t"<<operation<<" : "<<total_time/nb_calls*1e3<<" ms/call ("<<nb_calls/total_time<<" calls/s)";
+	if(nb_allocations >= 0) cout<<", "<<nb_allocations<<" allocations";
+	cout<<"\n";
+}
+
+bool BenchmarkRunner::saveResults(string file_path)
+{
+	ofstream file(file_path.data());
+	if(!file.is_open())
+	{
+		cout<<"In BenchmarkRunner::saveResults : error (cannot open "<<file_path<<")\n";
+		return false; //->
+	}
+
+	//tab separated values, one line per (scene, particle count, operation)
+	file<<"scene\tnb_particles\toperation\tnb_calls\ttotal_time_s\ttime_per_call_s\tcalls_per_s\tnb_allocations\n";
+	for(benchmarkResult& result : m_results_v)
+	{
+		file<<result.scene<<"\t"
+			<<result.nb_particles<<"\t"
+			<<result.operation<<"\t"
+			<<result.nb_calls<<"\t"
+			<<result.total_time<<"\t"
+			<<result.total_time/result.nb_calls<<"\t"
+			<<result.nb_calls/result.total_time<<"\t"
+			<<result.nb_allocations<<"\n";
+	}
+
+	return true;
+}
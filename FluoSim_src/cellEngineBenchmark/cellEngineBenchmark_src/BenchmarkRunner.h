@@ -0,0 +1,79 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#ifndef BENCHMARKRUNNER_H
+#define BENCHMARKRUNNER_H
+
+#include "string"
+#include "vector"
+
+#include "BenchmarkScenes.h"
+
+#include "cellEngine_library_global.h"
+    #include "biologicalWorld/BiologicalWorld.h"
+    #include "biologicalWorld/Probe.h"
+    #include "physicsEngine/DiffusionSubEngine.h"
+
+
+struct benchmarkResult
+{
+	std::string scene;
+	int nb_particles;
+	std::string operation;
+	int nb_calls;
+	double total_time; //s
+	long long nb_allocations; //-1 : not counted
+};
+
+class BenchmarkRunner
+{
+public :
+
+	BenchmarkRunner();
+
+	void setParticleCounts(std::vector<int> nb_particles_v);
+	void setScenes(std::vector<BENCHMARK_SCENE> scenes_v);
+	void setSceneParams(benchmarkSceneParams scene_params);
+	void setOutputDirectory(std::string output_dir);
+
+	bool run(); //false if the single threaded step loop allocated (or if it could not be checked)
+	bool saveResults(std::string file_path);
+	const std::vector<benchmarkResult>& getResults() const;
+
+private :
+
+	void _runScene(BENCHMARK_SCENE scene, int nb_particles);
+	void _addResult(BENCHMARK_SCENE scene, int nb_particles, std::string operation, int nb_calls, double total_time,
+					long long nb_allocations = -1);
+	int _getNbSteps(int nb_particles);
+
+private :
+
+	std::vector<int> m_nbParticles_v;
+	std::vector<BENCHMARK_SCENE> m_scenes_v;
+	benchmarkSceneParams m_scene_params;
+	std::string m_output_dir;
+
+	std::vector<benchmarkResult> m_results_v;
+	bool m_isSucceeded;
+};
+
+
+#endif // BENCHMARKRUNNER_H
@@ -0,0 +1,143 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#include "BenchmarkScenes.h"
+
+#include "cmath"
+
+
+using namespace std;
+using namespace glm;
+
+
+string getSceneName(BENCHMARK_SCENE scene)
+{
+	switch(scene)
+	{
+		case CONVEX_CELL_SCENE : return "convexCell";
+		case SYNAPSES_SCENE : return "synapses";
+		case TRACED_CONTOUR_SCENE : return "tracedContour";
+		case FRAP_SCENE : return "frap";
+	}
+
+	return "unknown";
+}
+
+vector<vec2> getCirclePoints(vec2 center, float radius, int nb_points)
+{
+	vector<vec2> points_v;
+	points_v.reserve(nb_points);
+
+	for(int pt_idx = 0; pt_idx <= nb_points-1; pt_idx++)
+	{
+		float theta = 2.0*M_PI*pt_idx/nb_points;
+		points_v.push_back(center + radius*vec2(cos(theta), sin(theta)));
+	}
+
+	return points_v;
+}
+
+vector<vec2> getTracedContourPoints(vec2 center, float radius, int nb_points)
+{
+	//star-shaped contour with several harmonics, mimicking a hand-traced neuron outline
+	vector<vec2> points_v;
+	points_v.reserve(nb_points);
+
+	for(int pt_idx = 0; pt_idx <= nb_points-1; pt_idx++)
+	{
+		float theta = 2.0*M_PI*pt_idx/nb_points;
+		float r = radius*(1.0 + 0.25*sin(5*theta) + 0.08*sin(23*theta) + 0.02*sin(97*theta));
+		points_v.push_back(center + r*vec2(cos(theta), sin(theta)));
+	}
+
+	return points_v;
+}
+
+void buildScene(BiologicalWorld& bio_world, BENCHMARK_SCENE scene, const benchmarkSceneParams& params)
+{
+	vec2 center = vec2(2.0*params.cell_radius);
+	float inv_pxSquared = 1.0/(params.pixel_size*params.pixel_size);
+
+//geometry
+	switch(scene)
+	{
+		case CONVEX_CELL_SCENE :
+		{
+			bio_world.addRegion(getCirclePoints(center, params.cell_radius, 64));
+		}
+		break;
+
+		case SYNAPSES_SCENE :
+		{
+			bio_world.addRegion(getCirclePoints(center, params.cell_radius, 64));
+
+			//synapses are placed on a square grid inside the cell
+			int nb_perLine = std::ceil(std::sqrt(float(params.nb_synapses)));
+			float spacing = 1.2*params.cell_radius/nb_perLine;
+			vec2 corner = center - 0.5f*spacing*(nb_perLine-1);
+
+			for(int syn_idx = 0; syn_idx <= params.nb_synapses-1; syn_idx++)
+			{
+				vec2 syn_center = corner + spacing*vec2(syn_idx%nb_perLine, syn_idx/nb_perLine);
+				bio_world.addRegion(getCirclePoints(syn_center, params.synapse_radius, 16));
+			}
+		}
+		break;
+
+		case TRACED_CONTOUR_SCENE :
+		{
+			bio_world.addRegion(getTracedContourPoints(center, params.cell_radius, params.nb_contourVertices));
+		}
+		break;
+
+		case FRAP_SCENE :
+		{
+			bio_world.addRegion(getCirclePoints(center, params.cell_radius, 64));
+			bio_world.addRegion(getCirclePoints(center, params.frap_radius, 32));
+		}
+		break;
+	}
+
+	int nb_rgns = bio_world.getNbRegions();
+	for(int rgn_idx = 0; rgn_idx <= nb_rgns-1; rgn_idx++)
+	{
+		Region& rgn = bio_world.getRegionRef(rgn_idx);
+		rgn.setName("Region" + to_string(rgn_idx));
+		rgn.computeSurface();
+		if(rgn_idx > 0) rgn.setIsACompartment(bio_world.getSpecieAdr(0), false);
+	}
+
+//dynamics (same settings as FluoSimModel::updateDynamicParams)
+	bio_world.setFixation(false);
+	bio_world.setD(0, 0, params.D_outside*inv_pxSquared);
+	bio_world.setCrossing(0, 0, 0, 1.0);
+
+	for(int rgn_idx = 1; rgn_idx <= nb_rgns-1; rgn_idx++)
+	{
+		bio_world.setD(rgn_idx, 0, params.D_inside*inv_pxSquared);
+		bio_world.setTrappingAbundant(rgn_idx, 0, params.D_trapped*inv_pxSquared,
+									  params.k_on_trapping, params.k_off_trapping);
+		bio_world.setCrossing(rgn_idx, 0, 1, 1);
+	}
+
+//photophysics
+	bio_world.getFluoSpecieAdr(0)->setKon(params.k_on_fluo);
+	bio_world.getFluoSpecieAdr(0)->setKoff(params.k_off_fluo);
+}
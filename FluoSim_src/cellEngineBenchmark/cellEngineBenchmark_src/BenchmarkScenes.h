@@ -0,0 +1,66 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#ifndef BENCHMARKSCENES_H
+#define BENCHMARKSCENES_H
+
+#include "string"
+#include "vector"
+
+#include "glm.hpp"
+
+#include "cellEngine_library_global.h"
+    #include "biologicalWorld/BiologicalWorld.h"
+
+
+//FRAP_SCENE : cell with a bleachable disk at its center (region 1), used to validate the integrators
+enum BENCHMARK_SCENE {CONVEX_CELL_SCENE, SYNAPSES_SCENE, TRACED_CONTOUR_SCENE, FRAP_SCENE};
+
+//canonical parameters (spatial units in px, times in s)
+struct benchmarkSceneParams
+{
+	float dt = 0.02;
+	float pixel_size = 0.16; //µm
+	float cell_radius = 150.0; //px
+
+	float D_outside = 0.1; //µm²/s
+	float D_inside = 0.05; //µm²/s
+	float D_trapped = 0.001; //µm²/s
+	float k_on_trapping = 10.0;
+	float k_off_trapping = 0.1;
+
+	float k_on_fluo = 10.0;
+	float k_off_fluo = 1.0;
+
+	int nb_synapses = 50;
+	float synapse_radius = 4.0; //px
+	int nb_contourVertices = 5000;
+	float frap_radius = 30.0; //px
+};
+
+std::string getSceneName(BENCHMARK_SCENE scene);
+std::vector<glm::vec2> getCirclePoints(glm::vec2 center, float radius, int nb_points);
+std::vector<glm::vec2> getTracedContourPoints(glm::vec2 center, float radius, int nb_points);
+
+//fills an empty biological world (one species, one fluorophore species) with the scene geometry and dynamics
+void buildScene(BiologicalWorld& bio_world, BENCHMARK_SCENE scene, const benchmarkSceneParams& params);
+
+
+#endif // BENCHMARKSCENES_H
@@ -0,0 +1,162 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#include "IntegratorValidation.h"
+#include "BenchmarkScenes.h"
+
+#include "algorithm"
+#include "cmath"
+#include "cstdlib"
+#include "fstream"
+#include "iostream"
+
+#include "cellEngine_library_global.h"
+    #include "biologicalWorld/BiologicalWorld.h"
+    #include "biologicalWorld/FrapHead.h"
+    #include "biologicalWorld/Probe.h"
+    #include "physicsEngine/DiffusionSubEngine.h"
+
+
+using namespace std;
+using namespace glm;
+
+
+integratorValidationCurves runIntegrator(const integratorValidationParams& params, bool isFastForward)
+{
+	//free diffusion, no trapping and no blinking : nothing prevents the particles far from the edges to be fast-forwarded
+	benchmarkSceneParams scene_params;
+		scene_params.D_outside = params.D;
+		scene_params.D_inside = params.D;
+		scene_params.k_on_trapping = 0.0;
+		scene_params.k_on_fluo = 0.0;
+		scene_params.k_off_fluo = 0.0;
+	const float dt = scene_params.dt;
+	const float pxSquared = scene_params.pixel_size*scene_params.pixel_size;
+
+	BiologicalWorld bio_world;
+	bio_world.addChemicalSpecie(ChemicalSpecies("spc1", vec4(0.2,1,0.2,1)));
+	bio_world.addFluorophoreSpecie(0, 0);
+	buildScene(bio_world, FRAP_SCENE, scene_params);
+
+	//the same particles for both integrators
+	srand(params.seed);
+	bio_world.setRandomSeed(params.seed);
+	bio_world.addParticles(params.nb_particles, 0, 0, 0);
+
+	DiffusionSubEngine engine(&bio_world);
+	engine.setEngineMode(DiffusionSubEngine::MULTITHREADED_MODE);
+	engine.setRandomSeed(params.seed + (isFastForward ? 1 : 0));
+
+	Region* frap_rgn = &(bio_world.getRegionRef(1));
+	Probe probe(&bio_world);
+	probe.setRegion1(frap_rgn);
+	probe.setChemicalSpecie1(bio_world.getSpecieAdr(0));
+	probe.setMeasureType(Probe::INTENSITY);
+
+	float prebleach_intensity = std::max(1.0f, probe.measure(0, 0.0f, dt));
+	FrapHead frap_head(frap_rgn, bio_world.getFluoSpecieAdr(0), &bio_world);
+	frap_head.bleachRegion();
+
+	vector<vec2> startPositions_v = bio_world.getParticlePositions();
+
+	integratorValidationCurves curves;
+	for(int acquisition_idx = 1; acquisition_idx <= params.nb_acquisitions; acquisition_idx++)
+	{
+		if(isFastForward)
+		{
+			engine.updateSystem(dt, params.acquisition_period);
+			curves.nb_fastForwarded += engine.getNbFastForwardedParticles();
+		}
+		else
+		{
+			for(int step_idx = 0; step_idx < params.acquisition_period; step_idx++) engine.updateSystem(dt);
+		}
+
+		vector<vec2> positions_v = bio_world.getParticlePositions();
+		int nb_particles = positions_v.size();
+		double squaredDisplacements_sum = 0.0;
+		for(int ptcl_idx = 0; ptcl_idx <= nb_particles-1; ptcl_idx++)
+		{
+			vec2 d_r = positions_v[ptcl_idx] - startPositions_v[ptcl_idx];
+			squaredDisplacements_sum += dot(d_r, d_r);
+		}
+
+		int plane = acquisition_idx*params.acquisition_period;
+		curves.times_v.push_back(plane*dt);
+		curves.MSDs_v.push_back(squaredDisplacements_sum/std::max(1, nb_particles)*pxSquared);
+		curves.recoveries_v.push_back(probe.measure(plane, plane*dt, dt)/prebleach_intensity);
+	}
+
+	return curves;
+}
+
+bool validateFastForward(const integratorValidationParams& params, string file_path)
+{
+	cout<<"fast-forward validation, "<<params.nb_particles<<" particles...\n";
+
+	integratorValidationCurves reference_curves = runIntegrator(params, false);
+	integratorValidationCurves fastForward_curves = runIntegrator(params, true);
+
+	float MSD_maxDeviation = 0.0f;
+	float recovery_maxDeviation = 0.0f;
+	for(int acquisition_idx = 0; acquisition_idx < params.nb_acquisitions; acquisition_idx++)
+	{
+		float reference_MSD = reference_curves.MSDs_v[acquisition_idx];
+		float MSD_deviation = std::abs(fastForward_curves.MSDs_v[acquisition_idx] - reference_MSD)/std::max(reference_MSD, 1e-12f);
+		float recovery_deviation = std::abs(fastForward_curves.recoveries_v[acquisition_idx] - reference_curves.recoveries_v[acquisition_idx]);
+
+		MSD_maxDeviation = std::max(MSD_maxDeviation, MSD_deviation);
+		recovery_maxDeviation = std::max(recovery_maxDeviation, recovery_deviation);
+	}
+
+	double fastForwarded_fraction = double(fastForward_curves.nb_fastForwarded)/(double(params.nb_particles)*params.nb_acquisitions);
+	cout<<"\tMSD : max relative deviation "<<MSD_maxDeviation<<" (tolerance "<<params.MSD_tolerance<<")\n";
+	cout<<"\tFRAP recovery : max deviation "<<recovery_maxDeviation<<" (tolerance "<<params.recovery_tolerance<<")\n";
+	cout<<"\tfast-forwarded particles : "<<fastForwarded_fraction*100<<"% of the particle windows\n";
+
+	ofstream file(file_path.data());
+	if(file.is_open())
+	{
+		file<<"time_s\tMSD_reference_um2\tMSD_fastForward_um2\trecovery_reference\trecovery_fastForward\n";
+		for(int acquisition_idx = 0; acquisition_idx < params.nb_acquisitions; acquisition_idx++)
+		{
+			file<<reference_curves.times_v[acquisition_idx]<<"\t"
+				<<reference_curves.MSDs_v[acquisition_idx]<<"\t"
+				<<fastForward_curves.MSDs_v[acquisition_idx]<<"\t"
+				<<reference_curves.recoveries_v[acquisition_idx]<<"\t"
+				<<fastForward_curves.recoveries_v[acquisition_idx]<<"\n";
+		}
+	}
+	else cout<<"In validateFastForward : error (cannot open "<<file_path<<")\n";
+
+	bool isValidated = true;
+	if(fastForward_curves.nb_fastForwarded == 0)
+	{
+		cout<<"In validateFastForward : error (no particle was fast-forwarded, nothing was compared)\n";
+		isValidated = false;
+	}
+	if(MSD_maxDeviation > params.MSD_tolerance || recovery_maxDeviation > params.recovery_tolerance)
+	{
+		cout<<"In validateFastForward : error (the fast-forward integrator deviates from the reference one)\n";
+		isValidated = false;
+	}
+
+	return isValidated;
+}
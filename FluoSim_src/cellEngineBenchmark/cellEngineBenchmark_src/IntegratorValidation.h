@@ -0,0 +1,61 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#ifndef INTEGRATORVALIDATION_H
+#define INTEGRATORVALIDATION_H
+
+#include "string"
+#include "vector"
+
+
+//the fast-forward integrator (DiffusionSubEngine::updateSystem(dt, nb_steps)) is compared with the reference one
+//(nb_steps updates at dt) on the FRAP scene : MSD(t) of all the particles and recovery in the bleached disk.
+//Both runs start from the same particles, only their random streams differ.
+
+struct integratorValidationParams
+{
+	int nb_particles = 100000;
+	int nb_acquisitions = 50;
+	int acquisition_period = 20; //simulation steps between two acquisitions, fast-forwarded at once
+	float D = 1.0; //µm²/s
+	unsigned int seed = 1;
+
+	//the MSD relative standard error is about 1/sqrt(nb_particles) (0.3%), the recovery one
+	//about 1/sqrt(nb_particles*frap_surface/cell_surface) (0.8% for 4000 particles in the disk)
+	float MSD_tolerance = 0.03; //relative
+	float recovery_tolerance = 0.05; //absolute, on the intensity normalised by the pre-bleach one
+};
+
+struct integratorValidationCurves
+{
+	std::vector<float> times_v; //s
+	std::vector<float> MSDs_v; //µm²
+	std::vector<float> recoveries_v;
+	long long nb_fastForwarded = 0; //particles moved by a single jump, summed over the windows
+};
+
+integratorValidationCurves runIntegrator(const integratorValidationParams& params, bool isFastForward);
+
+//false if a curve deviates beyond its tolerance or if no particle was fast-forwarded,
+//both curves are saved as tab separated values
+bool validateFastForward(const integratorValidationParams& params, std::string file_path);
+
+
+#endif // INTEGRATORVALIDATION_H
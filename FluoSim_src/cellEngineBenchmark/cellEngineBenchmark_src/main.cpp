@@ -0,0 +1,87 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#include "cstdlib"
+#include "iostream"
+#include "string"
+
+#include "GL_glew/glew.h"
+
+#include "QGuiApplication"
+#include "QOffscreenSurface"
+#include "QOpenGLContext"
+
+#include "BenchmarkRunner.h"
+#include "IntegratorValidation.h"
+
+
+using namespace std;
+
+
+//usage : cellEngineBenchmark [results_file] [max_nb_particles]
+//the results are saved as tab separated values (default : cellEngineBenchmark_results.txt),
+//the fast-forward validation curves next to them (cellEngineBenchmark_fastForward.txt),
+//the exit code is 1 if the step loop allocated or if the fast-forward deviates from the reference integrator
+int main(int argc, char* argv[])
+{
+	//signals still own gpu buffers : an offscreen context is enough, no widget is created
+	QGuiApplication main_app(argc, argv);
+
+	QOffscreenSurface surface;
+	surface.create();
+
+	QOpenGLContext context;
+	if(context.create() == false || context.makeCurrent(&surface) == false)
+	{
+		cout<<"In main : error (cannot create an OpenGL context)\n";
+		return 1;
+	}
+	glewExperimental = true;
+	glewInit();
+
+	string results_path = "cellEngineBenchmark_results.txt";
+	int max_nb_particles = 1000000;
+	if(argc > 1) results_path = argv[1];
+	if(argc > 2) max_nb_particles = atoi(argv[2]);
+
+	vector<int> nb_particles_v;
+	for(int nb_particles = 1000; nb_particles <= max_nb_particles; nb_particles *= 10)
+	{
+		nb_particles_v.push_back(nb_particles);
+	}
+
+	string output_dir = ".";
+	size_t pos = results_path.find_last_of("/\\");
+	if(pos != string::npos) output_dir = results_path.substr(0, pos);
+
+	BenchmarkRunner runner;
+	runner.setParticleCounts(nb_particles_v);
+	runner.setOutputDirectory(output_dir);
+	bool isSucceeded = runner.run();
+
+	if(runner.saveResults(results_path) == false) return 1;
+	cout<<"results saved in "<<results_path<<"\n";
+
+	integratorValidationParams validation_params;
+	if(validateFastForward(validation_params, output_dir + "/cellEngineBenchmark_fastForward.txt") == false) isSucceeded = false;
+
+	context.doneCurrent();
+	return isSucceeded ? 0 : 1;
+}
@@ -58,7 +58,9 @@ LIBS += \
 
 SOURCES += \
     toolBox_src/developmentTools/myClock.cpp \
+    toolBox_src/developmentTools/myProfiler.cpp \
     toolBox_src/fileAndstring_manipulation/file_manipulation.cpp \
+    toolBox_src/fileAndstring_manipulation/myBinaryFile.cpp \
     toolBox_src/fileAndstring_manipulation/string_manipulation.cpp \
     toolBox_src/geometry/myGeomtricObject.cpp \
     toolBox_src/glGUI/glObjects/textRendering/myFont.cpp \
@@ -93,12 +95,15 @@ SOURCES += \
     toolBox_src/myQtWidgets/myDoubleSpinBoxedSlider.cpp \
     toolBox_src/myQtWidgets/mytablewidget.cpp \
     toolBox_src/myQtWidgets/myComboBox.cpp \
-    toolBox_src/otherFunctions/otherFunctions.cpp
+    toolBox_src/otherFunctions/otherFunctions.cpp \
+    toolBox_src/parallelTools/myWorkStealingPool.cpp
 
 HEADERS += \
     toolBox_src/containers/myMultiVector.h \
     toolBox_src/developmentTools/myClock.h \
+    toolBox_src/developmentTools/myProfiler.h \
     toolBox_src/fileAndstring_manipulation/file_manipulation.h \
+    toolBox_src/fileAndstring_manipulation/myBinaryFile.h \
     toolBox_src/fileAndstring_manipulation/string_manipulation.h \
     toolBox_src/geometry/myGeomtricObject.h \
     toolBox_src/glGUI/glObjects/textRendering/myFont.h \
@@ -125,7 +130,8 @@ HEADERS += \
     toolBox_src/myQtWidgets/myDoubleSpinBoxedSlider.h \
     toolBox_src/myQtWidgets/mytablewidget.h \
     toolBox_src/myQtWidgets/myComboBox.h \
-    toolBox_src/otherFunctions/otherFunctions.h
+    toolBox_src/otherFunctions/otherFunctions.h \
+    toolBox_src/parallelTools/myWorkStealingPool.h
 
 win32 {
     DESTDIR ~= s,/,\\,g
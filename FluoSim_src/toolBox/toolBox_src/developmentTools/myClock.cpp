@@ -26,7 +26,6 @@ using namespace std;
 
 myChrono::myChrono()
 {
-	QueryPerformanceFrequency(&m_frequency);
 	setNbRecordedTours(10);
 
 	startChrono(); //we start the chrono by default
@@ -40,19 +39,19 @@ void myChrono::startChrono()
 	m_totalTours_time = 0;
 	m_tourIdx = 0;
 
-	QueryPerformanceCounter(&m_chronoStart_tick);
+	m_chronoStart_tick = clock_type::now();
 	startTour(); //we start a new tour by defaul...
 }
 
 void myChrono::startTour()
 {
-	QueryPerformanceCounter(&m_tourStart_tick);
+	m_tourStart_tick = clock_type::now();
 }
 
 float myChrono::endTour()
 {
-	QueryPerformanceCounter(&m_tourEnd_tick);
-	m_lastTour_time = double((m_tourEnd_tick.QuadPart - m_tourStart_tick.QuadPart))/ m_frequency.QuadPart;
+	m_tourEnd_tick = clock_type::now();
+	m_lastTour_time = chrono::duration<double>(m_tourEnd_tick - m_tourStart_tick).count();
 
 	m_totalTours_time -= m_recoredTourTimes_v[m_tourIdx];
 	m_recoredTourTimes_v[m_tourIdx] = m_lastTour_time;
@@ -82,18 +81,12 @@ int myChrono::getNbRecordedTours()
 
 float myChrono::getCurrentTime() const
 {
-	LARGE_INTEGER current_tick;
-	QueryPerformanceCounter(&current_tick);
-
-	return double((current_tick.QuadPart - m_chronoStart_tick.QuadPart))/ m_frequency.QuadPart;
+	return chrono::duration<double>(clock_type::now() - m_chronoStart_tick).count();
 }
 
 float myChrono::getCurrentTimeInTour() const
 {
-	LARGE_INTEGER current_tick;
-	QueryPerformanceCounter(&current_tick);
-
-	return double((current_tick.QuadPart - m_tourStart_tick.QuadPart))/ m_frequency.QuadPart;
+	return chrono::duration<double>(clock_type::now() - m_tourStart_tick).count();
 }
 
 float myChrono::getTotalTimeInTours() const
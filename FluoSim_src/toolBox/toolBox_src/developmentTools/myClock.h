@@ -22,7 +22,8 @@
 #define MYCLOCK_H
 
 #include "toolbox_library_global.h"
-#include "windows.h"
+#include "chrono"
+#include "vector"
 
 
 
@@ -53,10 +54,11 @@ private :
 
 private :
 
-	LARGE_INTEGER m_frequency;
-	LARGE_INTEGER m_chronoStart_tick;
-	LARGE_INTEGER m_tourStart_tick;
-	LARGE_INTEGER m_tourEnd_tick;
+	typedef std::chrono::steady_clock clock_type;
+
+	clock_type::time_point m_chronoStart_tick;
+	clock_type::time_point m_tourStart_tick;
+	clock_type::time_point m_tourEnd_tick;
 
 	double m_lastTour_time;
 	double m_totalTours_time;
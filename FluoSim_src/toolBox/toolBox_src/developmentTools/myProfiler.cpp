@@ -0,0 +1,208 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#include "myProfiler.h"
+
+#include "algorithm"
+#include "fstream"
+#include "iostream"
+#include "map"
+
+
+using namespace std;
+
+
+std::atomic<bool> myProfiler::m_isEnabled(false);
+std::mutex myProfiler::m_threadBuffers_mutex;
+std::vector<myProfiler::ThreadBuffer*> myProfiler::m_threadBuffers_v;
+std::vector<myProfiler::ThreadBuffer*> myProfiler::m_freeThreadBuffers_v;
+myProfiler::clock_type::time_point myProfiler::m_origin_tick = myProfiler::clock_type::now();
+
+
+void myProfiler::setEnabled(bool isEnabled)
+{
+	m_isEnabled.store(isEnabled, memory_order_relaxed);
+}
+
+long long myProfiler::getTime_ns()
+{
+	return chrono::duration_cast<chrono::nanoseconds>(clock_type::now() - m_origin_tick).count();
+}
+
+myProfiler::ThreadBufferHolder::~ThreadBufferHolder()
+{
+	if(buffer == 0) return; //->
+
+	lock_guard<mutex> lock(m_threadBuffers_mutex);
+
+	buffer->openedEvents_v.clear();
+	m_freeThreadBuffers_v.push_back(buffer);
+}
+
+myProfiler::ThreadBuffer* myProfiler::_getThreadBuffer()
+{
+	//the buffers are owned by the profiler and outlive their thread,
+	//so that the zones recorded by the worker threads can still be exported,
+	//a thread reuses the buffer of an exited thread when there is one
+	thread_local ThreadBufferHolder holder;
+
+	if(holder.buffer == 0)
+	{
+		lock_guard<mutex> lock(m_threadBuffers_mutex);
+
+		if(!m_freeThreadBuffers_v.empty())
+		{
+			holder.buffer = m_freeThreadBuffers_v.back();
+			m_freeThreadBuffers_v.pop_back();
+		}
+		else
+		{
+			holder.buffer = new ThreadBuffer;
+			holder.buffer->thread_idx = m_threadBuffers_v.size();
+			holder.buffer->events_v.reserve(4096);
+			m_threadBuffers_v.push_back(holder.buffer);
+		}
+	}
+
+	return holder.buffer;
+}
+
+void myProfiler::beginZone(const char* name)
+{
+	ThreadBuffer* buffer = _getThreadBuffer();
+
+	myProfilerEvent event;
+	event.name = name;
+	event.start_ns = getTime_ns();
+	event.duration_ns = -1; //not closed yet
+	event.depth = buffer->openedEvents_v.size();
+
+	buffer->openedEvents_v.push_back(buffer->events_v.size());
+	buffer->events_v.push_back(event);
+}
+
+void myProfiler::endZone()
+{
+	ThreadBuffer* buffer = _getThreadBuffer();
+	if(buffer->openedEvents_v.empty()) return; //-> zone opened before a clear()
+
+	myProfilerEvent& event = buffer->events_v[buffer->openedEvents_v.back()];
+	event.duration_ns = getTime_ns() - event.start_ns;
+	buffer->openedEvents_v.pop_back();
+}
+
+void myProfiler::addZone(const char* name, long long start_ns, long long duration_ns)
+{
+	ThreadBuffer* buffer = _getThreadBuffer();
+
+	myProfilerEvent event;
+	event.name = name;
+	event.start_ns = start_ns;
+	event.duration_ns = duration_ns;
+	event.depth = buffer->openedEvents_v.size();
+
+	buffer->events_v.push_back(event);
+}
+
+void myProfiler::clear()
+{
+	//must not be called while zones are recorded by other threads
+	lock_guard<mutex> lock(m_threadBuffers_mutex);
+
+	for(ThreadBuffer* buffer : m_threadBuffers_v)
+	{
+		buffer->events_v.clear();
+		buffer->openedEvents_v.clear();
+	}
+}
+
+bool myProfiler::exportChromeTrace(string file_path)
+{
+	ofstream file(file_path.data());
+	if(!file.is_open())
+	{
+		cout<<"In myProfiler::exportChromeTrace : error (cannot open "<<file_path<<")\n";
+		return false; //->
+	}
+
+	lock_guard<mutex> lock(m_threadBuffers_mutex);
+
+	file<<"{\"traceEvents\":[\n";
+	bool isFirst_event = true;
+	for(ThreadBuffer* buffer : m_threadBuffers_v)
+	{
+		for(const myProfilerEvent& event : buffer->events_v)
+		{
+			if(event.duration_ns < 0) continue; //<- zone still opened
+
+			if(!isFirst_event) file<<",\n";
+			isFirst_event = false;
+
+			//chrome trace timings are expressed in microseconds
+			file<<"{\"name\":\""<<event.name<<"\",\"cat\":\"FluoSim\",\"ph\":\"X\""
+				<<",\"ts\":"<<event.start_ns/1000.0
+				<<",\"dur\":"<<event.duration_ns/1000.0
+				<<",\"pid\":0,\"tid\":"<<buffer->thread_idx
+				<<",\"args\":{\"depth\":"<<event.depth<<"}}";
+		}
+	}
+	file<<"\n],\"displayTimeUnit\":\"ms\"}\n";
+
+	return true;
+}
+
+vector<myProfilerZoneSummary> myProfiler::getZoneSummaries()
+{
+	lock_guard<mutex> lock(m_threadBuffers_mutex);
+
+	map<string, myProfilerZoneSummary> summaries_map;
+	for(ThreadBuffer* buffer : m_threadBuffers_v)
+	{
+		for(const myProfilerEvent& event : buffer->events_v)
+		{
+			if(event.duration_ns < 0) continue; //<-
+
+			auto it = summaries_map.find(event.name);
+			if(it == summaries_map.end())
+			{
+				myProfilerZoneSummary summary = {event.name, 0, 0.0, 0.0};
+				it = summaries_map.insert(make_pair(string(event.name), summary)).first;
+			}
+
+			it->second.nb_calls++;
+			it->second.total_time += event.duration_ns*1e-9;
+		}
+	}
+
+	vector<myProfilerZoneSummary> summaries_v;
+	for(auto& summary_pair : summaries_map)
+	{
+		myProfilerZoneSummary& summary = summary_pair.second;
+		summary.averaged_time = summary.total_time/summary.nb_calls;
+		summaries_v.push_back(summary);
+	}
+
+	sort(summaries_v.begin(), summaries_v.end(), [](const myProfilerZoneSummary& a, const myProfilerZoneSummary& b)
+	{
+		return a.total_time > b.total_time;
+	});
+
+	return summaries_v;
+}
@@ -0,0 +1,132 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#ifndef MYPROFILER_H
+#define MYPROFILER_H
+
+#include "atomic"
+#include "chrono"
+#include "mutex"
+#include "string"
+#include "vector"
+
+#include "toolbox_library_global.h"
+
+
+// hierarchical scoped profiler :
+//	- zones are opened/closed with myProfilerZone (or the PROFILE_ZONE macro),
+//	- each thread records in its own buffer (no locking while recording),
+//	- when disabled, opening a zone costs a single relaxed atomic load,
+//	- the recorded zones can be exported as a chrome trace (chrome://tracing, perfetto).
+
+struct myProfilerEvent
+{
+	const char* name; //must point to a static string (string literal)
+	long long start_ns;
+	long long duration_ns;
+	int depth;
+};
+
+struct myProfilerZoneSummary
+{
+	std::string name;
+	long long nb_calls;
+	double total_time; //s
+	double averaged_time; //s
+};
+
+class TOOLBOXSHARED_EXPORT myProfiler
+{
+public :
+
+	typedef std::chrono::steady_clock clock_type;
+
+	static void setEnabled(bool isEnabled);
+	static bool isEnabled() {return m_isEnabled.load(std::memory_order_relaxed);}
+
+	static void beginZone(const char* name);
+	static void endZone();
+	static void addZone(const char* name, long long start_ns, long long duration_ns); //already measured (e.g. aggregated) zone
+
+	static void clear();
+	static bool exportChromeTrace(std::string file_path);
+	static std::vector<myProfilerZoneSummary> getZoneSummaries();
+
+	static long long getTime_ns();
+
+private :
+
+	struct ThreadBuffer
+	{
+		int thread_idx;
+		std::vector<myProfilerEvent> events_v;
+		std::vector<int> openedEvents_v; //stack of indices in events_v
+	};
+
+	//returns the buffer of an exited thread to the pool when the thread ends,
+	//so that the short-lived worker threads reuse the same buffers (and tids)
+	struct ThreadBufferHolder
+	{
+		ThreadBuffer* buffer = 0;
+		~ThreadBufferHolder();
+	};
+
+	static ThreadBuffer* _getThreadBuffer();
+
+private :
+
+	static std::atomic<bool> m_isEnabled;
+	static std::mutex m_threadBuffers_mutex;
+	static std::vector<ThreadBuffer*> m_threadBuffers_v;
+	static std::vector<ThreadBuffer*> m_freeThreadBuffers_v; //buffers of the exited threads
+	static clock_type::time_point m_origin_tick;
+};
+
+
+class TOOLBOXSHARED_EXPORT myProfilerZone
+{
+public :
+
+	explicit myProfilerZone(const char* name)
+	{
+		m_isOpened = myProfiler::isEnabled();
+		if(m_isOpened) myProfiler::beginZone(name);
+	}
+
+	~myProfilerZone()
+	{
+		if(m_isOpened) myProfiler::endZone();
+	}
+
+	myProfilerZone(const myProfilerZone&) = delete;
+	myProfilerZone& operator=(const myProfilerZone&) = delete;
+
+private :
+
+	bool m_isOpened;
+};
+
+
+#define PROFILE_ZONE_CONCAT2(a, b) a##b
+#define PROFILE_ZONE_CONCAT(a, b) PROFILE_ZONE_CONCAT2(a, b)
+#define PROFILE_ZONE(name) myProfilerZone PROFILE_ZONE_CONCAT(profiler_zone_, __LINE__)(name)
+
+
+#endif // MYPROFILER_H
@@ -0,0 +1,104 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#include "myBinaryFile.h"
+
+using namespace std;
+
+
+myBinaryWriter::myBinaryWriter()
+{
+}
+
+bool myBinaryWriter::open(string file_path)
+{
+	if(m_file.is_open()) m_file.close();
+	m_file.open(file_path, ios::out | ios::binary | ios::trunc);
+
+	return m_file.is_open();
+}
+
+void myBinaryWriter::close()
+{
+	m_file.close();
+}
+
+bool myBinaryWriter::isGood() const
+{
+	return m_file.is_open() && m_file.good();
+}
+
+void myBinaryWriter::writeString(const string& str)
+{
+	write<unsigned long long>(str.size());
+	m_file.write(str.data(), str.size());
+}
+
+
+
+myBinaryReader::myBinaryReader()
+{
+	m_file_size = 0;
+}
+
+bool myBinaryReader::open(string file_path)
+{
+	if(m_file.is_open()) m_file.close();
+	m_file.open(file_path, ios::in | ios::binary | ios::ate);
+	if(m_file.is_open() == false) return false; //->
+
+	m_file_size = m_file.tellg();
+	m_file.seekg(0, ios::beg);
+
+	return true;
+}
+
+void myBinaryReader::close()
+{
+	m_file.close();
+}
+
+bool myBinaryReader::isGood() const
+{
+	return m_file.is_open() && m_file.good();
+}
+
+bool myBinaryReader::readString(string& str)
+{
+	unsigned long long size = 0;
+	if(read(size) == false || size > _getRemainingSize())
+	{
+		m_file.setstate(ios::failbit);
+		str.clear();
+		return false; //->
+	}
+
+	str.resize(size);
+	if(size != 0) m_file.read(&str[0], size);
+	return isGood();
+}
+
+unsigned long long myBinaryReader::_getRemainingSize()
+{
+	if(isGood() == false) return 0; //->
+
+	unsigned long long pos = m_file.tellg();
+	return (pos <= m_file_size ? m_file_size - pos : 0);
+}
@@ -0,0 +1,109 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#ifndef MYBINARYFILE_H
+#define MYBINARYFILE_H
+
+#include "fstream"
+#include "string"
+#include "vector"
+
+#include "toolbox_library_global.h"
+
+
+//raw binary files (native endianness), meant for state snapshots read back by the same build :
+//	- plain values and vectors of plain values are written as they lie in memory,
+//	- vectors and strings are preceded by their size,
+//	- a reader turns bad (isGood() == false) at the first short read and then only returns zeros.
+
+class TOOLBOXSHARED_EXPORT myBinaryWriter
+{
+public :
+
+	myBinaryWriter();
+	bool open(std::string file_path);
+	void close();
+	bool isGood() const;
+
+	template<typename T> void write(const T& value)
+	{
+		m_file.write((const char*) &value, sizeof(T));
+	}
+
+	template<typename T> void writeVector(const std::vector<T>& values_v)
+	{
+		write<unsigned long long>(values_v.size());
+		if(values_v.empty() == false) m_file.write((const char*) values_v.data(), values_v.size()*sizeof(T));
+	}
+
+	void writeString(const std::string& str);
+
+private :
+
+	std::ofstream m_file;
+};
+
+
+class TOOLBOXSHARED_EXPORT myBinaryReader
+{
+public :
+
+	myBinaryReader();
+	bool open(std::string file_path);
+	void close();
+	bool isGood() const;
+
+	template<typename T> bool read(T& value)
+	{
+		if(m_file.read((char*) &value, sizeof(T))) return true; //->
+
+		value = T();
+		return false;
+	}
+
+	template<typename T> bool readVector(std::vector<T>& values_v)
+	{
+		unsigned long long size = 0;
+		if(read(size) == false || size > _getRemainingSize()/sizeof(T))
+		{
+			m_file.setstate(std::ios::failbit);
+			values_v.clear();
+			return false; //->
+		}
+
+		values_v.resize(size);
+		if(size != 0) m_file.read((char*) values_v.data(), size*sizeof(T));
+		return isGood();
+	}
+
+	bool readString(std::string& str);
+
+private :
+
+	unsigned long long _getRemainingSize();
+
+private :
+
+	std::ifstream m_file;
+	unsigned long long m_file_size;
+};
+
+
+#endif // MYBINARYFILE_H
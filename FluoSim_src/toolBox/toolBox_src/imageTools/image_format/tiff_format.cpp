@@ -167,6 +167,13 @@ void myTiff::setSamplesPerPixel(uint16 samplesPerPixel)
 	m_tiff_params.samplesPerPixel = samplesPerPixel;
 }
 
+void myTiff::setSampleFormat(uint16 sampleFormat)
+{
+	if(m_opening_mode == READ_MODE) return; //->
+
+	m_tiff_params.sampleFormat = sampleFormat;
+}
+
 glm::vec2 myTiff::getTiffSize()
 {
 	return {m_tiff_params.width, m_tiff_params.height};
@@ -205,6 +212,7 @@ void myTiff::addPage(uint8* data_inBytes)
 	TIFFSetField(m_tiff_hdl, TIFFTAG_IMAGELENGTH, m_tiff_params.height);
 	TIFFSetField(m_tiff_hdl, TIFFTAG_SAMPLESPERPIXEL, m_tiff_params.samplesPerPixel);
 	TIFFSetField(m_tiff_hdl, TIFFTAG_BITSPERSAMPLE, m_tiff_params.bitsPerSample);
+	TIFFSetField(m_tiff_hdl, TIFFTAG_SAMPLEFORMAT, m_tiff_params.sampleFormat);
 	TIFFSetField(m_tiff_hdl, TIFFTAG_ORIENTATION, ORIENTATION_BOTLEFT);
 	TIFFSetField(m_tiff_hdl, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
 	TIFFSetField(m_tiff_hdl, TIFFTAG_ROWSPERSTRIP, 1);
@@ -43,6 +43,7 @@ struct myTIFFParameters
 	uint16 tileWidth = 0;
 	uint16 tileHeight = 0;
 	uint16 orientation = -1;
+	uint16 sampleFormat = SAMPLEFORMAT_UINT; //SAMPLEFORMAT_IEEEFP for float images
 
 };
 
@@ -64,6 +65,7 @@ public :
 	void setBitsPerSample(uint16 bitsPerSample);
 	void setBytesPerSample(uint16 bytesPerSample);
 	void setSamplesPerPixel(uint16 samplesPerPixel);
+	void setSampleFormat(uint16 sampleFormat);
 
 	glm::vec2 getTiffSize();
 	uint16 getBitsPerSample();
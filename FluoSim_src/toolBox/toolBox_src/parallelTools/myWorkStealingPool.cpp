@@ -0,0 +1,137 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#include "myWorkStealingPool.h"
+
+#include "algorithm"
+#include "thread"
+
+using namespace std;
+
+
+myWorkStealingPool::myWorkStealingPool(int nb_workers)
+{
+	if(nb_workers <= 0) nb_workers = thread::hardware_concurrency();
+	if(nb_workers <= 0) nb_workers = 1;
+
+	m_nbWorkers = nb_workers;
+	for(int worker_idx = 0; worker_idx <= m_nbWorkers-1; worker_idx++)
+	{
+		m_queues_v.push_back(unique_ptr<WorkerQueue>(new WorkerQueue()));
+	}
+}
+
+int myWorkStealingPool::getNbWorkers() const
+{
+	return m_nbWorkers;
+}
+
+void myWorkStealingPool::run(int nb_tasks, const function<void(int, int)>& task)
+{
+	if(nb_tasks <= 0) return; //->
+
+	for(auto& queue : m_queues_v) queue->tasks.clear();
+
+	//contiguous blocks : the beginning of each block is run first by its owner
+	int nb_workers = std::min(m_nbWorkers, nb_tasks);
+	for(int worker_idx = 0; worker_idx <= nb_workers-1; worker_idx++)
+	{
+		int task_beg = (long long)(nb_tasks)*worker_idx/nb_workers;
+		int task_end = (long long)(nb_tasks)*(worker_idx+1)/nb_workers;
+
+		WorkerQueue& queue = *m_queues_v[worker_idx];
+		lock_guard<mutex> lock(queue.mutex);
+		for(int task_idx = task_end-1; task_idx >= task_beg; task_idx--) queue.tasks.push_back(task_idx);
+	}
+
+	vector<thread> workers_v;
+	for(int worker_idx = 1; worker_idx <= nb_workers-1; worker_idx++)
+	{
+		workers_v.push_back(thread(&myWorkStealingPool::_work, this, worker_idx, cref(task)));
+	}
+	_work(0, task); //the calling thread is the first worker
+
+	for(thread& worker : workers_v) worker.join();
+
+	if(m_exception)
+	{
+		exception_ptr exception = m_exception;
+		m_exception = nullptr;
+		rethrow_exception(exception);
+	}
+}
+
+void myWorkStealingPool::_work(int worker_idx, const function<void(int, int)>& task)
+{
+	//no task is added while running : once nothing can be stolen, the work is over
+	int task_idx;
+	try
+	{
+		while(_popTask(worker_idx, task_idx) || _stealTask(worker_idx, task_idx))
+		{
+			task(task_idx, worker_idx);
+		}
+	}
+	catch(...)
+	{
+		//kept for run() : an exception escaping a thread would terminate the program
+		{
+			lock_guard<mutex> lock(m_exception_mutex);
+			if(!m_exception) m_exception = current_exception();
+		}
+		_cancelTasks();
+	}
+}
+
+bool myWorkStealingPool::_popTask(int worker_idx, int& task_idx)
+{
+	WorkerQueue& queue = *m_queues_v[worker_idx];
+	lock_guard<mutex> lock(queue.mutex);
+	if(queue.tasks.empty()) return false; //->
+
+	task_idx = queue.tasks.back();
+	queue.tasks.pop_back();
+	return true;
+}
+
+bool myWorkStealingPool::_stealTask(int worker_idx, int& task_idx)
+{
+	for(int offset = 1; offset <= m_nbWorkers-1; offset++)
+	{
+		WorkerQueue& victim = *m_queues_v[(worker_idx + offset)%m_nbWorkers];
+		lock_guard<mutex> lock(victim.mutex);
+		if(victim.tasks.empty()) continue; //<-
+
+		task_idx = victim.tasks.front();
+		victim.tasks.pop_front();
+		return true;
+	}
+
+	return false;
+}
+
+void myWorkStealingPool::_cancelTasks()
+{
+	for(auto& queue : m_queues_v)
+	{
+		lock_guard<mutex> lock(queue->mutex);
+		queue->tasks.clear();
+	}
+}
@@ -0,0 +1,75 @@
+
+/*
+ *  FluoSim (simulation program of live cell fluorescence microscopy experiments)
+ *  Copyright (C) 2020 Matthieu Lagardère
+ *
+ *  FluoSim is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  FluoSim is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  A copy of the GNU General Public License has been attached
+ *  along with this program. It can also be found at <https://www.gnu.org/licenses/>.
+ *
+*/
+
+#ifndef MYWORKSTEALINGPOOL_H
+#define MYWORKSTEALINGPOOL_H
+
+#include "deque"
+#include "exception"
+#include "functional"
+#include "memory"
+#include "mutex"
+#include "vector"
+
+#include "toolbox_library_global.h"
+
+
+// pool of workers running independent tasks :
+//	- the task indices are split into one contiguous block per worker,
+//	- a worker takes its own tasks from the back of its queue,
+//	- an idle worker steals from the front of the others' queues (i.e. the tasks their owner would run last),
+//	- run() returns once every task has been executed,
+//	- a task throwing cancels the remaining tasks, the exception is rethrown by run() once the workers are joined.
+
+class TOOLBOXSHARED_EXPORT myWorkStealingPool
+{
+public :
+
+	explicit myWorkStealingPool(int nb_workers = 0); //0 : one worker per hardware thread
+
+	int getNbWorkers() const;
+
+	//task(task_idx, worker_idx) is called once for each task_idx in [0, nb_tasks[
+	void run(int nb_tasks, const std::function<void(int, int)>& task);
+
+private :
+
+	struct WorkerQueue
+	{
+		std::mutex mutex;
+		std::deque<int> tasks;
+	};
+
+	void _work(int worker_idx, const std::function<void(int, int)>& task);
+	bool _popTask(int worker_idx, int& task_idx);
+	bool _stealTask(int worker_idx, int& task_idx);
+	void _cancelTasks();
+
+private :
+
+	int m_nbWorkers;
+	std::vector<std::unique_ptr<WorkerQueue> > m_queues_v;
+
+	std::mutex m_exception_mutex;
+	std::exception_ptr m_exception; //first exception thrown by a task during run()
+};
+
+
+#endif // MYWORKSTEALINGPOOL_H
@@ -5,16 +5,25 @@ SUBDIRS = \
         FluoSim \
         cellEngine \
         gpuTools \
-        toolBox
+        toolBox \
+        cellEngineBenchmark \
+        FluoSimSweep \
+        TracePlayerBatch
 
 FluoSim.subdir = FluoSim_src/FluoSim
 cellEngine.subdir = FluoSim_src/cellEngine
 gpuTools.subdir = FluoSim_src/gpuTools
 toolBox.subdir = FluoSim_src/toolBox
+cellEngineBenchmark.subdir = FluoSim_src/cellEngineBenchmark
+FluoSimSweep.subdir = FluoSim_src/FluoSimSweep
+TracePlayerBatch.subdir = FluoSim_src/TracePlayerBatch
 
 toolBox.depends = gpuTools
 cellEngine.depends = toolBox
 FluoSim.depends = cellEngine
+cellEngineBenchmark.depends = cellEngine
+FluoSimSweep.depends = toolBox
+TracePlayerBatch.depends = cellEngine
 
 
 